@@ -10,17 +10,62 @@
 #include "fanet/fanetaddress.h"
 #include "fanet/fanetpayload.h"
 #include "fanetmessagedispatcher.h"
+#include "statesnapshot.h"
+#include "startupprofiler.h"
+#include "weatherstation/stationregistry.h"
+#include "weatherstation/fetchscheduler.h"
+#include "metrics/metricsserver.h"
+#include "traffic/trafficserver.h"
+#include "control/controlserver.h"
 #include "gpio.h"
 #include "logger.h"
 #include "config.h"
 
+#include <signal.h>
+#include <unistd.h>
 #include <QFile>
+#include <QFileInfo>
 #include <QDebug>
 #include <QDateTime>
 #include <QMetaObject>
+#include <QTimer>
 #include <QStringList>
 #include <QCommandLineParser>
 #include <QCommandLineOption>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLocalSocket>
+#include <QSocketNotifier>
+#include <QTextStream>
+
+
+static bool parseLogLevel(const QString &str, Logger::LogType *level)
+{
+	bool convOk;
+	const int value = str.toInt(&convOk);
+	if (!convOk || value < Logger::Critical || value > Logger::Debug)
+	{
+		return false;
+	}
+	*level = static_cast<Logger::LogType>(value);
+	return true;
+}
+
+static QString controlSocket(const QCommandLineParser &parser)
+{
+	if (parser.isSet("socket"))
+	{
+		return parser.value("socket");
+	}
+	// /run is writable for root only: use the user's runtime dir when running in foreground as user
+	const QString runtimeDir = qEnvironmentVariable("XDG_RUNTIME_DIR");
+	if (geteuid() != 0 && !runtimeDir.isEmpty())
+	{
+		return QString("%1/%2.sock").arg(runtimeDir, APP_NAME);
+	}
+	return QString(CONTROL_SOCKET);
+}
 
 
 Application::Application(int &argc, char **argv) :
@@ -28,10 +73,19 @@ Application::Application(int &argc, char **argv) :
     m_log("Application"),
     m_daemon(false),
     m_config(),
+    m_configFile(),
     m_radio(nullptr),
     m_gpio(nullptr),
     m_dispatcher(nullptr),
-    m_stations()
+    m_scheduler(nullptr),
+    m_metrics(nullptr),
+    m_traffic(nullptr),
+    m_control(nullptr),
+    m_started(QDateTime::currentMSecsSinceEpoch()),
+    m_stations(),
+    m_stateFile(),
+    m_stateTimer(nullptr),
+    m_signalNotifier(nullptr)
 {
 	const QString build = QDateTime::fromMSecsSinceEpoch(static_cast<qint64>(BUILD_TIMESTAMP) * 1000).toString();
 	setApplicationName(APP_NAME);
@@ -47,34 +101,50 @@ Application::Application(int &argc, char **argv) :
 
 	if (isRunning())
 	{
-		QStringList args;
-		for (int i = 0; i < argc; i++)
-		{
-			args << QString(argv[i]);
-		}
-		sendMessage(args.join(';'));
-		QMetaObject::invokeMethod(this, "quit", Qt::QueuedConnection); // event loop isn't running yet
-		qDebug() << "Another instance is already running. Shutting down..."; // do not instantiate logger, use qDebug instead...
+		qDebug() << "Another instance is already running. Shutting down..."; // do not use the logger, use qDebug instead...
+		const bool success = sendControlRequests(parser);
+		QMetaObject::invokeMethod(this, success ? "quit" : "exitFailure", Qt::QueuedConnection); // event loop isn't running yet
 		return;
 	}
 
 	m_daemon = parser.isSet("daemon");
-	m_log.setLogTargets(m_daemon ? Logger::LogToSyslog : Logger::LogToConsole);
+	if (parser.isSet("journal"))
+	{
+		m_log.setLogTargets(Logger::LogToJournal); // falls back to syslog if there is no journal
+	} else
+	{
+		m_log.setLogTargets(m_daemon ? Logger::LogToSyslog : Logger::LogToConsole);
+	}
+	m_log.setAsync(parser.isSet("async-log"));
+	if (parser.isSet("timestamps"))
+	{
+		const QString format = parser.value("timestamps");
+		if (format == "msec")
+		{
+			m_log.setTimestampFormat(Logger::TimestampMillis);
+		} else if (format == "mono")
+		{
+			m_log.setTimestampFormat(Logger::TimestampMonotonic);
+		} else if (format != "sec")
+		{
+			LOGGER_WARNING(m_log, QString("unknown timestamp format: '%1' (valid: sec, msec, mono)").arg(format));
+		}
+	}
 	if (parser.isSet("loglevel"))
 	{
-		switch (parser.value("loglevel").at(0).toLatin1())
+		Logger::LogType level;
+		if (parseLogLevel(parser.value("loglevel"), &level))
 		{
-			case '0': m_log.setLogLevel(Logger::Critical); break;
-			case '1': m_log.setLogLevel(Logger::Error); break;
-			case '2': m_log.setLogLevel(Logger::Warning); break;
-			case '3': m_log.setLogLevel(Logger::Notice); break;
-			case '4': m_log.setLogLevel(Logger::Info); break;
-			case '5': m_log.setLogLevel(Logger::Debug); break;
-			default:
-				m_log.warning("unknown loglevel: '%1' (valid value range: 0..5)");
-				break;
+			m_log.setLogLevel(level);
+		} else
+		{
+			LOGGER_WARNING(m_log, QString("unknown loglevel: '%1' (valid value range: 0..5)").arg(parser.value("loglevel")));
 		}
 	}
+	if (parser.isSet("category-level") && !m_log.setLogLevels(parser.value("category-level")))
+	{
+		LOGGER_WARNING(m_log, QString("invalid category log level: '%1'").arg(parser.value("category-level")));
+	}
 
 	QFile pid(PID_FILE);
 	if (pid.open(QIODevice::WriteOnly))
@@ -83,27 +153,67 @@ Application::Application(int &argc, char **argv) :
 		pid.close();
 	}
 
+	const int plugins = StationRegistry::instance().loadPlugins(parser.isSet("plugins") ? parser.value("plugins") : QString(PLUGIN_DIR));
+	if (plugins > 0)
+	{
+		m_log.notice(QString("%1 weather station plugin(s) loaded").arg(plugins));
+	}
+
 	if (parser.isSet("config"))
 	{
 		const QString xmlfile(parser.value("config"));
 		m_config = FagsConfig(xmlfile);
+		m_configFile = QFileInfo(xmlfile).absoluteFilePath();
 		m_log.notice(QString(m_config.isValid() ? "config sucessfully loaded: %1" : "failed to load config: %1").arg(xmlfile));
 	}
+	StartupProfiler::mark("config");
 
-	connect(this, &QtSingleCoreApplication::messageReceived, this, &Application::onMessageReceived);
+	m_control = new ControlServer(controlSocket(parser), this);
+	connect(m_control, &ControlServer::requestReceived, this, &Application::onControlRequest);
+	m_control->listen();
 	m_log.notice(QString("Fanet Ground Station daemon version %1 (build: %2) started.").arg(VERSION, build));
 
 	m_gpio = new Gpio(this);
 	m_radio = new FanetRadio(m_config.radio(), m_gpio, this);
+	if (parser.isSet("replay"))
+	{
+		const QString speed = parser.value("replay-speed");
+		m_radio->setReplay(parser.value("replay"), speed == "max" ? 0.0 : qMax(0.0, speed.toDouble()));
+	} else if (parser.isSet("capture"))
+	{
+		m_radio->startCapture(parser.value("capture"));
+	}
+	m_scheduler = new FetchScheduler(m_config.scheduler(), this);
 	foreach (const StationConfig &conf, m_config.stations())
 	{
 		AbstractWeatherStation *station = AbstractWeatherStation::fromConfig(conf, this);
 		if (station)
 			m_stations << station;
 		else
-			m_log.error("Failed to construct station from config!");
+			LOGGER_ERROR(m_log, "Failed to construct station from config!");
+	}
+	StartupProfiler::mark("stations");
+	m_dispatcher = new FanetMessageDispatcher(m_config.fanet(), m_stations, m_radio, this); // starts radio init
+	if (m_config.metrics().isValid())
+	{
+		m_metrics = new MetricsServer(m_config.metrics(), this);
+		m_metrics->listen();
+	}
+	if (m_config.traffic().isValid())
+	{
+		m_traffic = new TrafficServer(m_config.traffic(), m_radio, this);
+		m_traffic->listen();
 	}
-	m_dispatcher = new FanetMessageDispatcher(m_config.fanet(), m_stations, m_radio, this);
+
+	m_stateFile = parser.isSet("state") ? parser.value("state") : QString(STATE_FILE);
+	if (!m_stateFile.isEmpty())
+	{
+		restoreState();
+		m_stateTimer = new QTimer(this);
+		connect(m_stateTimer, &QTimer::timeout, this, &Application::saveState);
+		m_stateTimer->start(STATE_SAVE_INTERVAL * 1000);
+	}
+	m_dispatcher->prefetchWeatherData(); // while the radio is initializing (takes some seconds)
 }
 
 Application::~Application()
@@ -119,6 +229,12 @@ Application::~Application()
 		}
 	}
 
+	if (m_stateTimer)
+	{
+		m_stateTimer->stop();
+		saveState();
+	}
+
 	if (m_dispatcher)
 	{
 		delete m_dispatcher;
@@ -131,6 +247,12 @@ Application::~Application()
 	}
 	m_stations.clear();
 
+	if (m_scheduler)
+	{
+		delete m_scheduler;
+		m_scheduler = nullptr;
+	}
+
 	if (m_radio)
 	{
 		m_radio->deinit();
@@ -149,9 +271,21 @@ Application::~Application()
 void Application::configureCmdLineParser(QCommandLineParser &parser) const
 {
 	parser.addOption(QCommandLineOption(QStringList() << "q" << "quit", "Send 'quit' commmand to running instance"));
+	parser.addOption(QCommandLineOption(QStringList() << "status", "Print the status of the running instance (json)"));
+	parser.addOption(QCommandLineOption(QStringList() << "socket", QString("Control socket (default: %1, $XDG_RUNTIME_DIR/%2.sock if not root)").arg(CONTROL_SOCKET, APP_NAME), "socket"));
 	parser.addOption(QCommandLineOption(QStringList() << "d" << "daemon", "Run in background as daemon"));
 	parser.addOption(QCommandLineOption(QStringList() << "l" << "loglevel", "Sets the max. log level [0..5]", "loglevel"));
-	parser.addOption(QCommandLineOption(QStringList() << "c" << "config", "Configuration file", "config"));
+	parser.addOption(QCommandLineOption(QStringList() << "L" << "category-level", "Sets the max. log level of single classes, format: <class>=<0..5|default>[,...], e.g. 'FanetRadio=5'", "category-level"));
+	parser.addOption(QCommandLineOption(QStringList() << "j" << "journal", "Log to the systemd journal (structured, instead of console/syslog)"));
+	parser.addOption(QCommandLineOption(QStringList() << "t" << "timestamps", "Console timestamps: 'sec' (default), 'msec' or 'mono' (secs since start)", "timestamps"));
+	parser.addOption(QCommandLineOption(QStringList() << "a" << "async-log", "Write log messages from a background thread"));
+	parser.addOption(QCommandLineOption(QStringList() << "c" << "config", "Configuration file (applied without restart if fagsd is running)", "config"));
+	parser.addOption(QCommandLineOption(QStringList() << "reload", "Reload the configuration file of the running instance (same as SIGHUP)"));
+	parser.addOption(QCommandLineOption(QStringList() << "p" << "plugins", QString("Directory to load weather station plugins from (default: %1)").arg(PLUGIN_DIR), "plugins"));
+	parser.addOption(QCommandLineOption(QStringList() << "s" << "state", QString("State snapshot file for warm start, empty to disable (default: %1)").arg(STATE_FILE), "state"));
+	parser.addOption(QCommandLineOption(QStringList() << "C" << "capture", "Write all data received from the radio to a capture file", "capture"));
+	parser.addOption(QCommandLineOption(QStringList() << "R" << "replay", "Read radio data from a capture file instead of the uart (nothing is sent)", "replay"));
+	parser.addOption(QCommandLineOption(QStringList() << "replay-speed", "Replay speed factor, e.g. '10', or 'max' (default: 1)", "replay-speed", "1"));
 	parser.addOption(QCommandLineOption(QStringList() << "m" << "message", "send message to device, format: <manufacturerId>:<deviceId> <message>, e.g. '11:1234 helloworld'", "message"));
 #ifdef FANET_MSG_DEBUG
 	parser.addOption(QCommandLineOption(QStringList() << "i" << "inject", "inject fanet rx message, e.g. 'FNF 11,5C0B,1,0,A,6,5006FC0A0400' (debugging)", "inject"));
@@ -159,50 +293,411 @@ void Application::configureCmdLineParser(QCommandLineParser &parser) const
 	parser.setSingleDashWordOptionMode(QCommandLineParser::ParseAsCompactedShortOptions);
 }
 
-void Application::onMessageReceived(const QString &msg)
+void Application::restoreState()
 {
-	m_log.debug(QString("onMessageReceived(): %1").arg(msg));
-	QStringList args(msg.split(';', Qt::SkipEmptyParts));
-	QCommandLineParser parser;
-	configureCmdLineParser(parser);
-	parser.parse(args); // just parse, do not terminate application on '--help' and '--version'
-
-	if (parser.isSet("quit"))
+	StateSnapshot snapshot;
+	if (!snapshot.load(m_stateFile))
 	{
-		m_log.notice("Received 'quit'-command, shutting down...");
-		quit();
 		return;
 	}
-	if (parser.isSet("message"))
+
+	// data older than weather_data_maxage wouldn't be broadcasted anyway
+	const qint64 minTimestamp = QDateTime::currentMSecsSinceEpoch() - static_cast<qint64>(m_config.fanet().weatherDataMaxAge()) * 1000;
+	int restored = 0;
+	foreach (AbstractWeatherStation *station, m_stations)
+	{
+		WeatherHistory::Sample sample;
+		if (snapshot.findStation(station->config().stationType(), station->stationId(), &sample)
+		        && sample.timestamp > minTimestamp && station->restoreState(sample))
+		{
+			restored++;
+		}
+	}
+	if (m_dispatcher)
+	{
+		m_dispatcher->restoreState(snapshot.lastNodeSeen(), snapshot.lastWeatherUpdate(), snapshot.lastNameUpdate());
+	}
+	m_log.info(QString("restored state of %1/%2 station(s) from %3 (written: %4)")
+	           .arg(restored).arg(m_stations.size()).arg(m_stateFile, snapshot.created().toString()));
+}
+
+void Application::saveState()
+{
+	StateSnapshot snapshot;
+	foreach (AbstractWeatherStation *station, m_stations)
 	{
-		const QString attr = parser.value("message");
-		const int index = attr.indexOf(' ');
-		const QString msg(attr.mid(index + 1));
-		FanetAddress addr(attr.mid(0, index).toLatin1());
-		FanetPayload payload(FanetPayload::messagePayload(msg));
-		if (m_radio->sendData(addr, payload))
+		if (!station->history().isEmpty())
 		{
+			snapshot.addStation(station->config().stationType(), station->stationId(), station->history().latest());
+		}
+	}
+	if (m_dispatcher)
+	{
+		snapshot.setDispatcherState(m_dispatcher->lastNodeSeen(), m_dispatcher->lastWeatherUpdate(), m_dispatcher->lastNameUpdate());
+	}
+	if (snapshot.save(m_stateFile))
+	{
+		LOGGER_DEBUG(m_log, QString("state snapshot written: %1").arg(m_stateFile));
+	}
+}
+
+void Application::onControlRequest(QLocalSocket *client, const ControlMessage &request)
+{
+	LOGGER_DEBUG(m_log, QString("control request #%1: 0x%2 %3").arg(request.id()).arg(request.code(), 2, 16, QChar('0')).arg(request.text()));
+	switch (request.code())
+	{
+		case ControlMessage::CmdQuit:
+			m_log.notice("Received 'quit'-command, shutting down...");
+			m_control->reply(client, ControlMessage(request.id(), ControlMessage::StatusOk));
+			// nothing is written once the event loop has ended: quit after the reply is out (or the client is gone)
+			connect(client, &QLocalSocket::bytesWritten, this, &Application::onQuitReplyWritten);
+			connect(client, &QLocalSocket::disconnected, this, &Application::quit);
+			QTimer::singleShot(CONTROL_CLIENT_TIMEOUT, this, &Application::quit); // client doesn't read
+			break;
+		case ControlMessage::CmdStatus:
+			m_control->reply(client, ControlMessage(request.id(), ControlMessage::StatusOk, status()));
+			break;
+		case ControlMessage::CmdSendMessage:
+		{
+			const QString attr = request.text();
+			const int index = attr.indexOf(' ');
+			const QString msg(attr.mid(index + 1));
+			FanetAddress addr(attr.mid(0, index).toLatin1());
+			if (index <= 0 || !addr.isValid())
+			{
+				m_control->reply(client, ControlMessage(request.id(), ControlMessage::StatusBadRequest, QString("invalid address")));
+				break;
+			}
+			if (!m_radio || !m_radio->sendData(addr, FanetPayload::messagePayload(msg)))
+			{
+				m_control->reply(client, ControlMessage(request.id(), ControlMessage::StatusError, QString("failed to send message")));
+				break;
+			}
 			m_log.info(QString("%1 <- message: %2").arg(QString::fromLatin1(addr.toHex(':')), msg));
+			m_control->reply(client, ControlMessage(request.id(), ControlMessage::StatusOk));
+			break;
 		}
+		case ControlMessage::CmdSetLogLevel:
+		{
+			const QString spec = request.text();
+			Logger::LogType level;
+			if (parseLogLevel(spec, &level))
+			{
+				m_log.setLogLevel(level);
+			} else if (!m_log.setLogLevels(spec))
+			{
+				m_control->reply(client, ControlMessage(request.id(), ControlMessage::StatusBadRequest, QString("invalid log level: '%1'").arg(spec)));
+				break;
+			}
+			m_log.notice(QString("log levels changed: %1").arg(spec));
+			m_control->reply(client, ControlMessage(request.id(), ControlMessage::StatusOk));
+			break;
+		}
+		case ControlMessage::CmdReloadConfig:
+		{
+			QString error;
+			if (!applyConfig(request.text().isEmpty() ? m_configFile : request.text(), &error))
+			{
+				m_control->reply(client, ControlMessage(request.id(), ControlMessage::StatusError, error));
+				break;
+			}
+			m_control->reply(client, ControlMessage(request.id(), ControlMessage::StatusOk));
+			break;
+		}
+#ifdef FANET_MSG_DEBUG
+		case ControlMessage::CmdInject:
+			if (m_radio)
+			{
+				m_radio->injectMessage(request.text());
+			}
+			m_control->reply(client, ControlMessage(request.id(), ControlMessage::StatusOk));
+			break;
+#endif
+		default:
+			m_control->reply(client, ControlMessage(request.id(), ControlMessage::StatusUnknownCommand));
+			break;
+	}
+}
+
+void Application::watchSignals(int fd)
+{
+	delete m_signalNotifier;
+	m_signalNotifier = new QSocketNotifier(fd, QSocketNotifier::Read, this);
+	connect(m_signalNotifier, &QSocketNotifier::activated, this, &Application::onSignal);
+}
+
+void Application::onSignal()
+{
+	char sig;
+	while (read(static_cast<int>(m_signalNotifier->socket()), &sig, 1) == 1) // non-blocking
+	{
+		switch (sig)
+		{
+			case SIGINT:
+				m_log.info("Received SIGINT, shutting down...");
+				quit();
+				break;
+			case SIGTERM:
+				m_log.info("Received SIGTERM, shutting down...");
+				quit();
+				break;
+			case SIGHUP:
+				m_log.info("Received SIGHUP, reloading config...");
+				reloadConfig();
+				break;
+			default:
+				break;
+		}
+	}
+}
+
+void Application::reloadConfig()
+{
+	QString error;
+	if (!applyConfig(m_configFile, &error))
+	{
+		LOGGER_ERROR(m_log, QString("config reload failed: %1").arg(error));
+	}
+}
+
+bool Application::applyConfig(const QString &xmlFile, QString *error)
+{
+	if (xmlFile.isEmpty())
+	{
+		*error = "no config file";
+		return false;
+	}
+	m_log.notice(QString("reloading config: %1").arg(xmlFile));
+	const FagsConfig config(xmlFile);
+	if (!config.isValid())
+	{
+		*error = QString("failed to load config: %1, keeping the running config").arg(xmlFile);
+		return false;
+	}
+
+	// apply what has changed only, the radio and untouched stations keep running
+	QStringList changed;
+	if (m_radio && config.radio() != m_config.radio())
+	{
+		if (!m_radio->setConfig(config.radio()))
+		{
+			LOGGER_WARNING(m_log, "radio: changes of uart or gpio pins take effect after restarting fagsd");
+		}
+		changed << CONFIG_ELEMENT_RADIO;
+	}
+	if (m_dispatcher && config.fanet() != m_config.fanet())
+	{
+		m_dispatcher->setConfig(config.fanet());
+		changed << CONFIG_ELEMENT_FANET;
+	}
+	if (m_scheduler)
+	{
+		m_scheduler->setConfig(config.scheduler()); // cheap, keeps queues and tokens
+	}
+	if (config.metrics() != m_config.metrics())
+	{
+		delete m_metrics;
+		m_metrics = nullptr;
+		if (config.metrics().isValid())
+		{
+			m_metrics = new MetricsServer(config.metrics(), this);
+			m_metrics->listen();
+		}
+		changed << CONFIG_ELEMENT_METRICS;
+	}
+	if (config.traffic() != m_config.traffic())
+	{
+		delete m_traffic;
+		m_traffic = nullptr;
+		if (config.traffic().isValid())
+		{
+			m_traffic = new TrafficServer(config.traffic(), m_radio, this);
+			m_traffic->listen();
+		}
+		changed << CONFIG_ELEMENT_TRAFFIC;
+	}
+	if (applyStations(config.stations()))
+	{
+		changed << CONFIG_ELEMENT_STATIONS;
+	}
+
+	m_config = config;
+	m_configFile = xmlFile;
+	m_log.notice(QString("config reloaded, changed: %1").arg(changed.isEmpty() ? QString("nothing") : changed.join(", ")));
+	return true;
+}
+
+bool Application::applyStations(const StationConfigList &configs)
+{
+	// keep the order of the config (without address change only the 1st station is broadcasted)
+	WeatherStationList stations;
+	WeatherStationList obsolete = m_stations;
+	int added = 0;
+	foreach (const StationConfig &conf, configs)
+	{
+		AbstractWeatherStation *station = nullptr;
+		foreach (AbstractWeatherStation *running, obsolete)
+		{
+			if (running->config() == conf)
+			{
+				station = running;
+				obsolete.removeOne(running);
+				break;
+			}
+		}
+		if (!station)
+		{
+			station = AbstractWeatherStation::fromConfig(conf, this);
+			if (!station)
+			{
+				LOGGER_ERROR(m_log, "Failed to construct station from config!");
+				continue;
+			}
+			added++;
+		}
+		stations << station;
+	}
+	if (added == 0 && obsolete.isEmpty())
+	{
+		return false;
+	}
+
+	if (m_dispatcher)
+	{
+		m_dispatcher->setStations(stations);
+	}
+	m_stations = stations;
+	foreach (AbstractWeatherStation *station, obsolete) // removed or changed
+	{
+		delete station;
+	}
+	m_log.notice(QString("stations: %1 started, %2 stopped (changed stations are restarted), %3 running")
+	             .arg(added).arg(obsolete.size()).arg(m_stations.size()));
+	return true;
+}
+
+QString Application::status() const
+{
+	QJsonObject status;
+	status.insert("version", QString(VERSION));
+	status.insert("pid", applicationPid());
+	status.insert("uptime", (QDateTime::currentMSecsSinceEpoch() - m_started) / 1000);
+	status.insert("radio", m_radio ? FanetRadio::radioStateStr(m_radio->state()) : QString());
+	QJsonArray stations;
+	foreach (const AbstractWeatherStation *station, m_stations)
+	{
+		const WeatherSnapshotPtr snapshot = station->snapshot();
+		QJsonObject obj;
+		obj.insert("id", station->stationId());
+		obj.insert("type", StationConfig::typeToString(station->config().stationType()));
+		obj.insert("name", snapshot->stationName);
+		obj.insert("lastUpdate", snapshot->lastUpdate.isValid() ? snapshot->lastUpdate.toString(Qt::ISODate) : QString());
+		stations.append(obj);
+	}
+	status.insert("stations", stations);
+	status.insert("logLevel", static_cast<int>(Logger::logLevel()));
+	return QString::fromUtf8(QJsonDocument(status).toJson(QJsonDocument::Compact));
+}
+
+void Application::exitFailure()
+{
+	exit(EXIT_FAILURE);
+}
+
+void Application::onQuitReplyWritten()
+{
+	QLocalSocket *client = qobject_cast<QLocalSocket*>(sender());
+	if (!client || client->bytesToWrite() == 0)
+	{
+		quit();
+	}
+}
+
+bool Application::sendControlRequests(const QCommandLineParser &parser) const
+{
+	QList<ControlMessage> requests;
+	quint32 id = 0;
+	if (parser.isSet("loglevel"))
+	{
+		requests << ControlMessage(++id, ControlMessage::CmdSetLogLevel, parser.value("loglevel"));
+	}
+	if (parser.isSet("category-level"))
+	{
+		requests << ControlMessage(++id, ControlMessage::CmdSetLogLevel, parser.value("category-level"));
+	}
+	if (parser.isSet("config"))
+	{
+		requests << ControlMessage(++id, ControlMessage::CmdReloadConfig, QFileInfo(parser.value("config")).absoluteFilePath());
+	} else if (parser.isSet("reload"))
+	{
+		requests << ControlMessage(++id, ControlMessage::CmdReloadConfig);
+	}
+	if (parser.isSet("message"))
+	{
+		requests << ControlMessage(++id, ControlMessage::CmdSendMessage, parser.value("message"));
 	}
 #ifdef FANET_MSG_DEBUG
-	if (m_radio && parser.isSet("inject"))
+	if (parser.isSet("inject"))
 	{
-		const QString msg = parser.value("inject");
-		m_radio->injectMessage(msg);
+		requests << ControlMessage(++id, ControlMessage::CmdInject, parser.value("inject"));
 	}
 #endif
-//	if (parser.isSet("config"))
-//	{
-//		QString config = parser.value("config");
-//		m_log.notice(QString("reloading config: %1").arg(config));
-//		m_clients.clear();
-//		if (!loadConfig(config))
-//		{
-//			m_log.error("missing config, shutting down...");
-//			quit();
-//			return;
-//		}
-//	}
-	///@todo process received cmd line options
+	if (parser.isSet("status"))
+	{
+		requests << ControlMessage(++id, ControlMessage::CmdStatus);
+	}
+	if (parser.isSet("quit"))
+	{
+		requests << ControlMessage(++id, ControlMessage::CmdQuit);
+	}
+	if (requests.isEmpty())
+	{
+		return true;
+	}
+
+	const QString socketName = controlSocket(parser);
+	QLocalSocket socket;
+	socket.connectToServer(socketName);
+	if (!socket.waitForConnected(CONTROL_CLIENT_TIMEOUT))
+	{
+		qDebug() << "Failed to connect to" << socketName << ":" << socket.errorString();
+		return false;
+	}
+	foreach (const ControlMessage &request, requests)
+	{
+		socket.write(request.serialize()); // all at once, the responses are matched by id
+	}
+
+	QTextStream out(stdout);
+	QByteArray buffer;
+	int pending = requests.size();
+	bool success = true;
+	while (pending > 0 && socket.waitForReadyRead(CONTROL_CLIENT_TIMEOUT))
+	{
+		buffer.append(socket.readAll());
+		ControlMessage response;
+		ControlMessage::ParseResult result;
+		while ((result = ControlMessage::take(buffer, &response)) == ControlMessage::Complete)
+		{
+			pending--;
+			if (response.code() != ControlMessage::StatusOk)
+			{
+				qDebug() << "Request" << response.id() << "failed:" << Qt::hex << response.code() << response.text();
+				success = false;
+			} else if (!response.payload().isEmpty())
+			{
+				out << response.text() << Qt::endl;
+			}
+		}
+		if (result == ControlMessage::Invalid)
+		{
+			qDebug() << "Invalid response received, aborting";
+			return false;
+		}
+	}
+	if (pending > 0)
+	{
+		qDebug() << pending << "request(s) not answered:" << socket.errorString();
+	}
+	return success && pending == 0;
 }
@@ -15,8 +15,16 @@
 
 class QCommandLineParser;
 class FanetMessageDispatcher;
+class FetchScheduler;
+class MetricsServer;
+class TrafficServer;
 class FanetPayload;
 class Gpio;
+class QTimer;
+class QLocalSocket;
+class QSocketNotifier;
+class ControlServer;
+class ControlMessage;
 
 class Application : public QtSingleCoreApplication
 {
@@ -28,18 +36,41 @@ public:
 	void configureCmdLineParser(QCommandLineParser &parser) const;
 	bool isDaemon() const { return m_daemon; }
 	Gpio *gpio() const { return m_gpio; }
+	void watchSignals(int fd); // read end of the signal handler's self-pipe
+
+public slots:
+	void reloadConfig(); // SIGHUP
 
 private slots:
-	void onMessageReceived(const QString &msg);
+	void onSignal();
+	void onControlRequest(QLocalSocket *client, const ControlMessage &request);
+	void onQuitReplyWritten();
+	void exitFailure(); // e.g. a control request failed
+	void saveState();
 
 private:
+	void restoreState();
+	bool sendControlRequests(const QCommandLineParser &parser) const;
+	QString status() const;
+	bool applyConfig(const QString &xmlFile, QString *error);
+	bool applyStations(const StationConfigList &configs);
+
 	Logger m_log;
 	bool m_daemon;
 	FagsConfig m_config;
+	QString m_configFile;
 	FanetRadio *m_radio;
 	Gpio *m_gpio;
 	FanetMessageDispatcher *m_dispatcher;
+	FetchScheduler *m_scheduler;
+	MetricsServer *m_metrics;
+	TrafficServer *m_traffic;
+	ControlServer *m_control;
+	qint64 m_started;
 	WeatherStationList m_stations;
+	QString m_stateFile;
+	QTimer *m_stateTimer;
+	QSocketNotifier *m_signalNotifier;
 };
 
 #endif // APPLICATION_H
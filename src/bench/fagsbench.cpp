@@ -0,0 +1,469 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "fagsbench.h"
+#include "config.h"
+#include "fanetmessagedispatcher.h"
+#include "config/fanetconfig.h"
+#include "config/radioconfig.h"
+#include "config/stationconfig.h"
+#include "fanet/fanetaddress.h"
+#include "fanet/fanetprotocolparser.h"
+#include "fanet/fanetradio.h"
+#include "fanet/genericreply.h"
+#include "fanet/receiveevent.h"
+#include "fanet/transmitcommand.h"
+#include "fanet/uartcapture.h"
+
+#include <QBuffer>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QGeoCoordinate>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QSysInfo>
+#include <QTemporaryDir>
+#include <QTimer>
+
+static const int  STATION_INTERVAL_SECS   = 60;
+static const int  STATION_HISTORY_SAMPLES = 30;         // per station, spaced by STATION_INTERVAL_SECS
+static const int  TX_INTERVAL_WEATHER     = 40;
+static const int  TX_INTERVAL_NAMES       = 5 * 60;
+static const int  INACTIVITY_TIMEOUT      = 60 * 60;
+static const int  WEATHER_MAX_AGE         = 10 * 60;
+static const int  AVERAGING_WINDOW        = 10 * 60;
+static const int  TRAFFIC_NODES           = 50;         // distinct senders in the replayed traffic
+static const int  TRAFFIC_CHUNK_FRAMES    = 8;          // frames per uart read
+static const int  TRAFFIC_TIMEOUT_MSEC    = 10 * 60 * 1000;
+static const char TRAFFIC_FILE[]          = "traffic.cap";
+
+static const FanetPayload::PayloadType TRAFFIC_MIX[] = {FanetPayload::PTTracking, FanetPayload::PTTracking, FanetPayload::PTGroundTracking,
+                                                        FanetPayload::PTTracking, FanetPayload::PTName, FanetPayload::PTService,
+                                                        FanetPayload::PTTracking, FanetPayload::PTThermal};
+
+struct PayloadTypeName
+{
+	FanetPayload::PayloadType type;
+	const char *name;
+};
+
+static const PayloadTypeName PAYLOAD_TYPES[] = {{FanetPayload::PTAck, "ack"}, {FanetPayload::PTTracking, "tracking"}, {FanetPayload::PTName, "name"},
+                                                {FanetPayload::PTMessage, "message"}, {FanetPayload::PTService, "service"}, {FanetPayload::PTLandmarks, "landmarks"},
+                                                {FanetPayload::PTRemoteConfig, "remote_config"}, {FanetPayload::PTGroundTracking, "ground_tracking"},
+                                                {FanetPayload::PTHWInfoOld, "hwinfo_old"}, {FanetPayload::PTThermal, "thermal"}, {FanetPayload::PTHWInfo, "hwinfo"}};
+
+static const char *REPLIES[] = {" OK", " ACK,11,5C0B", " MSG,1,initialized", " ERR,30,too many arguments"};
+
+
+BenchStation::BenchStation(const StationConfig &config, QObject *parent) :
+    AbstractWeatherStation(config, parent),
+    m_lastUpdate(),
+    m_step(config.stationId())
+{
+}
+
+BenchStation::~BenchStation()
+{
+}
+
+AbstractWeatherStation::WeatherDataFlags BenchStation::availableData() const
+{
+	return WindSpeed | WindSpeedGust | WindDirection | Temperature | Humidity;
+}
+
+void BenchStation::simulate(const QDateTime &timestamp)
+{
+	m_lastUpdate = timestamp;
+	m_step++;
+	emit updateFinished(true); // recorded in history and published
+}
+
+void BenchStation::update()
+{
+	simulate(QDateTime::currentDateTimeUtc());
+}
+
+
+FagsBench::FagsBench(const Options &options, QObject *parent) :
+    QObject(parent),
+    m_log("FagsBench"),
+    m_options(options),
+    m_recording(false),
+    m_results(),
+    m_loop(nullptr),
+    m_received(0),
+    m_sink(0)
+{
+}
+
+FagsBench::~FagsBench()
+{
+}
+
+void FagsBench::runCodec()
+{
+	m_recording = false; // warm up
+	const int warmup = qMax(1, m_options.iterations / 10);
+	benchServicePayload(warmup);
+	benchFromReceivedData(warmup);
+	benchAddress(warmup);
+	benchTransmitCommand(warmup);
+
+	m_recording = true;
+	benchServicePayload(m_options.iterations);
+	benchFromReceivedData(m_options.iterations);
+	benchAddress(m_options.iterations);
+	benchTransmitCommand(m_options.iterations);
+}
+
+void FagsBench::runParser()
+{
+	m_recording = false; // warm up
+	const int warmup = qMax(1, m_options.iterations / 10);
+	benchReceiveEvent(warmup);
+	benchGenericReply(warmup);
+	benchProtocolParser(warmup);
+
+	m_recording = true;
+	benchReceiveEvent(m_options.iterations);
+	benchGenericReply(m_options.iterations);
+	benchProtocolParser(m_options.iterations);
+}
+
+bool FagsBench::runDispatcher()
+{
+	m_recording = true;
+	QTemporaryDir dir;
+	const QString traffic = dir.filePath(TRAFFIC_FILE);
+	if (!dir.isValid() || !writeTraffic(traffic))
+	{
+		LOGGER_ERROR(m_log, "failed to write traffic capture");
+		return false;
+	}
+
+	WeatherStationList stations;
+	for (int i = 0; i < m_options.stations; i++)
+	{
+		const StationConfig config(StationConfig::UserStation, i + 1, QString("Bench %1").arg(i + 1), QString(),
+		                           QGeoCoordinate(47.5 + i * 0.001, 11.1), STATION_INTERVAL_SECS);
+		stations.append(new BenchStation(config, this));
+	}
+
+	// history of the last STATION_HISTORY_SAMPLES updates, so averaging has to look at the full window
+	QElapsedTimer timer;
+	const QDateTime current = QDateTime::currentDateTimeUtc();
+	timer.start();
+	for (int i = STATION_HISTORY_SAMPLES; i > 0; i--)
+	{
+		const QDateTime timestamp = current.addSecs(-i * STATION_INTERVAL_SECS);
+		foreach (AbstractWeatherStation *station, stations)
+		{
+			static_cast<BenchStation*>(station)->simulate(timestamp);
+		}
+	}
+	record("stations.update", static_cast<qint64>(STATION_HISTORY_SAMPLES) * stations.size(), timer.nsecsElapsed());
+
+	bool success = true;
+	{
+		FanetRadio radio(RadioConfig(), nullptr);
+		if (!radio.setReplay(traffic, 0.0))
+		{
+			qDeleteAll(stations);
+			return false;
+		}
+		connect(&radio, &FanetRadio::messageReceived, this, &FagsBench::onMessageReceived);
+
+		QEventLoop loop;
+		m_loop = &loop;
+		m_received = 0;
+		QTimer::singleShot(TRAFFIC_TIMEOUT_MSEC, &loop, &QEventLoop::quit);
+		timer.restart();
+		// init() of the radio starts the replay, every frame passes parser, radio and dispatcher
+		FanetMessageDispatcher dispatcher(FanetConfig(TX_INTERVAL_WEATHER, TX_INTERVAL_NAMES, INACTIVITY_TIMEOUT, WEATHER_MAX_AGE, AVERAGING_WINDOW),
+		                                  stations, &radio);
+		if (m_received < m_options.frames)
+		{
+			loop.exec();
+		}
+		const qint64 nsecs = timer.nsecsElapsed();
+		m_loop = nullptr;
+		if (m_received < m_options.frames)
+		{
+			LOGGER_ERROR(m_log, QString("traffic: %1 of %2 frames received").arg(m_received).arg(m_options.frames));
+			success = false;
+		} else
+		{
+			record("dispatcher.traffic", m_received, nsecs);
+		}
+
+		timer.restart();
+		for (int i = 0; i < m_options.rounds; i++)
+		{
+			dispatcher.sendWeatherData();
+		}
+		record("dispatcher.send_weather", m_options.rounds, timer.nsecsElapsed());
+
+		timer.restart();
+		for (int i = 0; i < m_options.rounds; i++)
+		{
+			dispatcher.sendStationNames();
+		}
+		record("dispatcher.send_names", m_options.rounds, timer.nsecsElapsed());
+	}
+	qDeleteAll(stations);
+	return success;
+}
+
+QJsonDocument FagsBench::report(const QString &commit) const
+{
+	QJsonObject build;
+	build["version"] = QString(VERSION);
+	build["commit"] = commit;
+	build["qt"] = QString(qVersion());
+	build["arch"] = QSysInfo::buildCpuArchitecture();
+	build["abi"] = QSysInfo::buildAbi();
+#ifdef NDEBUG
+	build["type"] = QString("release");
+#else
+	build["type"] = QString("debug");
+#endif
+
+	QJsonObject host;
+	host["name"] = QSysInfo::machineHostName();
+	host["arch"] = QSysInfo::currentCpuArchitecture();
+	host["os"] = QSysInfo::prettyProductName();
+	host["kernel"] = QSysInfo::kernelVersion();
+
+	QJsonObject options;
+	options["iterations"] = m_options.iterations;
+	options["rounds"] = m_options.rounds;
+	options["stations"] = m_options.stations;
+	options["frames"] = m_options.frames;
+
+	QJsonArray results;
+	foreach (const Result &result, m_results)
+	{
+		QJsonObject entry;
+		entry["name"] = result.name;
+		entry["iterations"] = result.iterations;
+		entry["ns_per_op"] = result.iterations > 0 ? static_cast<double>(result.nsecs) / result.iterations : 0.0;
+		entry["ops_per_sec"] = result.nsecs > 0 ? result.iterations * 1e9 / result.nsecs : 0.0;
+		results.append(entry);
+	}
+
+	QJsonObject root;
+	root["benchmark"] = QString("fags_bench");
+	root["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+	root["build"] = build;
+	root["host"] = host;
+	root["options"] = options;
+	root["results"] = results;
+	return QJsonDocument(root);
+}
+
+void FagsBench::onMessageReceived(quint32 addr, const FanetPayload &payload, bool broadcast)
+{
+	Q_UNUSED(addr)
+	Q_UNUSED(payload)
+	Q_UNUSED(broadcast)
+	if (++m_received >= m_options.frames && m_loop)
+	{
+		m_loop->quit();
+	}
+}
+
+void FagsBench::record(const QString &name, qint64 iterations, qint64 nsecs)
+{
+	if (!m_recording)
+	{
+		return;
+	}
+	m_results.append(Result{name, iterations, nsecs});
+	LOGGER_INFO(m_log, QString("%1: %2 ns/op").arg(name).arg(iterations > 0 ? static_cast<double>(nsecs) / iterations : 0.0, 0, 'f', 1));
+}
+
+void FagsBench::benchServicePayload(int iterations)
+{
+	const QGeoCoordinate pos(47.5, 11.1);
+	const FanetPayload::ServiceHeaderFlags header(FanetPayload::SHWind | FanetPayload::SHTemperature | FanetPayload::SHHumidity);
+	QElapsedTimer timer;
+	timer.start();
+	for (int i = 0; i < iterations; i++)
+	{
+		m_sink += FanetPayload::servicePayload(header, pos, 155, i % 360, 125, 200, 650, 0).size();
+	}
+	record("codec.service_payload", iterations, timer.nsecsElapsed());
+}
+
+void FagsBench::benchFromReceivedData(int iterations)
+{
+	for (const PayloadTypeName &type : PAYLOAD_TYPES)
+	{
+		const QByteArray data = samplePayload(type.type);
+		QElapsedTimer timer;
+		timer.start();
+		for (int i = 0; i < iterations; i++)
+		{
+			m_sink += FanetPayload::fromReceivedData(type.type, data).isValid();
+		}
+		record(QString("codec.from_received_data.%1").arg(type.name), iterations, timer.nsecsElapsed());
+	}
+}
+
+void FagsBench::benchAddress(int iterations)
+{
+	const QByteArray data("11,5C0B");
+	QElapsedTimer timer;
+	timer.start();
+	for (int i = 0; i < iterations; i++)
+	{
+		m_sink += FanetAddress(data).toUInt32();
+	}
+	record("codec.address_parse", iterations, timer.nsecsElapsed());
+}
+
+void FagsBench::benchTransmitCommand(int iterations)
+{
+	const FanetPayload::ServiceHeaderFlags header(FanetPayload::SHWind | FanetPayload::SHTemperature | FanetPayload::SHHumidity);
+	const TransmitCommand cmd(FanetAddress(), FanetPayload::servicePayload(header, QGeoCoordinate(47.5, 11.1), 155, 270, 125, 200, 650, 0));
+	QElapsedTimer timer;
+	timer.start();
+	for (int i = 0; i < iterations; i++)
+	{
+		m_sink += cmd.serialize().size();
+	}
+	record("codec.transmit_serialize", iterations, timer.nsecsElapsed());
+}
+
+void FagsBench::benchReceiveEvent(int iterations)
+{
+	// as passed by FanetProtocolParser: the frame without start delimiter and identifier
+	const QByteArray frame = receivedFrame(0x11, 0x5c0b, FanetPayload::PTTracking, samplePayload(FanetPayload::PTTracking));
+	const QByteArray data = frame.mid(1).trimmed().mid(qstrlen(FanetProtocolParser::MSG_FANET_RECEIVE));
+	QElapsedTimer timer;
+	timer.start();
+	for (int i = 0; i < iterations; i++)
+	{
+		m_sink += ReceiveEvent(data).isValid();
+	}
+	record("parser.receive_event", iterations, timer.nsecsElapsed());
+
+	const ReceiveEvent event(data);
+	timer.restart();
+	for (int i = 0; i < iterations; i++)
+	{
+		m_sink += event.toString().size();
+	}
+	record("parser.receive_event_to_string", iterations, timer.nsecsElapsed());
+}
+
+void FagsBench::benchGenericReply(int iterations)
+{
+	const int count = sizeof(REPLIES) / sizeof(REPLIES[0]);
+	QList<QByteArray> replies;
+	for (int i = 0; i < count; i++)
+	{
+		replies.append(QByteArray(REPLIES[i]));
+	}
+	QElapsedTimer timer;
+	timer.start();
+	for (int i = 0; i < iterations; i++)
+	{
+		m_sink += GenericReply(AbstractFanetMessage::FMTFanetReply, replies.at(i % count)).replyType();
+	}
+	record("parser.generic_reply", iterations, timer.nsecsElapsed());
+}
+
+void FagsBench::benchProtocolParser(int iterations)
+{
+	// uart stream as delivered by the radio: mostly received frames, some replies
+	QByteArray input;
+	for (int i = 0; i < iterations; i++)
+	{
+		if (i % 10 == 9)
+		{
+			input.append(QByteArray(1, static_cast<char>(FanetProtocolParser::StartDelimiter)))
+			     .append(FanetProtocolParser::MSG_FANET_REPLY).append(" OK")
+			     .append(static_cast<char>(FanetProtocolParser::EndDelimiter));
+		} else
+		{
+			const FanetPayload::PayloadType type = TRAFFIC_MIX[i % (sizeof(TRAFFIC_MIX) / sizeof(TRAFFIC_MIX[0]))];
+			input.append(receivedFrame(0x11, 0x1000 + i % TRAFFIC_NODES, type, samplePayload(type)));
+		}
+	}
+
+	QBuffer dev;
+	dev.setData(input);
+	dev.open(QIODevice::ReadOnly);
+	FanetProtocolParser parser(&dev);
+	int messages = 0;
+	QElapsedTimer timer;
+	timer.start();
+	AbstractFanetMessage *msg;
+	while ((msg = parser.next()))
+	{
+		m_sink += msg->isValid();
+		messages++;
+		delete msg;
+	}
+	record("parser.stream", messages, timer.nsecsElapsed());
+}
+
+bool FagsBench::writeTraffic(const QString &fileName) const
+{
+	UartCapture capture(fileName);
+	if (!capture.open())
+	{
+		return false;
+	}
+	QByteArray chunk;
+	for (int i = 0; i < m_options.frames; i++)
+	{
+		const FanetPayload::PayloadType type = TRAFFIC_MIX[i % (sizeof(TRAFFIC_MIX) / sizeof(TRAFFIC_MIX[0]))];
+		chunk.append(receivedFrame(0x11, 0x1000 + i % TRAFFIC_NODES, type, samplePayload(type)));
+		if ((i + 1) % TRAFFIC_CHUNK_FRAMES == 0 || i + 1 == m_options.frames)
+		{
+			capture.append(chunk);
+			chunk.clear();
+		}
+	}
+	capture.close();
+	return true;
+}
+
+QByteArray FagsBench::samplePayload(FanetPayload::PayloadType type)
+{
+	switch (type)
+	{
+		case FanetPayload::PTTracking:       return QByteArray::fromHex("e8a5437b2b08b8110a1480"); // position, alt./type, speed, climb, heading
+		case FanetPayload::PTName:           return QByteArray("Bench Pilot");
+		case FanetPayload::PTMessage:        return QByteArray(1, '\0').append("Bench message");
+		case FanetPayload::PTService:
+		{
+			const FanetPayload::ServiceHeaderFlags header(FanetPayload::SHWind | FanetPayload::SHTemperature | FanetPayload::SHHumidity);
+			return FanetPayload::servicePayload(header, QGeoCoordinate(47.5, 11.1), 155, 270, 125, 200, 650, 0).data();
+		}
+		case FanetPayload::PTLandmarks:      return QByteArray::fromHex("0010e8a5437b2b08");
+		case FanetPayload::PTRemoteConfig:   return QByteArray::fromHex("0101");
+		case FanetPayload::PTGroundTracking: return QByteArray::fromHex("e8a5437b2b0810");
+		case FanetPayload::PTHWInfoOld:      return QByteArray::fromHex("1101a0d204");
+		case FanetPayload::PTThermal:        return QByteArray::fromHex("e8a5437b2b08f4010f0a5a");
+		case FanetPayload::PTHWInfo:         return QByteArray::fromHex("102c01"); // header + uptime
+		default:                             return QByteArray();
+	}
+}
+
+QByteArray FagsBench::receivedFrame(quint8 manufacturer, quint16 device, FanetPayload::PayloadType type, const QByteArray &payload)
+{
+	// e.g. "#FNF 11,5C0B,1,0,2,b,42656e63682050696c6f74\n"
+	return QByteArray(1, static_cast<char>(FanetProtocolParser::StartDelimiter))
+	       .append(FanetProtocolParser::MSG_FANET_RECEIVE).append(' ')
+	       .append(FanetAddress(manufacturer, device).toHex(',')).append(",1,0,")
+	       .append(QByteArray::number(static_cast<int>(type), 16)).append(',')
+	       .append(QByteArray::number(payload.size(), 16)).append(',')
+	       .append(payload.toHex())
+	       .append(static_cast<char>(FanetProtocolParser::EndDelimiter));
+}
@@ -0,0 +1,113 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef FAGSBENCH_H
+#define FAGSBENCH_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QList>
+#include <QString>
+#include "logger.h"
+#include "fanet/fanetpayload.h"
+#include "weatherstation/abstractweatherstation.h"
+
+class QEventLoop;
+
+/**
+ * @class BenchStation is a simulated weather station: update() produces a new sample right away (no network),
+ *        recorded and published like the data of a real driver.
+ */
+class BenchStation : public AbstractWeatherStation
+{
+	Q_OBJECT
+public:
+	explicit BenchStation(const StationConfig &config, QObject *parent = nullptr);
+	virtual ~BenchStation() Q_DECL_OVERRIDE;
+
+	virtual QDateTime lastUpdate() const Q_DECL_OVERRIDE { return m_lastUpdate; }
+	virtual int windDirection() const Q_DECL_OVERRIDE { return (m_step * 7) % 360; }
+	virtual int windSpeed() const Q_DECL_OVERRIDE { return 80 + (m_step * 13) % 120; }
+	virtual int windGusts() const Q_DECL_OVERRIDE { return 150 + (m_step * 17) % 150; }
+	virtual int temperature() const Q_DECL_OVERRIDE { return 120 + m_step % 50; }
+	virtual int humidity() const Q_DECL_OVERRIDE { return 400 + (m_step * 3) % 400; }
+
+	virtual int stationId() const Q_DECL_OVERRIDE { return config().stationId(); }
+	virtual QString stationName() const Q_DECL_OVERRIDE { return config().stationName(); }
+	virtual WeatherDataFlags availableData() const Q_DECL_OVERRIDE;
+
+	void simulate(const QDateTime &timestamp); // next sample, as if fetched at timestamp
+
+public slots:
+	virtual void update() Q_DECL_OVERRIDE;
+
+private:
+	QDateTime m_lastUpdate;
+	int m_step;
+};
+
+/**
+ * @class FagsBench runs microbenchmarks of the fanet codec and parser and macro benchmarks driving a
+ *        FanetMessageDispatcher with simulated stations and traffic (replayed through FanetRadio), and
+ *        reports the results as json, e.g. to be tracked per commit.
+ */
+class FagsBench : public QObject
+{
+	Q_OBJECT
+public:
+	struct Options
+	{
+		int iterations; // per microbenchmark
+		int rounds;     // per dispatcher benchmark
+		int stations;   // simulated weather stations
+		int frames;     // received fanet frames replayed through radio and dispatcher
+	};
+
+	explicit FagsBench(const Options &options, QObject *parent = nullptr);
+	virtual ~FagsBench() Q_DECL_OVERRIDE;
+
+	void runCodec();
+	void runParser();
+	bool runDispatcher();
+
+	QJsonDocument report(const QString &commit) const;
+
+private slots:
+	void onMessageReceived(quint32 addr, const FanetPayload &payload, bool broadcast);
+
+private:
+	struct Result
+	{
+		QString name;
+		qint64 iterations;
+		qint64 nsecs;
+	};
+
+	void record(const QString &name, qint64 iterations, qint64 nsecs);
+	void benchServicePayload(int iterations);
+	void benchFromReceivedData(int iterations);
+	void benchAddress(int iterations);
+	void benchTransmitCommand(int iterations);
+	void benchReceiveEvent(int iterations);
+	void benchGenericReply(int iterations);
+	void benchProtocolParser(int iterations);
+	bool writeTraffic(const QString &fileName) const;
+
+	static QByteArray samplePayload(FanetPayload::PayloadType type);
+	static QByteArray receivedFrame(quint8 manufacturer, quint16 device, FanetPayload::PayloadType type, const QByteArray &payload);
+
+	Logger m_log;
+	Options m_options;
+	bool m_recording; // false: warm-up
+	QList<Result> m_results;
+	QEventLoop *m_loop;
+	int m_received;
+	quint64 m_sink; // keeps results of the benchmarked calls alive
+};
+
+#endif // FAGSBENCH_H
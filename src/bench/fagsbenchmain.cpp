@@ -0,0 +1,68 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QCommandLineOption>
+#include <QFile>
+#include "logger.h"
+#include "config.h"
+#include "fagsbench.h"
+
+int main(int argc, char *argv[])
+{
+	QCoreApplication app(argc, argv);
+	app.setApplicationName("fags_bench");
+	app.setApplicationVersion(VERSION);
+	Logger log("main"); // main thread must be the first to log
+	Logger::setLogLevel(Logger::Error); // radio and stations log every frame/update
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription("Benchmarks the fanet codec, parser and message dispatcher, results are written as json.");
+	parser.addHelpOption();
+	parser.addVersionOption();
+	parser.addOption(QCommandLineOption(QStringList() << "n" << "iterations", "Iterations per microbenchmark (default: 100000)", "count", "100000"));
+	parser.addOption(QCommandLineOption(QStringList() << "r" << "rounds", "Rounds per dispatcher benchmark (default: 10000)", "count", "10000"));
+	parser.addOption(QCommandLineOption(QStringList() << "s" << "stations", "Simulated weather stations (default: 20)", "count", "20"));
+	parser.addOption(QCommandLineOption(QStringList() << "f" << "frames", "Fanet frames replayed through the dispatcher (default: 20000)", "count", "20000"));
+	parser.addOption(QCommandLineOption(QStringList() << "o" << "output", "Write the json results to file instead of stdout", "file"));
+	parser.addOption(QCommandLineOption(QStringList() << "commit", "Commit (or other label) recorded with the results", "commit"));
+	parser.addOption(QCommandLineOption(QStringList() << "l" << "loglevel", "Sets the max. log level [0..5] (default: 1)", "loglevel"));
+	parser.process(app);
+
+	if (parser.isSet("loglevel"))
+	{
+		Logger::setLogLevel(static_cast<Logger::LogType>(qBound(0, parser.value("loglevel").toInt(), static_cast<int>(Logger::Debug))));
+	}
+
+	FagsBench::Options options;
+	options.iterations = qMax(1, parser.value("iterations").toInt());
+	options.rounds = qMax(1, parser.value("rounds").toInt());
+	options.stations = qMax(1, parser.value("stations").toInt());
+	options.frames = qMax(1, parser.value("frames").toInt());
+
+	FagsBench bench(options);
+	bench.runCodec();
+	bench.runParser();
+	const bool success = bench.runDispatcher();
+
+	const QByteArray json = bench.report(parser.value("commit")).toJson(QJsonDocument::Indented);
+	if (parser.isSet("output"))
+	{
+		QFile file(parser.value("output"));
+		if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(json) != json.size())
+		{
+			LOGGER_ERROR(log, QString("failed to write %1: %2").arg(file.fileName(), file.errorString()));
+			return 1;
+		}
+	} else
+	{
+		QFile out;
+		out.open(stdout, QIODevice::WriteOnly);
+		out.write(json);
+	}
+	return success ? 0 : 1;
+}
@@ -0,0 +1,173 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+/**
+ * Feeds received fanet frames through FanetProtocolParser and logs them like FanetRadio does, once with
+ * eagerly formatted messages (as before) and once with the lazy LOGGER_*() macros. At the default log
+ * level (3 = notice) none of the messages is written, so the difference is the formatting cost saved.
+ *
+ * With --console it measures console output (lines/sec) instead: the per-line QDateTime formatting as
+ * Logger did before vs. the cached timestamp for each Logger::TimestampFormat. Redirect stdout, e.g.
+ * 'fags_logbench --console >/dev/null', results are written to stderr.
+ *
+ * With --replay the frames are taken from a capture file (see fagsd --capture) instead of a synthetic one.
+ */
+
+#include <QBuffer>
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QCommandLineOption>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <sys/resource.h>
+#include "logger.h"
+#include "config.h"
+#include "fanet/fanetprotocolparser.h"
+#include "fanet/receiveevent.h"
+#include "fanet/uartreplay.h"
+
+static const char FRAME[] = "#FNF 11,5C0B,1,0,2,b,42656e63682050696c6f74\n"; // name payload: "Bench Pilot"
+static const char LINE[]  = "N47.5000,E11.1000 (GroundStation) wind=12.5km/h, gusts=20.0km/h, dir=270";
+
+static double cpuTime()
+{
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+}
+
+static double run(const QByteArray &input, bool lazy)
+{
+	QBuffer dev;
+	dev.setData(input);
+	dev.open(QIODevice::ReadOnly);
+	FanetProtocolParser parser(&dev);
+	Logger log("FanetRadio");
+
+	const double started = cpuTime();
+	AbstractFanetMessage *msg;
+	while ((msg = parser.next()))
+	{
+		const ReceiveEvent *event = dynamic_cast<const ReceiveEvent*>(msg);
+		if (!event)
+		{
+			delete msg;
+			continue;
+		}
+		if (lazy)
+		{
+			LOGGER_INFO(log, event->toString());
+		} else
+		{
+			log.debug(QString("Msg received: '%1'").arg(msg->serialize())); // what the parser used to format
+			log.info(event->toString());
+		}
+		delete msg;
+	}
+	return cpuTime() - started;
+}
+
+static double writeUncached(int lines)
+{
+	QTextStream out(stdout);
+	const QString message(LINE);
+	QElapsedTimer timer;
+	timer.start();
+	for (int i = 0; i < lines; i++) // what Logger used to do for every console line
+	{
+		out << QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss: %1: %2: %3").arg("NOTICE", "LogBench", message) << '\n';
+		out.flush();
+	}
+	return timer.nsecsElapsed() / 1e9;
+}
+
+static double writeLogger(int lines, Logger::TimestampFormat format)
+{
+	Logger log("LogBench");
+	const QString message(LINE);
+	Logger::setTimestampFormat(format);
+	QElapsedTimer timer;
+	timer.start();
+	for (int i = 0; i < lines; i++)
+	{
+		log.notice(message);
+	}
+	return timer.nsecsElapsed() / 1e9;
+}
+
+static void benchConsole(int lines)
+{
+	Logger::setLogTargets(Logger::LogToConsole);
+	Logger::setConsoleColors(false);
+	const double uncached = writeUncached(lines);
+	const double seconds = writeLogger(lines, Logger::TimestampSeconds);
+	const double millis = writeLogger(lines, Logger::TimestampMillis);
+	const double monotonic = writeLogger(lines, Logger::TimestampMonotonic);
+
+	QTextStream err(stderr);
+	err << "lines:      " << lines << "\n";
+	err << "uncached:   " << QString::number(lines / uncached, 'f', 0) << " lines/s\n";
+	err << "sec:        " << QString::number(lines / seconds, 'f', 0) << " lines/s\n";
+	err << "msec:       " << QString::number(lines / millis, 'f', 0) << " lines/s\n";
+	err << "mono:       " << QString::number(lines / monotonic, 'f', 0) << " lines/s\n";
+}
+
+int main(int argc, char *argv[])
+{
+	QCoreApplication app(argc, argv);
+	app.setApplicationName("fags_logbench");
+	app.setApplicationVersion(VERSION);
+	Logger::instance(); // main thread must be the first to use the logger
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription("Measures the cpu time spent on log formatting in the fanet rx path.");
+	parser.addHelpOption();
+	parser.addVersionOption();
+	parser.addOption(QCommandLineOption(QStringList() << "n" << "frames", "Number of frames (default: 200000)", "count", "200000"));
+	parser.addOption(QCommandLineOption(QStringList() << "l" << "loglevel", "Max. log level [0..5] (default: 3)", "loglevel", "3"));
+	parser.addOption(QCommandLineOption(QStringList() << "c" << "console", "Measure console output (lines/sec) instead, results on stderr"));
+	parser.addOption(QCommandLineOption(QStringList() << "r" << "replay", "Parse the data of a capture file (fagsd --capture) instead", "replay"));
+	parser.process(app);
+
+	int frames = qMax(1, parser.value("frames").toInt());
+	Logger::setLogLevel(static_cast<Logger::LogType>(qBound(0, parser.value("loglevel").toInt(), static_cast<int>(Logger::Debug))));
+	if (parser.isSet("console"))
+	{
+		benchConsole(frames);
+		return 0;
+	}
+
+	QByteArray input;
+	if (parser.isSet("replay"))
+	{
+		UartReplay replay;
+		if (!replay.load(parser.value("replay")))
+		{
+			return 1;
+		}
+		input = replay.data();
+		frames = qMax(1, static_cast<int>(input.count(static_cast<char>(FanetProtocolParser::EndDelimiter))));
+	} else
+	{
+		input.reserve(frames * (sizeof(FRAME) - 1));
+		for (int i = 0; i < frames; i++)
+		{
+			input.append(FRAME);
+		}
+	}
+
+	run(input, true); // warm up
+	const double eager = run(input, false);
+	const double lazy = run(input, true);
+
+	QTextStream out(stdout);
+	out << "frames:   " << frames << ", log level " << Logger::logLevel() << "\n";
+	out << "eager:    " << QString::number(eager, 'f', 3) << "s cpu (" << QString::number(eager * 1e9 / frames, 'f', 0) << " ns/frame)\n";
+	out << "lazy:     " << QString::number(lazy, 'f', 3) << "s cpu (" << QString::number(lazy * 1e9 / frames, 'f', 0) << " ns/frame)\n";
+	out << "saved:    " << QString::number(eager > 0 ? 100.0 * (eager - lazy) / eager : 0.0, 'f', 1) << "%\n";
+	return 0;
+}
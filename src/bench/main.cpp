@@ -0,0 +1,79 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QCommandLineOption>
+#include "logger.h"
+#include "config.h"
+#include "mockweatherserver.h"
+#include "weatherbench.h"
+
+int main(int argc, char *argv[])
+{
+	QCoreApplication app(argc, argv);
+	app.setApplicationName("fags_weatherbench");
+	app.setApplicationVersion(VERSION);
+	Logger log("main"); // main thread must be the first to log
+	Logger::setLogLevel(Logger::Error); // drivers log every update
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription("Polls weather station drivers against a local mock server and reports throughput, latencies and resource usage.");
+	parser.addHelpOption();
+	parser.addVersionOption();
+	parser.addOption(QCommandLineOption(QStringList() << "n" << "stations", "Number of stations (default: 1000)", "count", "1000"));
+	parser.addOption(QCommandLineOption(QStringList() << "P" << "providers", "Comma separated providers (default: holfuyapi,holfuywidget,windbird)", "list", "holfuyapi,holfuywidget,windbird"));
+	parser.addOption(QCommandLineOption(QStringList() << "t" << "duration", "Duration in seconds (default: 300)", "secs", "300"));
+	parser.addOption(QCommandLineOption(QStringList() << "i" << "interval", "Update interval in seconds (default: 60)", "secs", "60"));
+	parser.addOption(QCommandLineOption(QStringList() << "u" << "publish", "Publishing period of the simulated stations in seconds (default: 60)", "secs", "60"));
+	parser.addOption(QCommandLineOption(QStringList() << "latency", "Server reply latency in msecs (default: 50)", "msecs", "50"));
+	parser.addOption(QCommandLineOption(QStringList() << "jitter", "Random latency added per reply in msecs (default: 50)", "msecs", "50"));
+	parser.addOption(QCommandLineOption(QStringList() << "error-rate", "Fraction of requests answered with http 500 (default: 0)", "rate", "0"));
+	parser.addOption(QCommandLineOption(QStringList() << "drop-rate", "Fraction of requests never answered (default: 0)", "rate", "0"));
+	parser.addOption(QCommandLineOption(QStringList() << "max-inflight", "Scheduler: max. requests in flight (default: 32)", "count", "32"));
+	parser.addOption(QCommandLineOption(QStringList() << "rate", "Scheduler: requests/sec. per provider (default: 1000)", "rate", "1000"));
+	parser.addOption(QCommandLineOption(QStringList() << "burst", "Scheduler: burst per provider (default: 100)", "count", "100"));
+	parser.addOption(QCommandLineOption(QStringList() << "port", "Mock server port (default: any)", "port", "0"));
+	parser.addOption(QCommandLineOption(QStringList() << "l" << "loglevel", "Sets the max. log level [0..5] (default: 1)", "loglevel"));
+	parser.process(app);
+
+	if (parser.isSet("loglevel"))
+	{
+		Logger::setLogLevel(static_cast<Logger::LogType>(qBound(0, parser.value("loglevel").toInt(), static_cast<int>(Logger::Debug))));
+	}
+
+	WeatherBench::Options options;
+	options.stations = qMax(1, parser.value("stations").toInt());
+	options.providers = parser.value("providers").split(',', Qt::SkipEmptyParts);
+	options.duration = qMax(1, parser.value("duration").toInt());
+	options.interval = qMax(1, parser.value("interval").toInt());
+	options.maxInFlight = qMax(1, parser.value("max-inflight").toInt());
+	options.rate = qMax(0.001, parser.value("rate").toDouble());
+	options.burst = qMax(1, parser.value("burst").toInt());
+	if (options.providers.isEmpty())
+	{
+		LOGGER_ERROR(log, "no providers given");
+		return 1;
+	}
+
+	MockWeatherServer server;
+	server.setLatency(parser.value("latency").toInt(), parser.value("jitter").toInt());
+	server.setErrorRate(parser.value("error-rate").toDouble());
+	server.setDropRate(parser.value("drop-rate").toDouble());
+	server.setUpdatePeriod(parser.value("publish").toInt());
+	if (!server.listen(static_cast<quint16>(parser.value("port").toUInt())))
+	{
+		return 1;
+	}
+
+	WeatherBench bench(options, &server);
+	QObject::connect(&bench, &WeatherBench::finished, &app, &QCoreApplication::quit, Qt::QueuedConnection);
+	if (!bench.start())
+	{
+		return 1;
+	}
+	return app.exec();
+}
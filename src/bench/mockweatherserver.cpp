@@ -0,0 +1,271 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "mockweatherserver.h"
+
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QHostAddress>
+#include <QDeadlineTimer>
+#include <QDateTime>
+#include <QRandomGenerator>
+#include <QTimeZone>
+#include <QTimer>
+#include <QUrl>
+#include <QUrlQuery>
+
+static const qsizetype REQUEST_HEADER_MAX   = 8192;
+static const char      HEADER_END[]         = "\r\n\r\n";
+static const char      PATH_HOLFUY_API[]    = "/live/";
+static const char      PATH_PIOUPIOU[]      = "/v1/live/";
+static const char      QUERY_HOLFUY_API[]   = "s";
+static const char      QUERY_HOLFUY_WIDGET[]= "station";
+static const int       WIDGET_PADDING       = 1500; // widget data is not at the beginning of the page
+
+
+MockWeatherServer::MockWeatherServer(QObject *parent) :
+    QObject(parent),
+    m_log("MockWeatherServer"),
+    m_server(new QTcpServer(this)),
+    m_timer(new QTimer(this)),
+    m_buffers(),
+    m_pending(),
+    m_latency(0),
+    m_jitter(0),
+    m_errorRate(0.0),
+    m_dropRate(0.0),
+    m_period(60),
+    m_stats{0, 0, 0, 0}
+{
+	m_timer->setSingleShot(true);
+	m_timer->setTimerType(Qt::PreciseTimer);
+	connect(m_timer, &QTimer::timeout, this, &MockWeatherServer::sendPending);
+	connect(m_server, &QTcpServer::newConnection, this, &MockWeatherServer::onNewConnection);
+}
+
+MockWeatherServer::~MockWeatherServer()
+{
+	m_server->close();
+}
+
+bool MockWeatherServer::listen(quint16 port)
+{
+	if (!m_server->listen(QHostAddress::LocalHost, port))
+	{
+		LOGGER_ERROR(m_log, QString("failed to listen on port %1: %2").arg(port).arg(m_server->errorString()));
+		return false;
+	}
+	m_log.info(QString("listening on %1").arg(url()));
+	return true;
+}
+
+QString MockWeatherServer::url() const
+{
+	return QString("http://127.0.0.1:%1").arg(m_server->serverPort());
+}
+
+void MockWeatherServer::setLatency(int msecs, int jitterMsecs)
+{
+	m_latency = qMax(0, msecs);
+	m_jitter = qMax(0, jitterMsecs);
+}
+
+void MockWeatherServer::setErrorRate(double rate)
+{
+	m_errorRate = qBound(0.0, rate, 1.0);
+}
+
+void MockWeatherServer::setDropRate(double rate)
+{
+	m_dropRate = qBound(0.0, rate, 1.0);
+}
+
+void MockWeatherServer::setUpdatePeriod(int secs)
+{
+	m_period = qMax(1, secs);
+}
+
+qint64 MockWeatherServer::clock()
+{
+	return QDeadlineTimer::current().deadlineNSecs() / 1000;
+}
+
+void MockWeatherServer::onNewConnection()
+{
+	while (m_server->hasPendingConnections())
+	{
+		QTcpSocket *socket = m_server->nextPendingConnection();
+		m_buffers.insert(socket, QByteArray());
+		connect(socket, &QTcpSocket::readyRead, this, &MockWeatherServer::onReadyRead);
+		connect(socket, &QTcpSocket::disconnected, this, &MockWeatherServer::onDisconnected);
+	}
+}
+
+void MockWeatherServer::onDisconnected()
+{
+	QTcpSocket *socket = qobject_cast<QTcpSocket*>(sender());
+	if (socket)
+	{
+		m_buffers.remove(socket);
+		socket->deleteLater(); // pending replies hold a QPointer, so they are skipped
+	}
+}
+
+void MockWeatherServer::onReadyRead()
+{
+	QTcpSocket *socket = qobject_cast<QTcpSocket*>(sender());
+	if (!socket || !m_buffers.contains(socket))
+	{
+		return;
+	}
+
+	QByteArray &buffer = m_buffers[socket];
+	buffer.append(socket->readAll());
+	qsizetype end;
+	while ((end = buffer.indexOf(HEADER_END)) >= 0) // GET requests have no body
+	{
+		const qsizetype lineEnd = buffer.indexOf("\r\n");
+		handleRequest(socket, buffer.left(lineEnd));
+		buffer.remove(0, end + sizeof(HEADER_END) - 1);
+	}
+	if (buffer.size() > REQUEST_HEADER_MAX)
+	{
+		LOGGER_WARNING(m_log, "request header too large, closing connection");
+		socket->abort();
+	}
+}
+
+void MockWeatherServer::handleRequest(QTcpSocket *socket, const QByteArray &requestLine)
+{
+	const qint64 now = clock();
+	m_stats.requests++;
+
+	// request line: GET <target> HTTP/1.1
+	const QList<QByteArray> parts = requestLine.split(' ');
+	const QUrl target(parts.size() == 3 ? QString::fromLatin1(parts.at(1)) : QString());
+	const QUrlQuery query(target);
+	const QString path = target.path();
+
+	int id = -1;
+	QByteArray body;
+	const char *contentType = "application/json";
+	if (path.startsWith(PATH_PIOUPIOU))
+	{
+		id = path.mid(sizeof(PATH_PIOUPIOU) - 1).toInt();
+		body = pioupiou(id);
+	} else if (path.startsWith(PATH_HOLFUY_API) && query.hasQueryItem(QUERY_HOLFUY_API))
+	{
+		id = query.queryItemValue(QUERY_HOLFUY_API).toInt();
+		body = holfuyApi(id);
+	} else if (path == "/" && query.hasQueryItem(QUERY_HOLFUY_WIDGET))
+	{
+		id = query.queryItemValue(QUERY_HOLFUY_WIDGET).toInt();
+		body = holfuyWidget(id);
+		contentType = "text/html; charset=UTF-8";
+	}
+	emit requestReceived(id, now);
+
+	QByteArray reply;
+	const double dice = QRandomGenerator::global()->generateDouble();
+	if (id < 0)
+	{
+		m_stats.errors++;
+		reply = response(404, "Not Found", "text/plain", "not found");
+	} else if (dice < m_dropRate)
+	{
+		m_stats.dropped++;
+		return; // client runs into its timeout
+	} else if (dice < m_dropRate + m_errorRate)
+	{
+		m_stats.errors++;
+		reply = response(500, "Internal Server Error", "text/plain", "simulated error");
+	} else
+	{
+		reply = response(200, "OK", contentType, body);
+	}
+
+	const qint64 delay = (m_latency + (m_jitter > 0 ? QRandomGenerator::global()->bounded(m_jitter + 1) : 0)) * 1000LL;
+	m_pending.insert(now + delay, Pending{QPointer<QTcpSocket>(socket), reply, id, now});
+	if (delay == 0 || !m_timer->isActive() || m_timer->remainingTime() * 1000LL > delay)
+	{
+		m_timer->start(static_cast<int>(delay / 1000));
+	}
+}
+
+void MockWeatherServer::sendPending()
+{
+	qint64 now = clock();
+	while (!m_pending.isEmpty() && m_pending.firstKey() <= now)
+	{
+		const Pending p = m_pending.first();
+		m_pending.erase(m_pending.begin());
+		if (p.socket && p.socket->state() == QAbstractSocket::ConnectedState)
+		{
+			p.socket->write(p.data);
+			m_stats.bytesSent += p.data.size();
+			now = clock();
+			emit responseSent(p.stationId, p.received, now);
+		}
+	}
+	if (!m_pending.isEmpty())
+	{
+		m_timer->start(static_cast<int>(qMax<qint64>(0, (m_pending.firstKey() - now + 999) / 1000)));
+	}
+}
+
+QByteArray MockWeatherServer::response(int status, const char *reason, const char *contentType, const QByteArray &body)
+{
+	QByteArray data;
+	data.reserve(body.size() + 128);
+	data.append("HTTP/1.1 ").append(QByteArray::number(status)).append(' ').append(reason).append("\r\n");
+	data.append("Content-Type: ").append(contentType).append("\r\n");
+	data.append("Content-Length: ").append(QByteArray::number(body.size())).append("\r\n");
+	data.append("Connection: keep-alive\r\n\r\n");
+	data.append(body);
+	return data;
+}
+
+// The simulated values only depend on station id and publishing period, so every
+// station delivers identical data within a period (like real stations do).
+
+QByteArray MockWeatherServer::holfuyApi(int id) const
+{
+	const qint64 epoch = QDateTime::currentSecsSinceEpoch() / m_period;
+	const QDateTime published = QDateTime::fromSecsSinceEpoch(epoch * m_period, QTimeZone::UTC);
+	const int speed = static_cast<int>((id * 7 + epoch * 3) % 40);
+	return QString("{\"stationId\":%1,\"stationName\":\"Mock %1\",\"dateTime\":\"%2\","
+	               "\"wind\":{\"speed\":%3,\"gust\":%4,\"min\":%5,\"unit\":\"km/h\",\"direction\":%6},\"temperature\":%7}")
+	        .arg(id).arg(published.toString("yyyy-MM-dd HH:mm:ss")).arg(speed).arg(speed + epoch % 10).arg(speed / 2)
+	        .arg((id * 37 + epoch * 11) % 360).arg(((id + epoch) % 300) / 10.0).toLatin1();
+}
+
+QByteArray MockWeatherServer::holfuyWidget(int id) const
+{
+	const qint64 epoch = QDateTime::currentSecsSinceEpoch() / m_period;
+	const QDateTime published = QDateTime::fromSecsSinceEpoch(epoch * m_period).toLocalTime();
+	const int speed = static_cast<int>((id * 7 + epoch * 3) % 40);
+	QByteArray html("<!DOCTYPE html><html><head><title>Holfuy Widget</title><style>");
+	html.append(QByteArray(WIDGET_PADDING, ' '));
+	html.append("</style></head><body><script>");
+	html.append(QString("newWind(%1,%2,%3,%4,'%5');")
+	            .arg((id * 37 + epoch * 11) % 360).arg(speed).arg(((id + epoch) % 300) / 10.0).arg(speed + epoch % 10)
+	            .arg(published.toString("HH:mm")).toLatin1());
+	html.append("</script></body></html>");
+	return html;
+}
+
+QByteArray MockWeatherServer::pioupiou(int id) const
+{
+	const qint64 epoch = QDateTime::currentSecsSinceEpoch() / m_period;
+	const QDateTime published = QDateTime::fromSecsSinceEpoch(epoch * m_period, QTimeZone::UTC);
+	const int speed = static_cast<int>((id * 7 + epoch * 3) % 40);
+	return QString("{\"doc\":\"mock\",\"license\":\"mock\",\"attribution\":\"mock\",\"data\":{\"id\":%1,"
+	               "\"meta\":{\"name\":\"Mock %1\"},\"location\":{\"latitude\":47.5,\"longitude\":11.1},"
+	               "\"measurements\":{\"date\":\"%2\",\"pressure\":null,\"wind_heading\":%3,"
+	               "\"wind_speed_avg\":%4,\"wind_speed_max\":%5,\"wind_speed_min\":%6}}}")
+	        .arg(id).arg(published.toString("yyyy-MM-ddTHH:mm:ss.zzzZ")).arg((id * 37 + epoch * 11) % 360)
+	        .arg(speed).arg(speed + epoch % 10).arg(speed / 2).toLatin1();
+}
@@ -0,0 +1,93 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef MOCKWEATHERSERVER_H
+#define MOCKWEATHERSERVER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QHash>
+#include <QMultiMap>
+#include <QPointer>
+#include <QString>
+#include "logger.h"
+
+class QTimer;
+class QTcpServer;
+class QTcpSocket;
+
+/**
+ * @class MockWeatherServer is a minimal local HTTP/1.1 server (keep-alive, GET only) answering in the formats
+ * of the Holfuy live API (/live/?s=<id>), the Holfuy widget (/?station=<id>) and the Pioupiou v1 API
+ * (/v1/live/<id>). Every simulated station publishes new data once per update period. Replies are delayed
+ * by a configurable latency, a configurable fraction is answered with http 500 or not answered at all.
+ */
+class MockWeatherServer : public QObject
+{
+	Q_OBJECT
+public:
+	struct Stats
+	{
+		quint64 requests;  // requests received
+		quint64 errors;    // answered with http error
+		quint64 dropped;   // never answered
+		quint64 bytesSent;
+	};
+
+	explicit MockWeatherServer(QObject *parent = nullptr);
+	virtual ~MockWeatherServer() Q_DECL_OVERRIDE;
+
+	bool listen(quint16 port = 0); // 0 = any free port
+	QString url() const;           // e.g. http://127.0.0.1:<port>
+
+	void setLatency(int msecs, int jitterMsecs = 0);
+	void setErrorRate(double rate); // 0.0 .. 1.0
+	void setDropRate(double rate);  // 0.0 .. 1.0
+	void setUpdatePeriod(int secs); // publishing period of the simulated stations
+
+	Stats stats() const { return m_stats; }
+
+	static qint64 clock(); // monotonic time in usecs, used for all timestamps emitted
+
+signals:
+	void requestReceived(int stationId, qint64 timestamp);
+	void responseSent(int stationId, qint64 requestTimestamp, qint64 timestamp);
+
+private slots:
+	void onNewConnection();
+	void onReadyRead();
+	void onDisconnected();
+	void sendPending();
+
+private:
+	struct Pending
+	{
+		QPointer<QTcpSocket> socket;
+		QByteArray data;
+		int stationId;
+		qint64 received;
+	};
+
+	void handleRequest(QTcpSocket *socket, const QByteArray &requestLine);
+	QByteArray holfuyApi(int id) const;
+	QByteArray holfuyWidget(int id) const;
+	QByteArray pioupiou(int id) const;
+	static QByteArray response(int status, const char *reason, const char *contentType, const QByteArray &body);
+
+	Logger m_log;
+	QTcpServer *m_server;
+	QTimer *m_timer;
+	QHash<QTcpSocket*, QByteArray> m_buffers;
+	QMultiMap<qint64, Pending> m_pending; // key: due time (usecs)
+	int m_latency;
+	int m_jitter;
+	double m_errorRate;
+	double m_dropRate;
+	int m_period;
+	Stats m_stats;
+};
+
+#endif // MOCKWEATHERSERVER_H
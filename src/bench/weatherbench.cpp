@@ -0,0 +1,249 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "weatherbench.h"
+#include "mockweatherserver.h"
+#include "config.h"
+#include "config/schedulerconfig.h"
+#include "weatherstation/fetchscheduler.h"
+#include "weatherstation/stationregistry.h"
+
+#include <QFile>
+#include <QGeoCoordinate>
+#include <QTextStream>
+#include <QTimer>
+#include <algorithm>
+#include <sys/resource.h>
+
+static const int    TICK_INTERVAL_MSEC = 100; // event loop lag is measured by a precise timer of this interval
+static const char   BENCH_APIKEY[]     = "bench";
+
+
+WeatherBench::WeatherBench(const Options &options, MockWeatherServer *server, QObject *parent) :
+    QObject(parent),
+    m_log("WeatherBench"),
+    m_options(options),
+    m_server(server),
+    m_scheduler(nullptr),
+    m_tick(new QTimer(this)),
+    m_done(new QTimer(this)),
+    m_stations(),
+    m_timing(),
+    m_intervals(),
+    m_perProvider(),
+    m_parseLatency(),
+    m_totalLatency(),
+    m_loopLag(),
+    m_periodDrift(),
+    m_succeeded(0),
+    m_failed(0),
+    m_started(0),
+    m_lastTick(0),
+    m_cpuStarted(0.0)
+{
+	m_tick->setTimerType(Qt::PreciseTimer);
+	m_done->setSingleShot(true);
+	connect(m_tick, &QTimer::timeout, this, &WeatherBench::onTick);
+	connect(m_done, &QTimer::timeout, this, &WeatherBench::onDone);
+	connect(m_server, &MockWeatherServer::requestReceived, this, &WeatherBench::onRequestReceived);
+	connect(m_server, &MockWeatherServer::responseSent, this, &WeatherBench::onResponseSent);
+}
+
+WeatherBench::~WeatherBench()
+{
+	qDeleteAll(m_stations); // before the scheduler
+	m_stations.clear();
+	delete m_scheduler;
+}
+
+bool WeatherBench::start()
+{
+	SchedulerConfig config(m_options.maxInFlight, m_options.interval); // start jitter: spread stations over one interval
+	foreach (const QString &provider, m_options.providers)
+	{
+		if (!StationRegistry::instance().provider(provider))
+		{
+			LOGGER_ERROR(m_log, QString("unknown provider: '%1'").arg(provider));
+			return false;
+		}
+		config.setProviderLimit(provider, m_options.rate, m_options.burst);
+	}
+	m_scheduler = new FetchScheduler(config, this);
+
+	for (int i = 0; i < m_options.stations; i++)
+	{
+		const int id = i + 1; // ids are unique across providers, the server reports by id only
+		const QString provider = m_options.providers.at(i % m_options.providers.size());
+		const StationRegistry::Provider *info = StationRegistry::instance().provider(provider);
+		StationConfig stationConfig(static_cast<StationConfig::StationType>(info->type), id, QString("Bench %1").arg(id),
+		                            BENCH_APIKEY, QGeoCoordinate(47.5, 11.1, 700), m_options.interval);
+		stationConfig.setAttribute(CONFIG_ATTR_URL, m_server->url());
+		AbstractWeatherStation *station = AbstractWeatherStation::fromConfig(stationConfig);
+		if (!station)
+		{
+			LOGGER_ERROR(m_log, QString("failed to create station #%1 (%2)").arg(id).arg(provider));
+			return false;
+		}
+		connect(station, &AbstractWeatherStation::updateFinished, this, &WeatherBench::onUpdateFinished);
+		m_stations << station;
+		m_intervals.insert(id, station->updateInterval() * 1000);
+		m_perProvider[provider]++;
+	}
+
+	m_log.info(QString("starting %1 stations for %2sec.").arg(m_stations.size()).arg(m_options.duration));
+	m_started = MockWeatherServer::clock();
+	m_lastTick = m_started;
+	m_cpuStarted = cpuTime();
+	foreach (AbstractWeatherStation *station, m_stations)
+	{
+		station->requestUpdate(true); // jittered, as the dispatcher does
+	}
+	m_tick->start(TICK_INTERVAL_MSEC);
+	m_done->start(m_options.duration * 1000);
+	return true;
+}
+
+void WeatherBench::onRequestReceived(int stationId, qint64 timestamp)
+{
+	Timing &t = m_timing[stationId];
+	const int interval = m_intervals.value(stationId);
+	if (t.lastRequest > 0 && interval > 0)
+	{
+		m_periodDrift.push_back(qAbs(timestamp - t.lastRequest - interval * 1000LL));
+	}
+	t.lastRequest = timestamp;
+	t.requested = timestamp;
+	t.responded = 0;
+}
+
+void WeatherBench::onResponseSent(int stationId, qint64 requestTimestamp, qint64 timestamp)
+{
+	QHash<int, Timing>::iterator it = m_timing.find(stationId);
+	if (it != m_timing.end() && it->requested == requestTimestamp)
+	{
+		it->responded = timestamp;
+	}
+}
+
+void WeatherBench::onUpdateFinished(bool success)
+{
+	const qint64 now = MockWeatherServer::clock();
+	AbstractWeatherStation *station = qobject_cast<AbstractWeatherStation*>(sender());
+	if (!station)
+	{
+		return;
+	}
+
+	if (success)
+	{
+		m_succeeded++;
+	} else
+	{
+		m_failed++;
+	}
+	QHash<int, Timing>::iterator it = m_timing.find(station->stationId());
+	if (it != m_timing.end() && it->requested > 0)
+	{
+		if (it->responded > 0)
+		{
+			m_parseLatency.push_back(now - it->responded);
+		}
+		m_totalLatency.push_back(now - it->requested);
+		it->requested = 0;
+	}
+}
+
+void WeatherBench::onTick()
+{
+	const qint64 now = MockWeatherServer::clock();
+	m_loopLag.push_back(qMax<qint64>(0, now - m_lastTick - TICK_INTERVAL_MSEC * 1000LL));
+	m_lastTick = now;
+}
+
+void WeatherBench::onDone()
+{
+	m_tick->stop();
+	report();
+	emit finished();
+}
+
+QString WeatherBench::percentiles(std::vector<qint64> &values, double scale, const QString &unit)
+{
+	if (values.empty())
+	{
+		return "n/a";
+	}
+	std::sort(values.begin(), values.end());
+	const size_t n = values.size();
+	double sum = 0.0;
+	for (qint64 v : values)
+	{
+		sum += v;
+	}
+	return QString("mean %1%6, p50 %2%6, p90 %3%6, p99 %4%6, max %5%6 (n=%7)")
+	        .arg(sum / n / scale, 0, 'f', 2)
+	        .arg(values[n / 2] / scale, 0, 'f', 2)
+	        .arg(values[n * 9 / 10] / scale, 0, 'f', 2)
+	        .arg(values[n * 99 / 100] / scale, 0, 'f', 2)
+	        .arg(values[n - 1] / scale, 0, 'f', 2)
+	        .arg(unit).arg(n);
+}
+
+double WeatherBench::cpuTime()
+{
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+	{
+		return 0.0;
+	}
+	return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+}
+
+qint64 WeatherBench::memory(const char *key)
+{
+	QFile status("/proc/self/status");
+	if (!status.open(QIODevice::ReadOnly | QIODevice::Text))
+	{
+		return -1;
+	}
+	while (!status.atEnd())
+	{
+		const QByteArray line = status.readLine();
+		if (line.startsWith(key))
+		{
+			return line.mid(qstrlen(key)).trimmed().split(' ').first().toLongLong(); // e.g. "VmRSS:  1234 kB"
+		}
+	}
+	return -1;
+}
+
+void WeatherBench::report()
+{
+	const double elapsed = (MockWeatherServer::clock() - m_started) / 1e6;
+	const double cpu = cpuTime() - m_cpuStarted;
+	const MockWeatherServer::Stats server = m_server->stats();
+
+	QStringList mix;
+	for (QHash<QString, int>::const_iterator it = m_perProvider.constBegin(); it != m_perProvider.constEnd(); ++it)
+	{
+		mix << QString("%1 %2").arg(it.key()).arg(it.value());
+	}
+
+	QTextStream out(stdout);
+	out << "stations:          " << m_stations.size() << " (" << mix.join(", ") << ")\n";
+	out << "duration:          " << QString::number(elapsed, 'f', 1) << "s\n";
+	out << "requests:          " << server.requests << " (" << QString::number(server.requests / elapsed, 'f', 1) << " req/s), "
+	    << server.errors << " errors, " << server.dropped << " dropped, " << server.bytesSent / 1024 << " kB sent\n";
+	out << "updates:           " << m_succeeded << " ok, " << m_failed << " failed ("
+	    << QString::number((m_succeeded + m_failed) / elapsed, 'f', 1) << " /s)\n";
+	out << "reply -> parsed:   " << percentiles(m_parseLatency, 1.0, "us") << "\n";
+	out << "request -> parsed: " << percentiles(m_totalLatency, 1000.0, "ms") << "\n";
+	out << "event loop lag:    " << percentiles(m_loopLag, 1000.0, "ms") << "\n";
+	out << "poll period drift: " << percentiles(m_periodDrift, 1000.0, "ms") << "\n";
+	out << "cpu:               " << QString::number(cpu, 'f', 2) << "s (" << QString::number(100.0 * cpu / elapsed, 'f', 1) << "% of one core)\n";
+	out << "rss:               " << memory("VmRSS:") << " kB (peak " << memory("VmHWM:") << " kB)\n";
+	out.flush();
+}
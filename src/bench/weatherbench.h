@@ -0,0 +1,91 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef WEATHERBENCH_H
+#define WEATHERBENCH_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <vector>
+#include "logger.h"
+#include "weatherstation/abstractweatherstation.h"
+
+class QTimer;
+class FetchScheduler;
+class MockWeatherServer;
+
+/**
+ * @class WeatherBench polls a (large) number of weather station drivers against a MockWeatherServer through
+ * the regular FetchScheduler and reports throughput, cpu and memory usage, latencies and timer drift.
+ */
+class WeatherBench : public QObject
+{
+	Q_OBJECT
+public:
+	struct Options
+	{
+		int stations;         // number of stations, distributed evenly over providers
+		QStringList providers;// xml element names, e.g. holfuyapi, holfuywidget, windbird
+		int duration;         // in seconds
+		int interval;         // update interval in seconds (drivers may enforce a minimum)
+		int maxInFlight;
+		double rate;          // per provider token bucket
+		int burst;
+	};
+
+	explicit WeatherBench(const Options &options, MockWeatherServer *server, QObject *parent = nullptr);
+	virtual ~WeatherBench() Q_DECL_OVERRIDE;
+
+	bool start();
+
+signals:
+	void finished();
+
+private slots:
+	void onRequestReceived(int stationId, qint64 timestamp);
+	void onResponseSent(int stationId, qint64 requestTimestamp, qint64 timestamp);
+	void onUpdateFinished(bool success);
+	void onTick();
+	void onDone();
+
+private:
+	struct Timing
+	{
+		qint64 lastRequest;  // usecs, previous request of the station
+		qint64 requested;    // usecs, request of the running update
+		qint64 responded;    // usecs, reply written by the server (0 = none yet)
+	};
+
+	void report();
+	static QString percentiles(std::vector<qint64> &values, double scale, const QString &unit);
+	static double cpuTime();       // user + sys in seconds
+	static qint64 memory(const char *key); // from /proc/self/status, in kB
+
+	Logger m_log;
+	const Options m_options;
+	MockWeatherServer *m_server;
+	FetchScheduler *m_scheduler;
+	QTimer *m_tick;
+	QTimer *m_done;
+	WeatherStationList m_stations;
+	QHash<int, Timing> m_timing;   // key: station id
+	QHash<int, int> m_intervals;   // key: station id, value: effective update interval (msecs)
+	QHash<QString, int> m_perProvider;
+	std::vector<qint64> m_parseLatency;   // reply written -> update finished (usecs)
+	std::vector<qint64> m_totalLatency;   // request received -> update finished (usecs)
+	std::vector<qint64> m_loopLag;        // tick lateness (usecs)
+	std::vector<qint64> m_periodDrift;    // |request period - update interval| (usecs)
+	quint64 m_succeeded;
+	quint64 m_failed;
+	qint64 m_started;
+	qint64 m_lastTick;
+	double m_cpuStarted;
+};
+
+#endif // WEATHERBENCH_H
@@ -7,6 +7,7 @@
 #include "fagsconfig.h"
 #include "logger.h"
 #include "config.h"
+#include "weatherstation/stationregistry.h"
 
 #include <QFile>
 #include <QStringList>
@@ -19,6 +20,9 @@ FagsConfigData::FagsConfigData(const FagsConfigData &other) :
     minorVer(other.minorVer),
     radio(other.radio),
     fanet(other.fanet),
+    scheduler(other.scheduler),
+    metrics(other.metrics),
+    traffic(other.traffic),
     stations(other.stations)
 {
 }
@@ -32,12 +36,12 @@ FagsConfig::FagsConfig(const QString &xmlFile) :
 	bool xmlOk = true;
 	if (xmlFile.isEmpty() || !file.exists())
 	{
-		log.error(QString("config file not found: '%1'").arg(xmlFile));
+		LOGGER_ERROR(log, QString("config file not found: '%1'").arg(xmlFile));
 		return;
 	}
 	if (!file.open(QIODevice::ReadOnly))
 	{
-		log.error(QString("failed to open config file: %1").arg(file.errorString()));
+		LOGGER_ERROR(log, QString("failed to open config file: %1").arg(file.errorString()));
 		return;
 	}
 	xml.setDevice(&file);
@@ -51,7 +55,7 @@ FagsConfig::FagsConfig(const QString &xmlFile) :
 					xmlOk = parseElementFags(xml, log);
 					continue;
 				}
-				log.error(QString("unknown element: '%1'").arg(xml.name()));
+				LOGGER_ERROR(log, QString("unknown element: '%1'").arg(xml.name()));
 				xmlOk = false;
 				break;
 			default:
@@ -76,13 +80,13 @@ bool FagsConfig::parseElementFags(QXmlStreamReader &xml, Logger &log)
 	}
 	if (!majorOk || !minorOk)
 	{
-		log.error(QString("failed to parse version number: '%1'").arg(attr.value(CONFIG_ATTR_VERSION).toString()));
+		LOGGER_ERROR(log, QString("failed to parse version number: '%1'").arg(attr.value(CONFIG_ATTR_VERSION).toString()));
 		return false;
 	}
 	if (CONFIG_VER_MAJOR != m_d->majorVer || CONFIG_VER_MINOR > m_d->minorVer)
 	{
-		log.error(QString("config version mismatch! (expected version: %1.%2, got version: %3.%4")
-		          .arg(CONFIG_VER_MAJOR).arg(CONFIG_VER_MINOR).arg(m_d->majorVer).arg(m_d->minorVer));
+		LOGGER_ERROR(log, QString("config version mismatch! (expected version: %1.%2, got version: %3.%4")
+		                  .arg(CONFIG_VER_MAJOR).arg(CONFIG_VER_MINOR).arg(m_d->majorVer).arg(m_d->minorVer));
 		return false;
 	}
 
@@ -101,17 +105,32 @@ bool FagsConfig::parseElementFags(QXmlStreamReader &xml, Logger &log)
 					if (!parseElementFanet(xml, log)) return false;
 					continue;
 				}
+				if (xml.name() == CONFIG_ELEMENT_SCHEDULER)
+				{
+					if (!parseElementScheduler(xml, log)) return false;
+					continue;
+				}
+				if (xml.name() == CONFIG_ELEMENT_METRICS)
+				{
+					if (!parseElementMetrics(xml, log)) return false;
+					continue;
+				}
+				if (xml.name() == CONFIG_ELEMENT_TRAFFIC)
+				{
+					if (!parseElementTraffic(xml, log)) return false;
+					continue;
+				}
 				if (xml.name() == CONFIG_ELEMENT_STATIONS)
 				{
 					if (!parseElementStations(xml, log)) return false;
 					continue;
 				}
-				log.error(QString("unknown element: '%1'").arg(xml.name()));
+				LOGGER_ERROR(log, QString("unknown element: '%1'").arg(xml.name()));
 				return false;
 			case QXmlStreamReader::EndElement:
 				if (xml.name() != CONFIG_ELEMENT_FAGS)
 				{
-					log.error(QString("unexpected end element: '%1' (expected '%2')").arg(xml.name(), CONFIG_ELEMENT_FAGS));
+					LOGGER_ERROR(log, QString("unexpected end element: '%1' (expected '%2')").arg(xml.name(), CONFIG_ELEMENT_FAGS));
 					return false;
 				}
 				return true; // element fags sucessfully parsed :)
@@ -119,7 +138,7 @@ bool FagsConfig::parseElementFags(QXmlStreamReader &xml, Logger &log)
 				break;
 		}
 	}
-	log.error(QString("failed to parse element '%1': %2!").arg(CONFIG_ELEMENT_FAGS, xml.errorString()));
+	LOGGER_ERROR(log, QString("failed to parse element '%1': %2!").arg(CONFIG_ELEMENT_FAGS, xml.errorString()));
 	return false;
 }
 
@@ -137,6 +156,27 @@ bool FagsConfig::parseElementFanet(QXmlStreamReader &xml, Logger &log)
 	return m_d->fanet.isValid();
 }
 
+bool FagsConfig::parseElementScheduler(QXmlStreamReader &xml, Logger &log)
+{
+	Q_UNUSED(log);
+	m_d->scheduler = SchedulerConfig(xml);
+	return m_d->scheduler.isValid();
+}
+
+bool FagsConfig::parseElementMetrics(QXmlStreamReader &xml, Logger &log)
+{
+	Q_UNUSED(log);
+	m_d->metrics = ListenConfig(xml);
+	return m_d->metrics.isValid();
+}
+
+bool FagsConfig::parseElementTraffic(QXmlStreamReader &xml, Logger &log)
+{
+	Q_UNUSED(log);
+	m_d->traffic = ListenConfig(xml);
+	return m_d->traffic.isValid();
+}
+
 bool FagsConfig::parseElementStations(QXmlStreamReader &xml, Logger &log)
 {
 	while (!xml.atEnd() && !xml.hasError())
@@ -144,21 +184,19 @@ bool FagsConfig::parseElementStations(QXmlStreamReader &xml, Logger &log)
 		switch (xml.readNext())
 		{
 			case QXmlStreamReader::StartElement:
-				if (xml.name() == CONFIG_ELEMENT_HOLFUYAPI ||
-				    xml.name() == CONFIG_ELEMENT_HOLFUYWIDGET ||
-				    xml.name() == CONFIG_ELEMENT_WINDBIRD)
+				if (StationRegistry::instance().provider(xml.name().toString()))
 				{
 					StationConfig station(xml);
 					if (!station.isValid())	return false;
 					m_d->stations << station;
 					continue;
 				}
-				log.error(QString("unknown element: '%1'").arg(xml.name()));
+				LOGGER_ERROR(log, QString("unknown element: '%1'").arg(xml.name()));
 				return false;
 			case QXmlStreamReader::EndElement:
 				if (xml.name() != CONFIG_ELEMENT_STATIONS)
 				{
-					log.error(QString("unexpected end element: '%' (expected '%2')").arg(CONFIG_ELEMENT_STATIONS, xml.name()));
+					LOGGER_ERROR(log, QString("unexpected end element: '%' (expected '%2')").arg(CONFIG_ELEMENT_STATIONS, xml.name()));
 					return false;
 				}
 				return true; // element 'stations' sucessfully parsed :)
@@ -167,6 +205,6 @@ bool FagsConfig::parseElementStations(QXmlStreamReader &xml, Logger &log)
 		}
 	}
 
-	log.error(xml.hasError() ? QString("parser error: %1").arg(xml.errorString()) : "unexpected end of file!");
+	LOGGER_ERROR(log, xml.hasError() ? QString("parser error: %1").arg(xml.errorString()) : "unexpected end of file!");
 	return false;
 }
@@ -13,6 +13,8 @@
 #include "radioconfig.h"
 #include "fanetconfig.h"
 #include "stationconfig.h"
+#include "schedulerconfig.h"
+#include "listenconfig.h"
 
 class Logger;
 class QXmlStreamReader;
@@ -28,6 +30,9 @@ public:
 	int minorVer;
 	RadioConfig radio;
 	FanetConfig fanet;
+	SchedulerConfig scheduler;
+	ListenConfig metrics;
+	ListenConfig traffic;
 	StationConfigList stations;
 };
 
@@ -47,12 +52,18 @@ public:
 
 	RadioConfig radio() const { return m_d ? m_d->radio : RadioConfig(); }
 	FanetConfig fanet() const { return m_d ? m_d->fanet : FanetConfig(); }
+	SchedulerConfig scheduler() const { return m_d ? m_d->scheduler : SchedulerConfig(); }
+	ListenConfig metrics() const { return m_d ? m_d->metrics : ListenConfig(); }
+	ListenConfig traffic() const { return m_d ? m_d->traffic : ListenConfig(); }
 	StationConfigList stations() const { return m_d ? m_d->stations : StationConfigList(); }
 
 private:
 	bool parseElementFags(QXmlStreamReader &xml, Logger &log);
 	bool parseElementRadio(QXmlStreamReader &xml, Logger &log);
 	bool parseElementFanet(QXmlStreamReader &xml, Logger &log);
+	bool parseElementScheduler(QXmlStreamReader &xml, Logger &log);
+	bool parseElementMetrics(QXmlStreamReader &xml, Logger &log);
+	bool parseElementTraffic(QXmlStreamReader &xml, Logger &log);
 	bool parseElementStations(QXmlStreamReader &xml, Logger &log);
 
 	QExplicitlySharedDataPointer<FagsConfigData> m_d;
@@ -11,12 +11,13 @@
 #include <QXmlStreamReader>
 #include <QStringList>
 
-FanetConfigData::FanetConfigData(int ivalWeather, int ivalNames, int inactivity, int maxAge) :
+FanetConfigData::FanetConfigData(int ivalWeather, int ivalNames, int inactivity, int maxAge, int avgWindow) :
     QSharedData(),
     txintervalWeather(ivalWeather),
     txintervalNames(ivalNames),
     inactivityTimeout(inactivity),
-    weatherDataMaxAge(maxAge)
+    weatherDataMaxAge(maxAge),
+    averagingWindow(avgWindow)
 {
 }
 
@@ -25,7 +26,8 @@ FanetConfigData::FanetConfigData(const FanetConfigData &other) :
     txintervalWeather(other.txintervalWeather),
     txintervalNames(other.txintervalNames),
     inactivityTimeout(other.inactivityTimeout),
-    weatherDataMaxAge(other.weatherDataMaxAge)
+    weatherDataMaxAge(other.weatherDataMaxAge),
+    averagingWindow(other.averagingWindow)
 {
 }
 
@@ -34,12 +36,18 @@ FanetConfigData::FanetConfigData() :
     txintervalWeather(FANET_TXINTERVAL_WEATHER_DEFAULT),
     txintervalNames(FANET_TXINTERVAL_NAMES_DEFAULT),
     inactivityTimeout(FANET_INACTIVITY_TIMEOUT_DEFAULT),
-    weatherDataMaxAge(FANET_WEATHER_DATA_MAXAGE)
+    weatherDataMaxAge(FANET_WEATHER_DATA_MAXAGE),
+    averagingWindow(FANET_AVERAGING_WINDOW_DEFAULT)
 {
 }
 
 FanetConfig::FanetConfig(int ivalWeather, int ivalNames, int inactivity, int maxAge) :
-    m_d(new FanetConfigData(ivalWeather, ivalNames, inactivity, maxAge))
+    m_d(new FanetConfigData(ivalWeather, ivalNames, inactivity, maxAge, FANET_AVERAGING_WINDOW_DEFAULT))
+{
+}
+
+FanetConfig::FanetConfig(int ivalWeather, int ivalNames, int inactivity, int maxAge, int avgWindow) :
+    m_d(new FanetConfigData(ivalWeather, ivalNames, inactivity, maxAge, avgWindow))
 {
 }
 
@@ -51,6 +59,7 @@ FanetConfig::FanetConfig(QXmlStreamReader &xml) :
 	QXmlStreamAttributes attr = xml.attributes();
 	QStringList reqAttrKeys = QStringList() << CONFIG_ATTR_TXINTERVAL_WEATHER << CONFIG_ATTR_TXINTERVAL_NAMES << CONFIG_ATTR_INACTIVITY_TIMEOUT << CONFIG_ATTR_WEATHER_MAXAGE;
 	int values[4]; // size see above
+	int avgWindow = FANET_AVERAGING_WINDOW_DEFAULT;
 
 	for (int i = 0; i < reqAttrKeys.size(); i++)
 	{
@@ -58,13 +67,23 @@ FanetConfig::FanetConfig(QXmlStreamReader &xml) :
 		const QString key = reqAttrKeys.at(i);
 		if (!attr.hasAttribute(key))
 		{
-			log.error(QString("attribute '%1' is missing!").arg(key));
+			LOGGER_ERROR(log, QString("attribute '%1' is missing!").arg(key));
 			return;
 		}
 		values[i] = attr.value(key).toInt(&convOk);
 		if (!convOk || values[i] < 0)
 		{
-			log.error(QString("failed to parse attribute '%1': invalid value '%2'").arg(key, attr.value(key).toString()));
+			LOGGER_ERROR(log, QString("failed to parse attribute '%1': invalid value '%2'").arg(key, attr.value(key).toString()));
+			return;
+		}
+	}
+	if (attr.hasAttribute(CONFIG_ATTR_AVERAGING_WINDOW)) // optional
+	{
+		bool convOk;
+		avgWindow = attr.value(CONFIG_ATTR_AVERAGING_WINDOW).toInt(&convOk);
+		if (!convOk || avgWindow < 0)
+		{
+			LOGGER_ERROR(log, QString("failed to parse attribute '%1': invalid value '%2'").arg(CONFIG_ATTR_AVERAGING_WINDOW, attr.value(CONFIG_ATTR_AVERAGING_WINDOW).toString()));
 			return;
 		}
 	}
@@ -77,16 +96,16 @@ FanetConfig::FanetConfig(QXmlStreamReader &xml) :
 			case QXmlStreamReader::EndElement:
 				if (xml.name() != CONFIG_ELEMENT_FANET)
 				{
-					log.error(QString("unexpected end element: '%1' (expected '%2')").arg(xml.name(), CONFIG_ELEMENT_FANET));
+					LOGGER_ERROR(log, QString("unexpected end element: '%1' (expected '%2')").arg(xml.name(), CONFIG_ELEMENT_FANET));
 					return;
 				}
 				success = true;
 				break;
 			case QXmlStreamReader::Characters: // no inner text expected!
-				log.error(QString("unexpected text: '%1'").arg(xml.text()));
+				LOGGER_ERROR(log, QString("unexpected text: '%1'").arg(xml.text()));
 				return;
 			case QXmlStreamReader::StartElement: // no child elements expected!
-				log.error(QString("unexpected child element: '%1'").arg(xml.name()));
+				LOGGER_ERROR(log, QString("unexpected child element: '%1'").arg(xml.name()));
 				return;
 			default: // just ignore comments etc...
 				break;
@@ -94,7 +113,22 @@ FanetConfig::FanetConfig(QXmlStreamReader &xml) :
 	}
 
 	// success :)
-	m_d = new FanetConfigData(values[0], values[1], values[2], values[3]);
-	log.info(QString("txintervalWeather=%1, txintervalNames=%2, inactivityTimeout=%3, weatherDataMaxAge=%4")
-	         .arg(m_d->txintervalWeather).arg(m_d->txintervalNames).arg(m_d->inactivityTimeout).arg(m_d->weatherDataMaxAge));
+	m_d = new FanetConfigData(values[0], values[1], values[2], values[3], avgWindow);
+	log.info(QString("txintervalWeather=%1, txintervalNames=%2, inactivityTimeout=%3, weatherDataMaxAge=%4, averagingWindow=%5")
+	         .arg(m_d->txintervalWeather).arg(m_d->txintervalNames).arg(m_d->inactivityTimeout).arg(m_d->weatherDataMaxAge).arg(m_d->averagingWindow));
+}
+
+bool FanetConfig::operator==(const FanetConfig &other) const
+{
+	if (m_d == other.m_d)
+	{
+		return true;
+	}
+	if (!m_d || !other.m_d)
+	{
+		return false;
+	}
+	return m_d->txintervalWeather == other.m_d->txintervalWeather && m_d->txintervalNames == other.m_d->txintervalNames &&
+	       m_d->inactivityTimeout == other.m_d->inactivityTimeout && m_d->weatherDataMaxAge == other.m_d->weatherDataMaxAge &&
+	       m_d->averagingWindow == other.m_d->averagingWindow;
 }
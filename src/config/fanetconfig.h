@@ -15,7 +15,7 @@ class QXmlStreamReader;
 class FanetConfigData : public QSharedData
 {
 public:
-	FanetConfigData(int ivalWeather, int ivalNames, int inactivity, int maxAge);
+	FanetConfigData(int ivalWeather, int ivalNames, int inactivity, int maxAge, int avgWindow);
 	FanetConfigData(const FanetConfigData &other);
 	FanetConfigData();
 	~FanetConfigData() = default;
@@ -24,23 +24,29 @@ public:
 	int txintervalNames;
 	int inactivityTimeout;
 	int weatherDataMaxAge;
+	int averagingWindow;
 };
 
 class FanetConfig
 {
 public:
-	explicit FanetConfig(int ivalWeather, int ivalNames, int inactivity, int maxAge);
+	explicit FanetConfig(int ivalWeather, int ivalNames, int inactivity, int maxAge); // default averaging window
+	explicit FanetConfig(int ivalWeather, int ivalNames, int inactivity, int maxAge, int avgWindow);
 	explicit FanetConfig(QXmlStreamReader &xml);
 	FanetConfig(const FanetConfig &other) : m_d(other.m_d) {}
 	FanetConfig() = default;
 	virtual ~FanetConfig() = default;
 
+	bool operator==(const FanetConfig &other) const;
+	bool operator!=(const FanetConfig &other) const { return !(*this == other); }
+
 	bool isValid() const { return m_d != nullptr; }
 
 	int txIntervalWeather() const { return m_d ? m_d->txintervalWeather : 0; }
 	int txIntervalNames() const { return m_d ? m_d->txintervalNames : 0; }
 	int inactivityTimeout() const { return m_d ? m_d->inactivityTimeout : 0; }
 	int weatherDataMaxAge() const { return m_d ? m_d->weatherDataMaxAge : 0; }
+	int averagingWindow() const { return m_d ? m_d->averagingWindow : 0; } // in seconds, 0 = send latest sample
 
 private:
 	QExplicitlySharedDataPointer<FanetConfigData> m_d;
@@ -0,0 +1,100 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "listenconfig.h"
+#include "logger.h"
+#include "config.h"
+
+#include <QXmlStreamReader>
+
+
+ListenConfigData::ListenConfigData(const QString &host, quint16 port, const QString &socket) :
+    QSharedData(),
+    host(host),
+    port(port),
+    socket(socket)
+{
+}
+
+ListenConfigData::ListenConfigData(const ListenConfigData &other) :
+    QSharedData(other),
+    host(other.host),
+    port(other.port),
+    socket(other.socket)
+{
+}
+
+ListenConfig::ListenConfig(const QString &listen) :
+    m_d(nullptr)
+{
+	parseListen(listen);
+}
+
+ListenConfig::ListenConfig(QXmlStreamReader &xml) :
+    m_d(nullptr)
+{
+	Logger log("ListenConfig");
+	const QString element = xml.name().toString();
+	const QString listen = xml.attributes().value(CONFIG_ATTR_LISTEN).toString();
+	if (!parseListen(listen))
+	{
+		LOGGER_ERROR(log, QString("failed to parse attribute '%1': invalid value '%2'").arg(CONFIG_ATTR_LISTEN, listen));
+		return;
+	}
+
+	// parse element end
+	while (!xml.atEnd() && !xml.hasError())
+	{
+		switch (xml.readNext())
+		{
+			case QXmlStreamReader::EndElement:
+				if (xml.name() != element)
+				{
+					LOGGER_ERROR(log, QString("unexpected end element: '%1' (expected '%2')").arg(xml.name(), element));
+					m_d = nullptr;
+					return;
+				}
+				log.info(QString("%1: listen=%2").arg(element, toString()));
+				return; // success :)
+			case QXmlStreamReader::StartElement: // no child elements expected!
+				LOGGER_ERROR(log, QString("unexpected child element: '%1'").arg(xml.name()));
+				m_d = nullptr;
+				return;
+			default: // just ignore comments etc...
+				break;
+		}
+	}
+	LOGGER_ERROR(log, xml.hasError() ? QString("parser error: %1").arg(xml.errorString()) : "unexpected end of file!");
+	m_d = nullptr;
+}
+
+bool ListenConfig::parseListen(const QString &listen)
+{
+	if (listen.startsWith('/'))
+	{
+		m_d = new ListenConfigData(QString(), 0, listen);
+		return true;
+	}
+
+	const qsizetype sep = listen.lastIndexOf(':');
+	bool convOk;
+	const uint port = listen.mid(sep + 1).toUInt(&convOk);
+	if (!convOk || port == 0 || port > 0xffff)
+	{
+		return false;
+	}
+	m_d = new ListenConfigData(sep > 0 ? listen.left(sep) : QString(LISTEN_HOST_DEFAULT), static_cast<quint16>(port), QString());
+	return true;
+}
+
+QString ListenConfig::toString() const
+{
+	if (!m_d)
+	{
+		return QString();
+	}
+	return m_d->socket.isEmpty() ? QString("%1:%2").arg(m_d->host).arg(m_d->port) : m_d->socket;
+}
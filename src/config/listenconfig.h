@@ -0,0 +1,52 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef LISTENCONFIG_H
+#define LISTENCONFIG_H
+
+#include <QSharedData>
+#include <QString>
+
+class QXmlStreamReader;
+
+class ListenConfigData : public QSharedData
+{
+public:
+	ListenConfigData(const QString &host, quint16 port, const QString &socket);
+	ListenConfigData(const ListenConfigData &other);
+	~ListenConfigData() = default;
+
+	QString host;
+	quint16 port;
+	QString socket; // unix socket path, used instead of host/port if set
+};
+
+class ListenConfig
+{
+public:
+	explicit ListenConfig(const QString &listen); // "[host:]port" or a unix socket path (starting with '/')
+	explicit ListenConfig(QXmlStreamReader &xml); // any element with a 'listen' attribute
+	ListenConfig(const ListenConfig &other) : m_d(other.m_d) {}
+	ListenConfig() = default;
+	virtual ~ListenConfig() = default;
+
+	bool operator==(const ListenConfig &other) const { return toString() == other.toString(); }
+	bool operator!=(const ListenConfig &other) const { return !(*this == other); }
+
+	bool isValid() const { return m_d != nullptr; } // invalid (no config): service is disabled
+
+	QString host() const { return m_d ? m_d->host : QString(); }
+	quint16 port() const { return m_d ? m_d->port : 0; }
+	QString socket() const { return m_d ? m_d->socket : QString(); }
+	QString toString() const;
+
+private:
+	bool parseListen(const QString &listen);
+
+	QExplicitlySharedDataPointer<ListenConfigData> m_d;
+};
+
+#endif // LISTENCONFIG_H
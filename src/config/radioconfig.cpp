@@ -70,7 +70,7 @@ RadioConfig::RadioConfig(QXmlStreamReader &xml) :
 	{
 		if (!attr.hasAttribute(key))
 		{
-			log.error(QString("attribute '%1' is missing!").arg(key));
+			LOGGER_ERROR(log, QString("attribute '%1' is missing!").arg(key));
 			return;
 		}
 	}
@@ -78,24 +78,24 @@ RadioConfig::RadioConfig(QXmlStreamReader &xml) :
 	uart = attr.value(CONFIG_ATTR_UART).toString();
 	if (uart.isEmpty())
 	{
-		log.error("uart device empty!");
+		LOGGER_ERROR(log, "uart device empty!");
 		return;
 	}
 	if (!parsePin(attr.value(CONFIG_ATTR_PINBOOT).toString(), &pinBoot, &invertBoot))
 	{
-		log.error("failed to parse pin 'boot'!");
+		LOGGER_ERROR(log, "failed to parse pin 'boot'!");
 		return;
 	}
 	if (!parsePin(attr.value(CONFIG_ATTR_PINRESET).toString(), &pinReset, &invertReset))
 	{
-		log.error("failed to parse pin 'boot'!");
+		LOGGER_ERROR(log, "failed to parse pin 'boot'!");
 		return;
 	}
 	txPower = attr.value(CONFIG_ATTR_TXPOWER).toInt(&convOk);
 	if (!convOk || txPower < FANET_TXPOWER_MIN || txPower > FANET_TXPOWER_MAX)
 	{
-		log.error(QString("failed to parse txpower: '%1' (expected: %1 - %2)")
-		          .arg(attr.value(CONFIG_ATTR_TXPOWER).toString()).arg(FANET_TXPOWER_MIN).arg(FANET_TXPOWER_MAX));
+		LOGGER_ERROR(log, QString("failed to parse txpower: '%1' (expected: %1 - %2)")
+		                  .arg(attr.value(CONFIG_ATTR_TXPOWER).toString()).arg(FANET_TXPOWER_MIN).arg(FANET_TXPOWER_MAX));
 		return;
 	}
 
@@ -106,8 +106,8 @@ RadioConfig::RadioConfig(QXmlStreamReader &xml) :
 		case 915:
 			break; // success
 		default:
-			log.error(QString("failed to parse frequency: '%1' (expected '868' or '915')")
-			          .arg(attr.value(CONFIG_ATTR_FREQ).toString()));
+			LOGGER_ERROR(log, QString("failed to parse frequency: '%1' (expected '868' or '915')")
+			                  .arg(attr.value(CONFIG_ATTR_FREQ).toString()));
 			return;
 	}
 
@@ -119,16 +119,16 @@ RadioConfig::RadioConfig(QXmlStreamReader &xml) :
 			case QXmlStreamReader::EndElement:
 				if (xml.name() != CONFIG_ELEMENT_RADIO)
 				{
-					log.error(QString("unexpected end element: '%1' (expected '%2')").arg(xml.name(), CONFIG_ELEMENT_RADIO));
+					LOGGER_ERROR(log, QString("unexpected end element: '%1' (expected '%2')").arg(xml.name(), CONFIG_ELEMENT_RADIO));
 					return;
 				}
 				success = true;
 				break;
 			case QXmlStreamReader::Characters: // no inner text expected!
-				log.error(QString("unexpected text: '%1'").arg(xml.text()));
+				LOGGER_ERROR(log, QString("unexpected text: '%1'").arg(xml.text()));
 				return;
 			case QXmlStreamReader::StartElement: // no child elements expected!
-				log.error(QString("unexpected child element: '%1'").arg(xml.name()));
+				LOGGER_ERROR(log, QString("unexpected child element: '%1'").arg(xml.name()));
 				return;
 			default: // just ignore comments etc...
 				break;
@@ -156,6 +156,21 @@ bool RadioConfig::parsePin(const QString &str, Gpio::GpioPin *pin, bool *inverte
 	return (*pin != Gpio::None);
 }
 
+bool RadioConfig::operator==(const RadioConfig &other) const
+{
+	if (m_d == other.m_d)
+	{
+		return true;
+	}
+	if (!m_d || !other.m_d)
+	{
+		return false;
+	}
+	return m_d->uartDev == other.m_d->uartDev && m_d->txPower == other.m_d->txPower && m_d->frequency == other.m_d->frequency &&
+	       m_d->pinBoot == other.m_d->pinBoot && m_d->pinReset == other.m_d->pinReset &&
+	       m_d->invertPinBoot == other.m_d->invertPinBoot && m_d->invertPinReset == other.m_d->invertPinReset;
+}
+
 bool RadioConfig::isValid() const
 {
 	return (m_d && m_d->pinBoot != Gpio::None && m_d->pinReset != Gpio::None && !m_d->uartDev.isEmpty());
@@ -41,6 +41,9 @@ public:
 	RadioConfig() = default;
 	virtual ~RadioConfig() = default;
 
+	bool operator==(const RadioConfig &other) const;
+	bool operator!=(const RadioConfig &other) const { return !(*this == other); }
+
 	bool isValid() const;
 
 	QString uart() const { return m_d ? m_d->uartDev : QString(); }
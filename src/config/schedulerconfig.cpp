@@ -0,0 +1,149 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "schedulerconfig.h"
+#include "logger.h"
+#include "config.h"
+
+#include <QXmlStreamReader>
+
+
+SchedulerConfigData::SchedulerConfigData(int inFlight, int jitter) :
+    QSharedData(),
+    maxInFlight(inFlight),
+    startJitter(jitter),
+    limits()
+{
+}
+
+SchedulerConfigData::SchedulerConfigData(const SchedulerConfigData &other) :
+    QSharedData(other),
+    maxInFlight(other.maxInFlight),
+    startJitter(other.startJitter),
+    limits(other.limits)
+{
+}
+
+SchedulerConfigData::SchedulerConfigData() :
+    QSharedData(),
+    maxInFlight(FETCH_MAX_INFLIGHT_DEFAULT),
+    startJitter(FETCH_START_JITTER_DEFAULT),
+    limits()
+{
+}
+
+SchedulerConfig::SchedulerConfig(int maxInFlight, int startJitter) :
+    m_d(new SchedulerConfigData(maxInFlight, startJitter))
+{
+}
+
+SchedulerConfig::SchedulerConfig(QXmlStreamReader &xml) :
+    m_d(nullptr)
+{
+	Logger log("SchedulerConfig");
+	bool convOk;
+	int maxInFlight = FETCH_MAX_INFLIGHT_DEFAULT;
+	int startJitter = FETCH_START_JITTER_DEFAULT;
+	QXmlStreamAttributes attr = xml.attributes();
+
+	if (attr.hasAttribute(CONFIG_ATTR_MAX_INFLIGHT))
+	{
+		maxInFlight = attr.value(CONFIG_ATTR_MAX_INFLIGHT).toInt(&convOk);
+		if (!convOk || maxInFlight < 1)
+		{
+			LOGGER_ERROR(log, QString("failed to parse attribute '%1': invalid value '%2'").arg(CONFIG_ATTR_MAX_INFLIGHT, attr.value(CONFIG_ATTR_MAX_INFLIGHT).toString()));
+			return;
+		}
+	}
+	if (attr.hasAttribute(CONFIG_ATTR_START_JITTER))
+	{
+		startJitter = attr.value(CONFIG_ATTR_START_JITTER).toInt(&convOk);
+		if (!convOk || startJitter < 0)
+		{
+			LOGGER_ERROR(log, QString("failed to parse attribute '%1': invalid value '%2'").arg(CONFIG_ATTR_START_JITTER, attr.value(CONFIG_ATTR_START_JITTER).toString()));
+			return;
+		}
+	}
+	m_d = new SchedulerConfigData(maxInFlight, startJitter);
+
+	// parse child elements (provider limits)
+	while (!xml.atEnd() && !xml.hasError())
+	{
+		switch (xml.readNext())
+		{
+			case QXmlStreamReader::StartElement:
+				if (xml.name() == CONFIG_ELEMENT_PROVIDER && parseElementProvider(xml, log))
+				{
+					continue;
+				}
+				LOGGER_ERROR(log, QString("unexpected element: '%1'").arg(xml.name()));
+				m_d = nullptr;
+				return;
+			case QXmlStreamReader::EndElement:
+				if (xml.name() != CONFIG_ELEMENT_SCHEDULER)
+				{
+					LOGGER_ERROR(log, QString("unexpected end element: '%1' (expected '%2')").arg(xml.name(), CONFIG_ELEMENT_SCHEDULER));
+					m_d = nullptr;
+					return;
+				}
+				log.info(QString("max_inflight=%1, start_jitter=%2, provider limits: %3").arg(m_d->maxInFlight).arg(m_d->startJitter).arg(m_d->limits.size()));
+				return; // success :)
+			default:
+				break;
+		}
+	}
+	LOGGER_ERROR(log, xml.hasError() ? QString("parser error: %1").arg(xml.errorString()) : "unexpected end of file!");
+	m_d = nullptr;
+}
+
+bool SchedulerConfig::parseElementProvider(QXmlStreamReader &xml, Logger &log)
+{
+	QXmlStreamAttributes attr = xml.attributes();
+	bool rateOk, burstOk;
+	const QString type = attr.value(CONFIG_ATTR_TYPE).toString();
+	const double rate = attr.value(CONFIG_ATTR_RATE).toDouble(&rateOk);
+	const int burst = attr.value(CONFIG_ATTR_BURST).toInt(&burstOk);
+	if (type.isEmpty() || !rateOk || rate <= 0.0 || !burstOk || burst < 1)
+	{
+		LOGGER_ERROR(log, QString("invalid provider limit: type='%1', rate='%2', burst='%3'")
+		                  .arg(type, attr.value(CONFIG_ATTR_RATE).toString(), attr.value(CONFIG_ATTR_BURST).toString()));
+		return false;
+	}
+	setProviderLimit(type, rate, burst);
+	log.info(QString("provider '%1': rate=%2/s, burst=%3").arg(type).arg(rate).arg(burst));
+	xml.skipCurrentElement(); // no children expected
+	return true;
+}
+
+int SchedulerConfig::maxInFlight() const
+{
+	return m_d ? m_d->maxInFlight : FETCH_MAX_INFLIGHT_DEFAULT;
+}
+
+int SchedulerConfig::startJitter() const
+{
+	return m_d ? m_d->startJitter : FETCH_START_JITTER_DEFAULT;
+}
+
+double SchedulerConfig::rate(const QString &provider) const
+{
+	return (m_d && m_d->limits.contains(provider)) ? m_d->limits.value(provider).rate : FETCH_RATE_DEFAULT;
+}
+
+int SchedulerConfig::burst(const QString &provider) const
+{
+	return (m_d && m_d->limits.contains(provider)) ? m_d->limits.value(provider).burst : FETCH_BURST_DEFAULT;
+}
+
+void SchedulerConfig::setProviderLimit(const QString &provider, double rate, int burst)
+{
+	if (!m_d)
+	{
+		m_d = new SchedulerConfigData();
+	}
+	m_d.detach();
+	m_d->limits.insert(provider, SchedulerConfigData::ProviderLimit{rate, burst});
+}
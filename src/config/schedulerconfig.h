@@ -0,0 +1,61 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef SCHEDULERCONFIG_H
+#define SCHEDULERCONFIG_H
+
+#include <QSharedData>
+#include <QString>
+#include <QHash>
+
+class Logger;
+class QXmlStreamReader;
+
+class SchedulerConfigData : public QSharedData
+{
+public:
+	struct ProviderLimit
+	{
+		double rate; // requests per second
+		int burst;
+	};
+
+	SchedulerConfigData(int inFlight, int jitter);
+	SchedulerConfigData(const SchedulerConfigData &other);
+	SchedulerConfigData();
+	~SchedulerConfigData() = default;
+
+	int maxInFlight;
+	int startJitter;
+	QHash<QString, ProviderLimit> limits; // key: provider's xml element name
+};
+
+class SchedulerConfig
+{
+public:
+	explicit SchedulerConfig(int maxInFlight, int startJitter);
+	explicit SchedulerConfig(QXmlStreamReader &xml);
+	SchedulerConfig(const SchedulerConfig &other) : m_d(other.m_d) {}
+	SchedulerConfig() = default;
+	virtual ~SchedulerConfig() = default;
+
+	bool isValid() const { return m_d != nullptr; }
+
+	// without config (element is optional) defaults are returned
+	int maxInFlight() const;
+	int startJitter() const; // in seconds
+	double rate(const QString &provider) const;
+	int burst(const QString &provider) const;
+
+	void setProviderLimit(const QString &provider, double rate, int burst);
+
+private:
+	bool parseElementProvider(QXmlStreamReader &xml, Logger &log);
+
+	QExplicitlySharedDataPointer<SchedulerConfigData> m_d;
+};
+
+#endif // SCHEDULERCONFIG_H
@@ -7,19 +7,22 @@
 #include "stationconfig.h"
 #include "logger.h"
 #include "config.h"
+#include "weatherstation/stationregistry.h"
 
 #include <QXmlStreamReader>
 #include <QStringList>
 
 
-StationConfigData::StationConfigData(int stationType, int stationId, const QString &stationName, const QString &apiKey, const QGeoCoordinate &position, int updateInterval) :
+StationConfigData::StationConfigData(int stationType, int stationId, const QString &stationName, const QString &apiKey, const QGeoCoordinate &position, int updateInterval, bool adaptiveInterval) :
     QSharedData(),
     type(stationType),
     id(stationId),
     name(stationName),
     key(apiKey),
     pos(position),
-    ival(updateInterval)
+    ival(updateInterval),
+    adaptive(adaptiveInterval),
+    attributes()
 {
 }
 
@@ -30,7 +33,9 @@ StationConfigData::StationConfigData(const StationConfigData &other) :
     name(other.name),
     key(other.key),
     pos(other.pos),
-    ival(other.ival)
+    ival(other.ival),
+    adaptive(other.adaptive),
+    attributes(other.attributes)
 {
 }
 
@@ -41,12 +46,14 @@ StationConfigData::StationConfigData() :
     name(),
     key(),
     pos(),
-    ival(0)
+    ival(0),
+    adaptive(false),
+    attributes()
 {
 }
 
-StationConfig::StationConfig(StationType stationType, int stationId, const QString &stationName, const QString &apiKey, const QGeoCoordinate &position, int updateInterval) :
-    m_d(new StationConfigData(stationType, stationId, stationName, apiKey, position, updateInterval))
+StationConfig::StationConfig(StationType stationType, int stationId, const QString &stationName, const QString &apiKey, const QGeoCoordinate &position, int updateInterval, bool adaptiveInterval) :
+    m_d(new StationConfigData(stationType, stationId, stationName, apiKey, position, updateInterval, adaptiveInterval))
 {
 }
 
@@ -55,24 +62,25 @@ StationConfig::StationConfig(QXmlStreamReader &xml) :
 {
 	Logger log("StationConfig");
 	QString name, key, element = xml.name().toString();
-	int id, ival;
+	int id, ival = 0;
 	double lon, lat, alt;
-	bool convOk, success = false;
-	StationType type = UnknownStation;
+	bool convOk, adaptive = false, success = false;
+	const StationRegistry::Provider *provider = StationRegistry::instance().provider(element);
 
-	if (element == CONFIG_ELEMENT_HOLFUYAPI)    type = HolfuyApi; else
-	if (element == CONFIG_ELEMENT_HOLFUYWIDGET) type = HolfuyWidget; else
-	if (element == CONFIG_ELEMENT_WINDBIRD)     type = Windbird;
-
-	if (type == UnknownStation)
+	if (!provider)
 	{
-		log.error(QString("failed to parse station type: '%1'").arg(element));
+		LOGGER_ERROR(log, QString("failed to parse station type: '%1'").arg(element));
 		return;
 	}
+	const StationType type = static_cast<StationType>(provider->type);
 
 	QXmlStreamAttributes attr = xml.attributes();
-	QStringList reqAttrKeys = QStringList() << CONFIG_ATTR_ID << CONFIG_ATTR_NAME << CONFIG_ATTR_POSLON << CONFIG_ATTR_POSLAT << CONFIG_ATTR_POSALT << CONFIG_ATTR_IVAL;
-	if (type == HolfuyApi)
+	QStringList reqAttrKeys = QStringList() << CONFIG_ATTR_ID << CONFIG_ATTR_NAME << CONFIG_ATTR_POSLON << CONFIG_ATTR_POSLAT << CONFIG_ATTR_POSALT;
+	if (provider->capabilities & StationRegistry::RequiresPolling)
+	{
+		reqAttrKeys << CONFIG_ATTR_IVAL;
+	}
+	if (provider->capabilities & StationRegistry::RequiresApiKey)
 	{
 		reqAttrKeys << CONFIG_ATTR_APIKEY;
 	}
@@ -80,7 +88,7 @@ StationConfig::StationConfig(QXmlStreamReader &xml) :
 	{
 		if (!attr.hasAttribute(key))
 		{
-			log.error(QString("attribute '%1' is missing!").arg(key));
+			LOGGER_ERROR(log, QString("attribute '%1' is missing!").arg(key));
 			return;
 		}
 	}
@@ -89,39 +97,50 @@ StationConfig::StationConfig(QXmlStreamReader &xml) :
 	id = attr.value(CONFIG_ATTR_ID).toInt(&convOk);
 	if (!convOk)
 	{
-		log.error(QString("failed to parse station id: '%1'").arg(attr.value(CONFIG_ATTR_ID)));
+		LOGGER_ERROR(log, QString("failed to parse station id: '%1'").arg(attr.value(CONFIG_ATTR_ID)));
 		return;
 	}
 	name = attr.value(CONFIG_ATTR_NAME).toString();
 
-	// api key (HolfuyApi only)
-	if (type == HolfuyApi)
-	{
-		key = attr.value(CONFIG_ATTR_APIKEY).toString();
-	}
+	// api key (optional, depending on provider)
+	key = attr.value(CONFIG_ATTR_APIKEY).toString();
 
 	// station position
 	lon = attr.value(CONFIG_ATTR_POSLON).toDouble(&convOk);
 	if (!convOk)
 	{
-		log.error(QString("failed to parse longitude: '%1'").arg(attr.value(CONFIG_ATTR_POSLON)));
+		LOGGER_ERROR(log, QString("failed to parse longitude: '%1'").arg(attr.value(CONFIG_ATTR_POSLON)));
 	}
 	lat = attr.value(CONFIG_ATTR_POSLAT).toDouble(&convOk);
 	if (!convOk)
 	{
-		log.error(QString("failed to parse latitude: '%1'").arg(attr.value(CONFIG_ATTR_POSLAT)));
+		LOGGER_ERROR(log, QString("failed to parse latitude: '%1'").arg(attr.value(CONFIG_ATTR_POSLAT)));
 	}
 	alt = attr.value(CONFIG_ATTR_POSALT).toDouble(&convOk);
 	if (!convOk)
 	{
-		log.error(QString("failed to parse altitude: '%1'").arg(attr.value(CONFIG_ATTR_POSALT)));
+		LOGGER_ERROR(log, QString("failed to parse altitude: '%1'").arg(attr.value(CONFIG_ATTR_POSALT)));
 	}
 
-	// update interval
-	ival = attr.value(CONFIG_ATTR_IVAL).toInt(&convOk);
-	if (!convOk)
+	// update interval (optional for providers pushing their data)
+	if (attr.hasAttribute(CONFIG_ATTR_IVAL))
 	{
-		log.error(QString("failed to parse station update interval: '%1'").arg(attr.value(CONFIG_ATTR_IVAL)));
+		ival = attr.value(CONFIG_ATTR_IVAL).toInt(&convOk);
+		if (!convOk)
+		{
+			LOGGER_ERROR(log, QString("failed to parse station update interval: '%1'").arg(attr.value(CONFIG_ATTR_IVAL)));
+		}
+	}
+
+	// adaptive update interval (optional)
+	if (attr.hasAttribute(CONFIG_ATTR_ADAPTIVE_IVAL))
+	{
+		const QString value = attr.value(CONFIG_ATTR_ADAPTIVE_IVAL).toString().trimmed().toLower();
+		adaptive = (value == "1" || value == "true");
+		if (!adaptive && value != "0" && value != "false")
+		{
+			LOGGER_ERROR(log, QString("failed to parse adaptive update interval: '%1' (expected 'true' or 'false')").arg(value));
+		}
 	}
 
 	// parse element end
@@ -132,16 +151,16 @@ StationConfig::StationConfig(QXmlStreamReader &xml) :
 			case QXmlStreamReader::EndElement:
 				if (xml.name() != element)
 				{
-					log.error(QString("unexpected end element: '%1' (expected '%2')").arg(xml.name(), element));
+					LOGGER_ERROR(log, QString("unexpected end element: '%1' (expected '%2')").arg(xml.name(), element));
 					return;
 				}
 				success = true;
 				break;
 			case QXmlStreamReader::Characters: // no inner text expected!
-				log.error(QString("unexpected text: '%1'").arg(xml.text()));
+				LOGGER_ERROR(log, QString("unexpected text: '%1'").arg(xml.text()));
 				return;
 			case QXmlStreamReader::StartElement: // no child elements expected!
-				log.error(QString("unexpected child element: '%1'").arg(xml.name()));
+				LOGGER_ERROR(log, QString("unexpected child element: '%1'").arg(xml.name()));
 				return;
 			default: // just ignore comments etc...
 				break;
@@ -149,13 +168,32 @@ StationConfig::StationConfig(QXmlStreamReader &xml) :
 	}
 
 	// success :)
-	m_d = new StationConfigData(type, id, name, key, QGeoCoordinate(lat, lon, alt), ival);
-	log.info(QString("type=%1, id=%2, name=%3, apikey=%4 position=%5, update_interval=%6")
+	m_d = new StationConfigData(type, id, name, key, QGeoCoordinate(lat, lon, alt), ival, adaptive);
+	for (const QXmlStreamAttribute &a : attr)
+	{
+		m_d->attributes.insert(a.name().toString(), a.value().toString());
+	}
+	log.info(QString("type=%1, id=%2, name=%3, apikey=%4 position=%5, update_interval=%6%7")
 	         .arg(typeToString(type), QString::number(id), name, key.isEmpty() ? "<empty>" : "<hidden>",
-	              m_d->pos.toString(), QString::number(ival)));
+	              m_d->pos.toString(), QString::number(ival), adaptive ? " (adaptive)" : ""));
 
 }
 
+bool StationConfig::operator==(const StationConfig &other) const
+{
+	if (m_d == other.m_d)
+	{
+		return true;
+	}
+	if (!m_d || !other.m_d)
+	{
+		return false;
+	}
+	return m_d->type == other.m_d->type && m_d->id == other.m_d->id && m_d->name == other.m_d->name && m_d->key == other.m_d->key &&
+	       m_d->pos == other.m_d->pos && m_d->ival == other.m_d->ival && m_d->adaptive == other.m_d->adaptive &&
+	       m_d->attributes == other.m_d->attributes;
+}
+
 bool StationConfig::isValid() const
 {
 	return (m_d && m_d->type != StationConfig::UnknownStation && m_d->id > ID_INVALID && m_d->pos.isValid());
@@ -191,13 +229,27 @@ int StationConfig::updateInterval() const
 	return m_d ? m_d->ival : 0;
 }
 
-QString StationConfig::typeToString(StationConfig::StationType type)
+bool StationConfig::adaptiveInterval() const
+{
+	return m_d ? m_d->adaptive : false;
+}
+
+QString StationConfig::attribute(const QString &key, const QString &defaultValue) const
+{
+	return m_d ? m_d->attributes.value(key, defaultValue) : defaultValue;
+}
+
+void StationConfig::setAttribute(const QString &key, const QString &value)
 {
-	switch (type)
+	if (m_d)
 	{
-		case HolfuyApi:    return "HolfuyApi";
-		case HolfuyWidget: return "HolfuyWidget";
-		case Windbird:     return "Windbird";
-		default:           return "UnknownStation";
+		m_d.detach();
+		m_d->attributes.insert(key, value);
 	}
 }
+
+QString StationConfig::typeToString(StationConfig::StationType type)
+{
+	const StationRegistry::Provider *provider = StationRegistry::instance().provider(type);
+	return provider ? provider->name : QString("UnknownStation");
+}
@@ -8,6 +8,7 @@
 #define STATIONCONFIG_H
 
 #include <QList>
+#include <QHash>
 #include <QString>
 #include <QSharedData>
 #include <QGeoCoordinate>
@@ -18,7 +19,7 @@ class QXmlStreamReader;
 class StationConfigData : public QSharedData
 {
 public:
-	StationConfigData(int stationType, int stationId, const QString &stationName, const QString &apiKey, const QGeoCoordinate &position, int updateInterval);
+	StationConfigData(int stationType, int stationId, const QString &stationName, const QString &apiKey, const QGeoCoordinate &position, int updateInterval, bool adaptiveInterval);
 	StationConfigData(const StationConfigData &other);
 	StationConfigData();
 	~StationConfigData() = default;
@@ -29,6 +30,8 @@ public:
 	QString key;
 	QGeoCoordinate pos;
 	int ival;
+	bool adaptive;
+	QHash<QString, QString> attributes; // all xml attributes (provider specific settings)
 };
 
 class StationConfig
@@ -41,15 +44,22 @@ public:
 		UnknownStation = 0,
 		HolfuyApi,
 		HolfuyWidget,
-		Windbird
+		Windbird,
+		SerialSensor,
+		MqttStation,
+		UserStation = 0x80, // first type id available for out-of-tree providers (plugins)
+		StationTypeMax = 0xff
 	};
 
-	explicit StationConfig(StationType stationType, int stationId, const QString &stationName, const QString &apiKey, const QGeoCoordinate &position, int updateInterval);
+	explicit StationConfig(StationType stationType, int stationId, const QString &stationName, const QString &apiKey, const QGeoCoordinate &position, int updateInterval, bool adaptiveInterval = false);
 	explicit StationConfig(QXmlStreamReader &xml);
 	StationConfig(const StationConfig &other) : m_d(other.m_d) {}
 	StationConfig() = default;
 	virtual ~StationConfig() = default;
 
+	bool operator==(const StationConfig &other) const;
+	bool operator!=(const StationConfig &other) const { return !(*this == other); }
+
 	bool isValid() const;
 	int stationId() const;
 	QString stationName() const;
@@ -57,6 +67,9 @@ public:
 	QGeoCoordinate position() const;
 	StationType stationType() const;
 	int updateInterval() const; // in seconds
+	bool adaptiveInterval() const; // learn update interval from station's publishing cadence
+	QString attribute(const QString &key, const QString &defaultValue = QString()) const;
+	void setAttribute(const QString &key, const QString &value);
 
 	static QString typeToString(StationType type);
 
@@ -0,0 +1,49 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "controlmessage.h"
+#include "config.h"
+
+#include <QtEndian>
+
+
+ControlMessage::ControlMessage(quint32 id, Code code, const QByteArray &payload) :
+    m_id(id),
+    m_code(code),
+    m_payload(payload)
+{
+}
+
+QByteArray ControlMessage::serialize() const
+{
+	QByteArray frame(HEADER_SIZE, Qt::Uninitialized);
+	qToBigEndian<quint32>(static_cast<quint32>(HEADER_SIZE - sizeof(quint32) + m_payload.size()), frame.data());
+	qToBigEndian<quint32>(m_id, frame.data() + 4);
+	frame[8] = static_cast<char>(m_code);
+	return frame.append(m_payload);
+}
+
+ControlMessage::ParseResult ControlMessage::take(QByteArray &buffer, ControlMessage *msg)
+{
+	if (buffer.size() < static_cast<qsizetype>(sizeof(quint32)))
+	{
+		return Incomplete;
+	}
+	const quint32 size = qFromBigEndian<quint32>(buffer.constData());
+	if (size < HEADER_SIZE - sizeof(quint32) || size > static_cast<quint32>(CONTROL_FRAME_SIZE_MAX))
+	{
+		return Invalid;
+	}
+	if (buffer.size() < static_cast<qsizetype>(sizeof(quint32) + size))
+	{
+		return Incomplete;
+	}
+	msg->m_id = qFromBigEndian<quint32>(buffer.constData() + 4);
+	msg->m_code = static_cast<Code>(static_cast<quint8>(buffer.at(8)));
+	msg->m_payload = buffer.mid(HEADER_SIZE, static_cast<qsizetype>(size - (HEADER_SIZE - sizeof(quint32))));
+	buffer.remove(0, static_cast<qsizetype>(sizeof(quint32) + size));
+	return Complete;
+}
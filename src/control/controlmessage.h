@@ -0,0 +1,71 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef CONTROLMESSAGE_H
+#define CONTROLMESSAGE_H
+
+#include <QByteArray>
+#include <QString>
+
+/**
+ * @class ControlMessage is a request or response of the control protocol (see ControlServer).
+ *        Frame (integers big endian): size (quint32, bytes following), id (quint32), code (quint8), payload.
+ *        A response carries the id of its request and a status code instead of the command. Payloads
+ *        are utf-8 text, the status response is a json object.
+ */
+class ControlMessage
+{
+public:
+	enum Code // requests: command, responses: status
+	{
+		CmdQuit              = 0x01, // no payload
+		CmdStatus            = 0x02, // no payload
+		CmdSendMessage       = 0x03, // "<manufacturer>:<device> <message>", e.g. "11:1234 hello"
+		CmdSetLogLevel       = 0x04, // "<0..5>" or "<class>=<0..5|default>[,...]"
+		CmdReloadConfig      = 0x05, // config file, empty: reload current
+		CmdInject            = 0x06, // fanet rx message (debugging)
+		StatusOk             = 0x80,
+		StatusError          = 0x81, // payload: error message
+		StatusUnknownCommand = 0x82,
+		StatusBadRequest     = 0x83
+	};
+
+	enum ParseResult
+	{
+		Incomplete = 0,
+		Complete,
+		Invalid
+	};
+
+	static const int HEADER_SIZE = 9;
+
+	explicit ControlMessage(quint32 id = 0, Code code = StatusError, const QByteArray &payload = QByteArray());
+	ControlMessage(quint32 id, Code code, const QString &payload) : ControlMessage(id, code, payload.toUtf8()) {}
+	~ControlMessage() = default;
+
+	quint32 id() const { return m_id; }
+	Code code() const { return m_code; }
+	QByteArray payload() const { return m_payload; }
+	QString text() const { return QString::fromUtf8(m_payload); }
+
+	bool isResponse() const { return m_code & 0x80; }
+
+	QByteArray serialize() const;
+
+	/*!
+	 * \brief take
+	 * Removes the first complete frame from buffer and stores it in msg.
+	 * \return Incomplete if more data is needed, Invalid if the frame exceeds CONTROL_FRAME_SIZE_MAX
+	 */
+	static ParseResult take(QByteArray &buffer, ControlMessage *msg);
+
+private:
+	quint32 m_id;
+	Code m_code;
+	QByteArray m_payload;
+};
+
+#endif // CONTROLMESSAGE_H
@@ -0,0 +1,120 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "controlserver.h"
+#include "config.h"
+
+#include <QLocalServer>
+#include <QLocalSocket>
+
+
+ControlServer::ControlServer(const QString &socket, QObject *parent) :
+    QObject(parent),
+    m_log("ControlServer"),
+    m_socket(socket),
+    m_server(nullptr),
+    m_buffers()
+{
+}
+
+ControlServer::~ControlServer()
+{
+	for (QHash<QLocalSocket*, QByteArray>::const_iterator it = m_buffers.constBegin(); it != m_buffers.constEnd(); ++it)
+	{
+		it.key()->disconnect(this);
+	}
+	if (m_server)
+	{
+		m_server->close(); // removes the socket file
+	}
+}
+
+bool ControlServer::listen()
+{
+	m_server = new QLocalServer(this);
+	m_server->setSocketOptions(QLocalServer::UserAccessOption);
+	QLocalServer::removeServer(m_socket); // stale socket of a crashed instance
+	connect(m_server, &QLocalServer::newConnection, this, &ControlServer::onNewConnection);
+	if (!m_server->listen(m_socket))
+	{
+		LOGGER_ERROR(m_log, QString("failed to listen on %1: %2").arg(m_socket, m_server->errorString()));
+		return false;
+	}
+	LOGGER_DEBUG(m_log, QString("listening on %1").arg(m_socket));
+	return true;
+}
+
+bool ControlServer::isListening() const
+{
+	return m_server && m_server->isListening();
+}
+
+void ControlServer::reply(QLocalSocket *client, const ControlMessage &response)
+{
+	if (client && m_buffers.contains(client))
+	{
+		QByteArray frame = response.serialize();
+		if (frame.size() - static_cast<qsizetype>(sizeof(quint32)) > CONTROL_FRAME_SIZE_MAX) // the client would reject it
+		{
+			LOGGER_WARNING(m_log, QString("response #%1 too large (%2 bytes), replying with an error").arg(response.id()).arg(frame.size()));
+			frame = ControlMessage(response.id(), ControlMessage::StatusError,
+			                       QString("response too large (%1 bytes)").arg(frame.size())).serialize();
+		}
+		client->write(frame);
+	}
+}
+
+void ControlServer::onNewConnection()
+{
+	while (QLocalSocket *client = m_server->nextPendingConnection())
+	{
+		m_buffers.insert(client, QByteArray());
+		connect(client, &QLocalSocket::readyRead, this, &ControlServer::onReadyRead);
+		connect(client, &QLocalSocket::disconnected, this, &ControlServer::onDisconnected);
+	}
+}
+
+void ControlServer::onReadyRead()
+{
+	QLocalSocket *client = qobject_cast<QLocalSocket*>(sender());
+	if (!client || !m_buffers.contains(client))
+	{
+		return;
+	}
+	QByteArray &buffer = m_buffers[client];
+	buffer.append(client->readAll());
+
+	ControlMessage request;
+	ControlMessage::ParseResult result;
+	while ((result = ControlMessage::take(buffer, &request)) == ControlMessage::Complete)
+	{
+		if (request.isResponse())
+		{
+			reply(client, ControlMessage(request.id(), ControlMessage::StatusBadRequest));
+			continue;
+		}
+		emit requestReceived(client, request);
+		if (!m_buffers.contains(client))
+		{
+			return; // disconnected by the handler
+		}
+	}
+	if (result == ControlMessage::Invalid)
+	{
+		LOGGER_WARNING(m_log, "invalid frame received, closing connection");
+		client->disconnectFromServer();
+	}
+}
+
+void ControlServer::onDisconnected()
+{
+	QLocalSocket *client = qobject_cast<QLocalSocket*>(sender());
+	if (client)
+	{
+		m_buffers.remove(client);
+		client->deleteLater();
+	}
+}
@@ -0,0 +1,52 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef CONTROLSERVER_H
+#define CONTROLSERVER_H
+
+#include <QObject>
+#include <QHash>
+#include "logger.h"
+#include "controlmessage.h"
+
+class QLocalServer;
+class QLocalSocket;
+
+/**
+ * @class ControlServer accepts persistent connections on a unix socket. Clients may send any number of
+ *        requests (ControlMessage) without waiting for the responses, each one is passed to
+ *        requestReceived() and answered by reply() - in any order, matched by the request id.
+ *        Everything is non-blocking, a client sending a frame larger than CONTROL_FRAME_SIZE_MAX is
+ *        disconnected.
+ */
+class ControlServer : public QObject
+{
+	Q_OBJECT
+public:
+	explicit ControlServer(const QString &socket, QObject *parent = nullptr);
+	virtual ~ControlServer() Q_DECL_OVERRIDE;
+
+	bool listen();
+	bool isListening() const;
+
+	void reply(QLocalSocket *client, const ControlMessage &response); // responses exceeding CONTROL_FRAME_SIZE_MAX become errors
+
+signals:
+	void requestReceived(QLocalSocket *client, const ControlMessage &request); // answer with reply()
+
+private slots:
+	void onNewConnection();
+	void onReadyRead();
+	void onDisconnected();
+
+private:
+	Logger m_log;
+	QString m_socket;
+	QLocalServer *m_server;
+	QHash<QLocalSocket*, QByteArray> m_buffers; // incomplete frames per client
+};
+
+#endif // CONTROLSERVER_H
@@ -10,6 +10,7 @@
 
 static const quint8  MANUFACUTER_ID_INVALID = 0xff;
 static const quint16 DEVICE_ID_INVALID      = 0xffff;
+static Logger s_log("FanetAddress");
 
 FanetAddress::FanetAddress(quint8 manufacturerId, quint16 deviceId) :
     m_manufacturerId(manufacturerId),
@@ -40,7 +41,7 @@ FanetAddress::FanetAddress(const QByteArray &data) :
 	}
 	if (error)
 	{
-		Logger("FanetAddress").warning(QString("Failed to parse address from data: '%1'!").arg(data));
+		LOGGER_WARNING(s_log, QString("Failed to parse address from data: '%1'!").arg(data));
 	}
 }
 
@@ -9,6 +9,7 @@
 #include "QtNumeric"
 
 static const int TemperatureInvalid = -274;
+static Logger s_log("FanetPayload");
 
 FanetPayload::FanetPayload() :
     m_type(PTInvalid),
@@ -34,8 +35,8 @@ FanetPayload FanetPayload::fromReceivedData(PayloadType type, const QByteArray &
 			if (data.size() != PAYLOAD_SIZE_GROUNDTRACKING)
 			{
 				Logger log("FanetPayload");
-				log.warning(QString("failed to parse payload for ground tracking: invalid size (expected: %1, got: %2)")
-				            .arg(PAYLOAD_SIZE_GROUNDTRACKING).arg(data.size()));
+				LOGGER_WARNING(log, QString("failed to parse payload for ground tracking: invalid size (expected: %1, got: %2)")
+				                    .arg(PAYLOAD_SIZE_GROUNDTRACKING).arg(data.size()));
 				return FanetPayload(PTInvalid, data);
 			}
 			return FanetPayload(PTGroundTracking, data);
@@ -43,8 +44,8 @@ FanetPayload FanetPayload::fromReceivedData(PayloadType type, const QByteArray &
 			if (data.size() < PAYLOAD_SIZE_TRACKING_MIN)
 			{
 				Logger log("FanetPayload");
-				log.warning(QString("failed to parse payload for tracking: size too small (expected: %1, got: %2)")
-				            .arg(PAYLOAD_SIZE_TRACKING_MIN).arg(data.size()));
+				LOGGER_WARNING(log, QString("failed to parse payload for tracking: size too small (expected: %1, got: %2)")
+				                    .arg(PAYLOAD_SIZE_TRACKING_MIN).arg(data.size()));
 				return FanetPayload(PTInvalid, data);
 			}
 			return FanetPayload(PTTracking, data);
@@ -52,8 +53,8 @@ FanetPayload FanetPayload::fromReceivedData(PayloadType type, const QByteArray &
 			if (data.size() < PAYLOAD_SIZE_THERMAL)
 			{
 				Logger log("FanetPayload");
-				log.warning(QString("failed to parse payload for thermal: size too small (expected: %1, got: %2)")
-				            .arg(PAYLOAD_SIZE_THERMAL).arg(data.size()));
+				LOGGER_WARNING(log, QString("failed to parse payload for thermal: size too small (expected: %1, got: %2)")
+				                    .arg(PAYLOAD_SIZE_THERMAL).arg(data.size()));
 			}
 			return FanetPayload(PTThermal, data);
 		case PTName: // fall
@@ -69,7 +70,7 @@ FanetPayload FanetPayload::fromReceivedData(PayloadType type, const QByteArray &
 				if ((data.at(0) & 0x80) != 0) // ping-pong/pull request?
 				{
 					Logger log("FanetPayload");
-					log.warning(QString("received pull request for hw info: Not implemented!"));
+					LOGGER_WARNING(log, QString("received pull request for hw info: Not implemented!"));
 					return FanetPayload(PTInvalid, data);
 				}
 
@@ -82,8 +83,8 @@ FanetPayload FanetPayload::fromReceivedData(PayloadType type, const QByteArray &
 			if (data.size() < expectedSize)
 			{
 				Logger log("FanetPayload");
-				log.warning(QString("failed to parse payload for hw info: size too small (expected: %1, got: %2)")
-				            .arg(expectedSize).arg(data.size()));
+				LOGGER_WARNING(log, QString("failed to parse payload for hw info: size too small (expected: %1, got: %2)")
+				                    .arg(expectedSize).arg(data.size()));
 				return FanetPayload(PTInvalid, data);
 			}
 			return FanetPayload(PTHWInfo, data);
@@ -105,14 +106,14 @@ FanetPayload FanetPayload::fromReceivedData(PayloadType type, const QByteArray &
 			if (data.size() < expectedSize)
 			{
 				Logger log("FanetPayload");
-				log.warning(QString("failed to parse payload for service msg: size too small (expected: %1, got: %2)")
-				            .arg(expectedSize).arg(data.size()));
+				LOGGER_WARNING(log, QString("failed to parse payload for service msg: size too small (expected: %1, got: %2)")
+				                    .arg(expectedSize).arg(data.size()));
 				return FanetPayload(PTInvalid, data);
 			}
 			return FanetPayload(PTService, data);
 		}
 		default:
-			Logger("FanetPayload").warning(QString("failed to parse payload type %1 (not implemented)!").arg(type));
+			LOGGER_WARNING(s_log, QString("failed to parse payload type %1 (not implemented)!").arg(type));
 			return FanetPayload(PTInvalid, data);
 			break;
 	}
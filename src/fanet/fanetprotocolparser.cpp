@@ -9,6 +9,7 @@
 #include "versionreply.h"
 #include "transmitreply.h"
 #include "receiveevent.h"
+#include "metrics/metrics.h"
 
 #include <QIODevice>
 #include <QDebug>
@@ -54,8 +55,9 @@ AbstractFanetMessage* FanetProtocolParser::parseMessage(QByteArray data) const
 		{
 			return new GenericReply(AbstractFanetMessage::FMTRegionReply, buf.mid(MSG_SIZE_IDENTIFIER));
 		}
-		m_log.warning(QString("Message '%1' ignored! (raw data: 0x%2)")
-		              .arg(QString(buf.mid(0, MSG_SIZE_IDENTIFIER)), buf.toHex()));
+		Metrics::instance().parseFailure();
+		LOGGER_WARNING(m_log, QString("Message '%1' ignored! (raw data: 0x%2)")
+		                      .arg(QString(buf.mid(0, MSG_SIZE_IDENTIFIER)), buf.toHex()));
 	}
 	return nullptr;
 }
@@ -72,14 +74,15 @@ AbstractFanetMessage* FanetProtocolParser::next()
 			case StartDelimiter:
 				if (!m_buffer.isEmpty() && !m_buffer.startsWith(MSG_INIT_IGNORE)) // ignore initialization progress (CCCC...)
 				{
-					m_log.warning(QString("discarding incomplete message: '0x%1' ('%2')").arg(m_buffer.toHex(), m_buffer));
+					Metrics::instance().parseFailure();
+					LOGGER_WARNING(m_log, QString("discarding incomplete message: '0x%1' ('%2')").arg(m_buffer.toHex(), m_buffer));
 				}
 				m_buffer.clear();
 				break;
 			case EndDelimiter:
 			{
 				// message complete, pass data to corresponding message constructor...
-				m_log.debug(QString("Msg received: '%1'").arg(m_buffer));
+				LOGGER_DEBUG(m_log, QString("Msg received: '%1'").arg(m_buffer));
 				AbstractFanetMessage *msg = parseMessage(m_buffer);
 				m_buffer.clear();
 				return msg;
@@ -16,7 +16,10 @@
 #include "versioncommand.h"
 #include "versionreply.h"
 #include "receiveevent.h"
+#include "uartcapture.h"
+#include "uartreplay.h"
 #include "config.h"
+#include "metrics/metrics.h"
 #include "gpio.h"
 
 #include <QSerialPort>
@@ -41,7 +44,9 @@ FanetRadio::FanetRadio(const RadioConfig &config, Gpio *gpio, QObject *parent) :
     m_uart(new QSerialPort(config.uart(), this)),
     m_gpio(gpio),
     m_timer(new QTimer(this)),
-    m_parser(new FanetProtocolParser(m_uart))
+    m_parser(new FanetProtocolParser(m_uart)),
+    m_capture(nullptr),
+    m_replay(nullptr)
 {
 	if (gpio)
 	{
@@ -77,6 +82,8 @@ FanetRadio::~FanetRadio()
 	}
 	delete m_parser;
 	m_parser = nullptr;
+	delete m_capture;
+	m_capture = nullptr;
 }
 
 QString FanetRadio::radioStateStr(RadioState state)
@@ -101,13 +108,15 @@ bool FanetRadio::sendData(const FanetAddress &addr, const FanetPayload &data)
 {
 	if (!addr.isValid())
 	{
-		m_log.warning("Failed to send data: invalid address!");
+		LOGGER_WARNING(m_log, "Failed to send data: invalid address!");
 		return false;
 	}
 	if (m_state != RadioReady)
 	{
-		m_log.warning(QString("Failed to send data (%1) to '%2': Radio is not ready (current state: %3)")
-		              .arg(FanetPayload::payloadTypeStr(data.type()), addr.toHex(':'), radioStateStr(m_state)));
+		m_log.log(Logger::Warning, QString("Failed to send data (%1) to '%2': Radio is not ready (current state: %3)")
+		          .arg(FanetPayload::payloadTypeStr(data.type()), addr.toHex(':'), radioStateStr(m_state)),
+		          Logger::Fields({{LOG_FIELD_FANET_ADDRESS, QString::fromLatin1(addr.toHex(':'))},
+		                          {LOG_FIELD_PAYLOAD_TYPE, FanetPayload::payloadTypeStr(data.type())}}));
 		return false;
 	}
 	if (m_gpio)
@@ -115,7 +124,12 @@ bool FanetRadio::sendData(const FanetAddress &addr, const FanetPayload &data)
 		m_gpio->setGpio(LED_PIN_GREEN);
 	}
 	const TransmitCommand cmd(addr, data);
-	return sendMessage(&cmd);
+	if (!sendMessage(&cmd))
+	{
+		return false;
+	}
+	Metrics::instance().frameSent(data.type());
+	return true;
 }
 
 void FanetRadio::injectMessage(const QString &data)
@@ -127,11 +141,58 @@ void FanetRadio::injectMessage(const QString &data)
 	}
 }
 
+bool FanetRadio::setConfig(const RadioConfig &config)
+{
+	const bool restart = config.uart() != m_config.uart() || config.pinBoot() != m_config.pinBoot() || config.pinReset() != m_config.pinReset() ||
+	                     config.invertPinBoot() != m_config.invertPinBoot() || config.invertPinReset() != m_config.invertPinReset();
+	const bool region = config.txPower() != m_config.txPower() || config.frequency() != m_config.frequency();
+	// uart and gpio settings of the running radio are kept, they only change on restart
+	m_config = RadioConfig(m_config.uart(), config.txPower(), config.frequency(), m_config.pinBoot(), m_config.pinReset(),
+	                       m_config.invertPinBoot(), m_config.invertPinReset());
+	if (region && m_state == RadioReady && !m_replay)
+	{
+		sendRegion(); // no reset needed, region reply is handled in ready state as well
+	}
+	return !restart;
+}
+
+bool FanetRadio::startCapture(const QString &fileName)
+{
+	delete m_capture;
+	m_capture = new UartCapture(fileName, this);
+	if (!m_capture->open())
+	{
+		delete m_capture;
+		m_capture = nullptr;
+		return false;
+	}
+	return true;
+}
+
+bool FanetRadio::setReplay(const QString &fileName, double speed)
+{
+	UartReplay *replay = new UartReplay(this);
+	if (!replay->load(fileName))
+	{
+		delete replay;
+		return false;
+	}
+	replay->setSpeed(speed);
+	delete m_replay;
+	m_replay = replay;
+	delete m_parser;
+	m_parser = new FanetProtocolParser(m_replay);
+	connect(m_replay, &QIODevice::readyRead, this, &FanetRadio::onReadyRead);
+	m_log.notice(QString("replaying %1 at %2 speed").arg(fileName, speed > 0.0 ? QString("%1x").arg(speed) : QString("max.")));
+	return true;
+}
+
 void FanetRadio::setState(RadioState state)
 {
 	if (state != m_state)
 	{
 		m_log.info(QString("radio state changed: %1 -> %2").arg(radioStateStr(m_state), radioStateStr(state)));
+		Metrics::instance().radioStateChanged(state);
 		if (m_gpio)
 		{
 			switch (state)
@@ -183,7 +244,7 @@ void FanetRadio::handleMessage(const AbstractFanetMessage *msg)
 			handleVersionReply(msg);
 			break;
 		default:
-			m_log.debug(QString("ignored unexpected fanet message (type: %1)").arg(msg->type()));
+			LOGGER_DEBUG(m_log, QString("ignored unexpected fanet message (type: %1)").arg(msg->type()));
 			break;
 	}
 }
@@ -192,19 +253,24 @@ bool FanetRadio::sendMessage(const AbstractFanetMessage *msg)
 {
 	if (msg && msg->isValid() && msg->isCommand())
 	{
+		if (m_replay)
+		{
+			LOGGER_DEBUG(m_log, QString("replay: not sending message '%1'").arg(msg->serialize()));
+			return true;
+		}
 		if (!m_uart->isOpen() && m_uart->isWritable())
 		{
-			m_log.error(QString("Cannot write to radio! Message dropped: '%1'").arg(msg->serialize()));
+			LOGGER_ERROR(m_log, QString("Cannot write to radio! Message dropped: '%1'").arg(msg->serialize()));
 			return false;
 		}
 		const QByteArray buf = QByteArray(1, static_cast<char>(FanetProtocolParser::StartDelimiter))
 		        .append(msg->serialize())
 		        .append(static_cast<char>(FanetProtocolParser::EndDelimiter));
-		m_log.debug(QString("Sending message: '%1'").arg(buf.trimmed()));
+		LOGGER_DEBUG(m_log, QString("Sending message: '%1'").arg(buf.trimmed()));
 		if (m_uart->write(buf) != buf.length())
 		{
 			m_timer->stop();
-			m_log.error(QString("Failed to write to radio: %1").arg(m_uart->errorString()));
+			LOGGER_ERROR(m_log, QString("Failed to write to radio: %1").arg(m_uart->errorString()));
 			setState(RadioError);
 			return false;
 		}
@@ -219,7 +285,7 @@ void FanetRadio::onRadioInitialized(const AbstractFanetMessage *msg)
 	if (!reply || reply->replyType() != GenericReply::ReplyMsg ||
 	        reply->code() != FANET_MSG_CODE_INITIALIZED)
 	{
-		m_log.warning(QString("received unexpected message: %1").arg(msg->serialize()));
+		LOGGER_WARNING(m_log, QString("received unexpected message: %1").arg(msg->serialize()));
 		return;
 	}
 
@@ -235,19 +301,23 @@ void FanetRadio::handleVersionReply(const AbstractFanetMessage *msg)
 	m_timer->stop();
 	if (!reply || reply->version().isEmpty())
 	{
-		m_log.error(QString("Radio firmware version check failed!"));
+		LOGGER_ERROR(m_log, QString("Radio firmware version check failed!"));
 		setState(RadioWrongFw);
 		return;
 	}
 
 	if (reply->version() != FANET_EXPECTED_FW)
 	{
-		m_log.error(QString("Wrong radio firmware version: '%1' (expected: '%2')").arg(reply->version(), FANET_EXPECTED_FW));
+		LOGGER_ERROR(m_log, QString("Wrong radio firmware version: '%1' (expected: '%2')").arg(reply->version(), FANET_EXPECTED_FW));
 		setState(RadioWrongFw);
 		return;
 	}
 	m_log.notice(QString("Firmware version: %1").arg(reply->version()));
+	sendRegion();
+}
 
+void FanetRadio::sendRegion()
+{
 	QString freqStr;
 	RegionCommand::FanetFreq freq;
 	switch (m_config.frequency())
@@ -275,8 +345,8 @@ void FanetRadio::handleRegionReply(const AbstractFanetMessage *msg)
 	m_timer->stop();
 	if (!reply || reply->replyType() != GenericReply::ReplyOk)
 	{
-		m_log.error(QString("Failed to set radio region/enabled: %1 - %2")
-		            .arg(reply? reply->code() : -1).arg(reply ? reply->message() : ""));
+		LOGGER_ERROR(m_log, QString("Failed to set radio region/enabled: %1 - %2")
+		                    .arg(reply? reply->code() : -1).arg(reply ? reply->message() : ""));
 		setState(RadioError);
 		return;
 	}
@@ -303,24 +373,28 @@ void FanetRadio::handleFanetReply(const AbstractFanetMessage *msg)
 		switch (reply->replyType())
 		{
 			case GenericReply::ReplyOk:
-				m_log.debug(QString("Fanet command reply: ok"));
+				Metrics::instance().reply(Metrics::ReplyOk);
+				LOGGER_DEBUG(m_log, "Fanet command reply: ok");
 				break;
 			case GenericReply::ReplyMsg:
-				m_log.info(QString("Fanet command reply: %1 - %2").arg(reply->code()).arg(reply->message()));
+				LOGGER_INFO(m_log, QString("Fanet command reply: %1 - %2").arg(reply->code()).arg(reply->message()));
 				break;
 			case GenericReply::ReplyAck:
-				m_log.debug(QString("Fanet command: ack"));
+				Metrics::instance().reply(Metrics::ReplyAck);
+				LOGGER_DEBUG(m_log, "Fanet command: ack");
 				break;
 			case GenericReply::ReplyNack:
-				m_log.debug(QString("Fanet command: nack"));
+				Metrics::instance().reply(Metrics::ReplyNack);
+				LOGGER_DEBUG(m_log, "Fanet command: nack");
 				break;
 			case GenericReply::ReplyError:
-				m_log.error(QString("Fanet command failed: %1 - %2")
-				            .arg(reply? reply->code() : -1).arg(reply ? reply->message() : ""));
+				Metrics::instance().reply(Metrics::ReplyError);
+				LOGGER_ERROR(m_log, QString("Fanet command failed: %1 - %2")
+				                    .arg(reply? reply->code() : -1).arg(reply ? reply->message() : ""));
 				setState(RadioError);
 				break;
 			default:
-				m_log.error("Unknown reply");
+				LOGGER_ERROR(m_log, "Unknown reply");
 				break;
 		}
 	}
@@ -329,11 +403,16 @@ void FanetRadio::handleFanetReply(const AbstractFanetMessage *msg)
 void FanetRadio::handleFanetPktRecv(const AbstractFanetMessage *msg)
 {
 	const ReceiveEvent *event = dynamic_cast<const ReceiveEvent*>(msg);
-	if (event && event->isValid())
+	if (!event || !event->isValid())
 	{
-		m_log.info(event->toString());
-		emit messageReceived(event->address().toUInt32(), event->payload(), event->broadcast());
+		Metrics::instance().parseFailure();
+		return;
 	}
+	Metrics::instance().frameReceived(event->payload().type());
+	LOGGER_FIELDS(m_log, Logger::Info, event->toString(),
+	              Logger::Fields({{LOG_FIELD_FANET_ADDRESS, QString::fromLatin1(event->address().toHex(':'))},
+	                              {LOG_FIELD_PAYLOAD_TYPE, FanetPayload::payloadTypeStr(event->payload().type())}}));
+	emit messageReceived(event->address().toUInt32(), event->payload(), event->broadcast(), event->received());
 }
 
 void FanetRadio::init()
@@ -343,6 +422,17 @@ void FanetRadio::init()
 		return; // should never happen, but just in case...
 	}
 
+	if (m_replay)
+	{
+		// the radio's replies are part of the capture, so skip the init sequence
+		if (!m_replay->isRunning())
+		{
+			m_replay->start();
+		}
+		setState(RadioReady);
+		return;
+	}
+
 	if (m_uart->isOpen())
 	{
 		deinit();
@@ -359,7 +449,7 @@ void FanetRadio::init()
 	if (!m_uart->open(QIODevice::ReadWrite))
 	{
 		setState(m_uart->error() == QSerialPort::DeviceNotFoundError ? RadioDevNotFound : RadioDevOpenFail);
-		m_log.error(QString("failed to open serial port: %1 (%2)").arg(m_uart->errorString()).arg(m_uart->error()));
+		LOGGER_ERROR(m_log, QString("failed to open serial port: %1 (%2)").arg(m_uart->errorString()).arg(m_uart->error()));
 		return;
 	}
 
@@ -375,7 +465,7 @@ void FanetRadio::init()
 	// 	if (!m_dev || !m_dev->open(QIODevice::ReadWrite))
 	// 	{
 	// 		setState(RadioDevOpenFail);
-	// 		m_log.error(QString("failed to open device: %1").arg(m_dev ? m_dev->errorString() : QString("null")));
+	// 		LOGGER_ERROR(m_log, QString("failed to open device: %1").arg(m_dev ? m_dev->errorString() : QString("null")));
 	// 		return;
 	// 	}
 	// 	m_log.info("radio device opened.");
@@ -413,11 +503,11 @@ void FanetRadio::onTimeout()
 			m_timer->start(FANET_INIT_TIMEOUT_MSEC); // wait for "#FNR MSG,1,initialized\n" -> onRadioInitialized()
 			break;
 		case RadioInitializing:
-			m_log.error("Timeout initializing radio!");
+			LOGGER_ERROR(m_log, "Timeout initializing radio!");
 			setState(RadioInitTimeout);
 			break;
 		case RadioReady:
-			m_log.error("communication with radio timed out!");
+			LOGGER_ERROR(m_log, "communication with radio timed out!");
 			setState(RadioComTimeout);
 			break;
 		default:
@@ -427,14 +517,19 @@ void FanetRadio::onTimeout()
 
 void FanetRadio::onReadyRead()
 {
-	AbstractFanetMessage *msg;
-	while ((msg = m_parser->next()))
+	QIODevice *dev = m_replay ? static_cast<QIODevice*>(m_replay) : m_uart;
+	if (m_capture && !m_replay)
+	{
+		m_capture->append(m_uart->peek(m_uart->bytesAvailable()));
+	}
+	// next() also returns 0 for ignored messages, parse everything so no byte is captured twice
+	while (dev->isReadable() && dev->bytesAvailable() > 0)
 	{
-		if (msg->isValid())
+		AbstractFanetMessage *msg = m_parser->next();
+		if (msg && msg->isValid())
 		{
 			handleMessage(msg);
 		}
 		delete msg;
-		msg = 0;
 	}
 }
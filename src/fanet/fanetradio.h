@@ -19,6 +19,8 @@ class FanetPayload;
 class QSerialPort;
 class QTimer;
 class Gpio;
+class UartCapture;
+class UartReplay;
 
 class FanetRadio : public QObject
 {
@@ -52,6 +54,13 @@ public:
 
 	void injectMessage(const QString &data);
 
+	RadioConfig config() const { return m_config; }
+	bool setConfig(const RadioConfig &config); // applies tx power/frequency, false: other changes need a restart
+
+	bool startCapture(const QString &fileName); // appends all data read from the uart to a capture file
+	bool setReplay(const QString &fileName, double speed); // reads a capture instead of the uart, call before init()
+	bool isReplaying() const { return m_replay != nullptr; }
+
 	// stock firmware does not support (sender) address change needed for bradcasting weather data from different stations :(
 	bool supportsAddressChange() const { return false; }
 
@@ -70,10 +79,11 @@ private slots:
 
 signals:
 	void radioStateChanged(FanetRadio::RadioState state);
-	void messageReceived(quint32 addr, const FanetPayload &payload, bool broadcast);
+	void messageReceived(quint32 addr, const FanetPayload &payload, bool broadcast, qint64 timestamp); // msecs since epoch of reception
 
 protected:
 	void setState(RadioState state);
+	void sendRegion();
 	virtual void handleMessage(const AbstractFanetMessage *msg);
 	virtual bool sendMessage(const AbstractFanetMessage *msg);
 
@@ -85,6 +95,8 @@ private:
 	Gpio *m_gpio;
 	QTimer *m_timer;
 	FanetProtocolParser *m_parser;
+	UartCapture *m_capture;
+	UartReplay *m_replay;
 };
 
 #endif // FANETRADIO_H
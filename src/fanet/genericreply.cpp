@@ -17,6 +17,7 @@ static const char FANET_REPLY_MSG[]  = "MSG";
 static const char FANET_REPLY_ERR[]  = "ERR";
 static const char FANET_REPLY_ACK[]  = "ACK";
 static const char FANET_REPLY_NACK[] = "NACK";
+static Logger s_log("GenericReply");
 
 
 GenericReply::GenericReply(FanetMessageType type, const QByteArray &data) :
@@ -59,7 +60,7 @@ GenericReply::GenericReply(FanetMessageType type, const QByteArray &data) :
 		}
 		if (m_reply == ReplyOther)
 		{
-			Logger("GenericReply").error(QString("De-serialization failed: Unknown type (%1)!").arg(tmp.first()));
+			LOGGER_ERROR(s_log, QString("De-serialization failed: Unknown type (%1)!").arg(tmp.first()));
 		}
 	}
 }
@@ -80,7 +81,7 @@ QByteArray GenericReply::serialize() const
 		case FMTFanetReply:
 			return QByteArray(FanetProtocolParser::MSG_FANET_REPLY).append(' ').append(m_data);
 		default:
-			Logger("GenericReply").error(QString("Serialization failed: Unknown type (%1)!").arg(type()));
+			LOGGER_ERROR(s_log, QString("Serialization failed: Unknown type (%1)!").arg(type()));
 			break;
 	}
 	return QByteArray();
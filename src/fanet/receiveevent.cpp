@@ -8,22 +8,25 @@
 #include "logger.h"
 #include "fanetprotocolparser.h"
 #include <QByteArray>
+#include <QDateTime>
 #include <QStringList>
 
 static const char FANET_DATA_SEP     = ',';
+static Logger s_log("ReceiveEvent");
 
 ReceiveEvent::ReceiveEvent(const QByteArray &data) :
     AbstractFanetMessage(AbstractFanetMessage::FMTPktReceivedEvent),
     m_addr(),
     m_payload(),
     m_sig(),
-    m_broadcast(false)
+    m_broadcast(false),
+    m_received(QDateTime::currentMSecsSinceEpoch())
 {
 	QStringList tmp = QString::fromLatin1(data).trimmed().split(FANET_DATA_SEP, Qt::SkipEmptyParts);
 	if (tmp.size() < 7)
 	{
-		Logger("ReceiveEvent").warning(QString("Failed to parse fanet message: too short (%1)!")
-		                               .arg(QString::fromLatin1(data)));
+		LOGGER_WARNING(s_log, QString("Failed to parse fanet message: too short (%1)!")
+		                      .arg(QString::fromLatin1(data)));
 		return;
 	}
 
@@ -35,7 +38,7 @@ ReceiveEvent::ReceiveEvent(const QByteArray &data) :
 	int iPayloadType = tmp.at(4).toInt(&convOk, 16);
 	if (!convOk)
 	{
-		Logger("ReceiveEvent").warning(QString("Failed to parse fanet payload type (%1)!").arg(tmp.at(4)));
+		LOGGER_WARNING(s_log, QString("Failed to parse fanet payload type (%1)!").arg(tmp.at(4)));
 		return;
 	}
 	m_payload = FanetPayload::fromReceivedData(static_cast<FanetPayload::PayloadType>(iPayloadType), QByteArray::fromHex(tmp.at(6).toLatin1()));
@@ -82,8 +85,8 @@ QString ReceiveEvent::toString() const
 			        .arg(QString::fromLatin1(m_addr.toHex(':')), m_payload.position().toString()).arg(m_payload.temperature() / 10)
 			        .arg(m_payload.dir()).arg(m_payload.wind() / 10).arg(m_payload.gusts() / 10);
 		default:
-			Logger("ReceiveEvent").warning(QString("Failed to convert event to string: payload type (%1) not implemented")
-			                               .arg(m_payload.type()));
+			LOGGER_WARNING(s_log, QString("Failed to convert event to string: payload type (%1) not implemented")
+			                      .arg(m_payload.type()));
 			return QString();
 	}
 }
@@ -26,6 +26,7 @@ public:
 	FanetPayload payload() const { return m_payload; }
 	bool broadcast() const { return m_broadcast; }
 	QString signature() const { return m_sig; }
+	qint64 received() const { return m_received; } // msecs since epoch the event was read from the radio
 
 	QString toString() const;
 
@@ -36,6 +37,7 @@ protected:
 	FanetPayload m_payload;
 	QString m_sig;
 	bool m_broadcast;
+	qint64 m_received;
 };
 
 #endif // RECEIVEEVENT_H
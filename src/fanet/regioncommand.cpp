@@ -14,6 +14,7 @@ static const char FANET_FREQ915[]    = "915";
 static const char FANET_DATA_SEP     = ',';
 static const int  FANET_TXPOWER_MIN  = 2; // in dBm
 static const int  FANET_TXPOWER_MAX  = 20;
+static Logger s_log("RegionCommand");
 
 
 RegionCommand::RegionCommand(int txPower, FanetFreq freq) :
@@ -24,14 +25,14 @@ RegionCommand::RegionCommand(int txPower, FanetFreq freq) :
 	if (txPower < FANET_TXPOWER_MIN)
 	{
 		m_txPower = FANET_TXPOWER_MIN;
-		Logger("RegionCommand").warning(QString("Tx power (%1dBm) is below minimum! Using allowed min. tx power: %2dBm")
-		                                .arg(txPower).arg(FANET_TXPOWER_MIN));
+		LOGGER_WARNING(s_log, QString("Tx power (%1dBm) is below minimum! Using allowed min. tx power: %2dBm")
+		                      .arg(txPower).arg(FANET_TXPOWER_MIN));
 	}
 	if (txPower > FANET_TXPOWER_MAX)
 	{
 		m_txPower = FANET_TXPOWER_MAX;
-		Logger("RegionCommand").warning(QString("Tx power (%1dBm) is above maximum! Using allowed max. tx power: %2dBm")
-		                                .arg(txPower).arg(FANET_TXPOWER_MAX));
+		LOGGER_WARNING(s_log, QString("Tx power (%1dBm) is above maximum! Using allowed max. tx power: %2dBm")
+		                      .arg(txPower).arg(FANET_TXPOWER_MAX));
 	}
 }
 
@@ -53,7 +54,7 @@ QByteArray RegionCommand::serialize() const
 			data.append(FANET_FREQ915);
 			break;
 		default:
-			Logger("RegionCommand").error("Serialization failed! Invalid frequency!");
+			LOGGER_ERROR(s_log, "Serialization failed! Invalid frequency!");
 			return QByteArray();
 			break;
 	}
@@ -0,0 +1,106 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "uartcapture.h"
+#include "config.h"
+
+#include <QDateTime>
+#include <QTimer>
+#include <QtEndian>
+
+const char UartCapture::FILE_MAGIC[] = "FAGSCAP\x01";
+
+
+UartCapture::UartCapture(const QString &fileName, QObject *parent) :
+    QObject(parent),
+    m_log("UartCapture"),
+    m_file(fileName),
+    m_timer(new QTimer(this)),
+    m_clock(),
+    m_last(0),
+    m_pending()
+{
+	m_timer->setSingleShot(true);
+	connect(m_timer, &QTimer::timeout, this, &UartCapture::flush);
+}
+
+UartCapture::~UartCapture()
+{
+	close();
+}
+
+bool UartCapture::open()
+{
+	if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Unbuffered)) // we are batching ourselves
+	{
+		LOGGER_ERROR(m_log, QString("failed to open capture file %1: %2").arg(m_file.fileName(), m_file.errorString()));
+		return false;
+	}
+	m_pending.reserve(FANET_CAPTURE_FLUSH_SIZE + 1024);
+	m_pending.append(FILE_MAGIC, FILE_MAGIC_SIZE);
+	const qint64 started = qToLittleEndian(QDateTime::currentMSecsSinceEpoch());
+	m_pending.append(reinterpret_cast<const char*>(&started), sizeof(started));
+	m_clock.start();
+	m_last = 0;
+	flush();
+	m_log.notice(QString("capturing radio data to %1").arg(m_file.fileName()));
+	return true;
+}
+
+void UartCapture::close()
+{
+	if (m_file.isOpen())
+	{
+		flush();
+		m_file.close();
+	}
+}
+
+void UartCapture::append(const QByteArray &chunk)
+{
+	if (!m_file.isOpen() || chunk.isEmpty())
+	{
+		return;
+	}
+	const qint64 now = m_clock.nsecsElapsed() / 1000;
+	appendVarint(m_pending, static_cast<quint64>(now - m_last));
+	appendVarint(m_pending, static_cast<quint64>(chunk.size()));
+	m_pending.append(chunk);
+	m_last = now;
+
+	if (m_pending.size() >= FANET_CAPTURE_FLUSH_SIZE)
+	{
+		flush();
+	} else if (!m_timer->isActive())
+	{
+		m_timer->start(FANET_CAPTURE_FLUSH_INTERVAL);
+	}
+}
+
+void UartCapture::flush()
+{
+	m_timer->stop();
+	if (m_pending.isEmpty() || !m_file.isOpen())
+	{
+		return;
+	}
+	if (m_file.write(m_pending) != m_pending.size())
+	{
+		LOGGER_ERROR(m_log, QString("failed to write capture file %1: %2, capture stopped").arg(m_file.fileName(), m_file.errorString()));
+		m_file.close();
+	}
+	m_pending.clear(); // keeps the capacity
+}
+
+void UartCapture::appendVarint(QByteArray &buf, quint64 value)
+{
+	while (value >= 0x80)
+	{
+		buf.append(static_cast<char>((value & 0x7f) | 0x80));
+		value >>= 7;
+	}
+	buf.append(static_cast<char>(value));
+}
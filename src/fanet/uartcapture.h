@@ -0,0 +1,56 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef UARTCAPTURE_H
+#define UARTCAPTURE_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QFile>
+#include "logger.h"
+
+class QTimer;
+
+/**
+ * @class UartCapture appends the raw data read from the radio to a capture file (see UartReplay).
+ *        File format (integers little endian):
+ *          header: FILE_MAGIC (8 bytes), start time (qint64, msecs since epoch)
+ *          record: delta (varint, usecs since the previous record, monotonic), size (varint), data
+ *        Records are collected in memory and written in batches of FANET_CAPTURE_FLUSH_SIZE bytes,
+ *        at least every FANET_CAPTURE_FLUSH_INTERVAL msecs.
+ */
+class UartCapture : public QObject
+{
+	Q_OBJECT
+public:
+	static const char FILE_MAGIC[];
+	static const int FILE_MAGIC_SIZE = 8;
+
+	explicit UartCapture(const QString &fileName, QObject *parent = nullptr);
+	virtual ~UartCapture() Q_DECL_OVERRIDE;
+
+	bool open();
+	void close();
+	bool isOpen() const { return m_file.isOpen(); }
+
+	void append(const QByteArray &chunk);
+
+	static void appendVarint(QByteArray &buf, quint64 value);
+
+public slots:
+	void flush();
+
+private:
+	Logger m_log;
+	QFile m_file;
+	QTimer *m_timer;
+	QElapsedTimer m_clock;
+	qint64 m_last; // usecs
+	QByteArray m_pending;
+};
+
+#endif // UARTCAPTURE_H
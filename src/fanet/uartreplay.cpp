@@ -0,0 +1,166 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "uartreplay.h"
+#include "uartcapture.h"
+
+#include <QFile>
+#include <QTimer>
+#include <QtEndian>
+#include <cstring>
+
+static bool readVarint(const QByteArray &buf, qsizetype &pos, quint64 &value)
+{
+	value = 0;
+	for (int shift = 0; pos < buf.size() && shift < 64; shift += 7)
+	{
+		const quint8 byte = static_cast<quint8>(buf.at(pos++));
+		value |= static_cast<quint64>(byte & 0x7f) << shift;
+		if (!(byte & 0x80))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+
+UartReplay::UartReplay(QObject *parent) :
+    QIODevice(parent),
+    m_log("UartReplay"),
+    m_chunks(),
+    m_next(0),
+    m_startTime(0),
+    m_speed(1.0),
+    m_clock(),
+    m_timer(new QTimer(this)),
+    m_buffer()
+{
+	m_timer->setSingleShot(true);
+	m_timer->setTimerType(Qt::PreciseTimer);
+	connect(m_timer, &QTimer::timeout, this, &UartReplay::onTimeout);
+}
+
+UartReplay::~UartReplay()
+{
+}
+
+bool UartReplay::load(const QString &fileName)
+{
+	QFile file(fileName);
+	if (!file.open(QIODevice::ReadOnly))
+	{
+		LOGGER_ERROR(m_log, QString("failed to open capture file %1: %2").arg(fileName, file.errorString()));
+		return false;
+	}
+	const QByteArray content = file.readAll();
+	const qsizetype headerSize = UartCapture::FILE_MAGIC_SIZE + static_cast<qsizetype>(sizeof(qint64));
+	if (content.size() < headerSize || !content.startsWith(QByteArray(UartCapture::FILE_MAGIC, UartCapture::FILE_MAGIC_SIZE)))
+	{
+		LOGGER_ERROR(m_log, QString("%1 is not a capture file").arg(fileName));
+		return false;
+	}
+	m_startTime = qFromLittleEndian<qint64>(content.constData() + UartCapture::FILE_MAGIC_SIZE);
+
+	m_chunks.clear();
+	qsizetype pos = headerSize;
+	qint64 time = 0;
+	while (pos < content.size())
+	{
+		quint64 delta, size;
+		if (!readVarint(content, pos, delta) || !readVarint(content, pos, size) || size > static_cast<quint64>(content.size() - pos))
+		{
+			LOGGER_WARNING(m_log, QString("%1 is truncated, replaying %2 chunk(s)").arg(fileName).arg(m_chunks.size()));
+			break; // e.g. capture of a crashed instance
+		}
+		time += static_cast<qint64>(delta);
+		m_chunks.append({time, content.mid(pos, static_cast<qsizetype>(size))});
+		pos += static_cast<qsizetype>(size);
+	}
+	m_next = 0;
+	m_log.info(QString("%1: %2 chunk(s), %3sec.").arg(fileName).arg(m_chunks.size()).arg(duration() / 1e6, 0, 'f', 1));
+	return true;
+}
+
+void UartReplay::start()
+{
+	if (!isOpen())
+	{
+		open(QIODevice::ReadOnly);
+	}
+	m_next = 0;
+	m_buffer.clear();
+	m_clock.start();
+	m_timer->start(0);
+}
+
+bool UartReplay::isRunning() const
+{
+	return m_clock.isValid() && m_next < m_chunks.size();
+}
+
+bool UartReplay::atEnd() const
+{
+	return m_next >= m_chunks.size() && m_buffer.isEmpty() && QIODevice::atEnd();
+}
+
+qint64 UartReplay::duration() const
+{
+	return m_chunks.isEmpty() ? 0 : m_chunks.last().time;
+}
+
+QByteArray UartReplay::data() const
+{
+	QByteArray data;
+	for (const Chunk &chunk : m_chunks)
+	{
+		data.append(chunk.data);
+	}
+	return data;
+}
+
+void UartReplay::onTimeout()
+{
+	// due times are relative to the start (not to the previous chunk), so timer latencies do not add up
+	const qint64 now = m_clock.nsecsElapsed() / 1000;
+	const int first = m_next;
+	while (m_next < m_chunks.size() && (m_speed <= 0.0 || m_chunks.at(m_next).time / m_speed <= now))
+	{
+		m_buffer.append(m_chunks.at(m_next++).data);
+		if (m_speed <= 0.0)
+		{
+			break; // max. speed: one chunk per event loop iteration, as the serial port would deliver it
+		}
+	}
+	if (m_next > first)
+	{
+		emit readyRead();
+	}
+	if (m_next < m_chunks.size())
+	{
+		const qint64 due = (m_speed <= 0.0) ? 0 : static_cast<qint64>(m_chunks.at(m_next).time / m_speed);
+		m_timer->start(static_cast<int>(qBound<qint64>(0, (due - now) / 1000, 24 * 3600 * 1000)));
+	} else
+	{
+		m_log.info("replay finished");
+		emit finished();
+	}
+}
+
+qint64 UartReplay::readData(char *data, qint64 maxSize)
+{
+	const qint64 size = qMin(maxSize, static_cast<qint64>(m_buffer.size()));
+	memcpy(data, m_buffer.constData(), static_cast<size_t>(size));
+	m_buffer.remove(0, static_cast<qsizetype>(size));
+	return size;
+}
+
+qint64 UartReplay::writeData(const char *data, qint64 maxSize)
+{
+	Q_UNUSED(data);
+	Q_UNUSED(maxSize);
+	return -1; // read-only
+}
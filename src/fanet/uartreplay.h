@@ -0,0 +1,73 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef UARTREPLAY_H
+#define UARTREPLAY_H
+
+#include <QIODevice>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QVector>
+#include "logger.h"
+
+class QTimer;
+
+/**
+ * @class UartReplay is a read-only device playing back a capture file written by UartCapture, e.g. to
+ *        be read by FanetProtocolParser instead of the serial port. Each chunk becomes readable at its
+ *        original time divided by the replay speed (0: as fast as possible).
+ */
+class UartReplay : public QIODevice
+{
+	Q_OBJECT
+public:
+	explicit UartReplay(QObject *parent = nullptr);
+	virtual ~UartReplay() Q_DECL_OVERRIDE;
+
+	bool load(const QString &fileName);
+	void setSpeed(double speed) { m_speed = qMax(0.0, speed); }
+	double speed() const { return m_speed; }
+
+	void start();
+	bool isRunning() const;
+	bool atEnd() const Q_DECL_OVERRIDE;
+
+	int chunks() const { return m_chunks.size(); }
+	qint64 startTime() const { return m_startTime; } // of the capture, msecs since epoch
+	qint64 duration() const; // of the capture, usecs
+	QByteArray data() const; // all chunks at once (benchmarks)
+
+	bool isSequential() const Q_DECL_OVERRIDE { return true; }
+	qint64 bytesAvailable() const Q_DECL_OVERRIDE { return m_buffer.size() + QIODevice::bytesAvailable(); }
+
+signals:
+	void finished();
+
+protected:
+	qint64 readData(char *data, qint64 maxSize) Q_DECL_OVERRIDE;
+	qint64 writeData(const char *data, qint64 maxSize) Q_DECL_OVERRIDE;
+
+private slots:
+	void onTimeout();
+
+private:
+	struct Chunk
+	{
+		qint64 time; // usecs since start of capture
+		QByteArray data;
+	};
+
+	Logger m_log;
+	QVector<Chunk> m_chunks;
+	int m_next;
+	qint64 m_startTime;
+	double m_speed;
+	QElapsedTimer m_clock;
+	QTimer *m_timer;
+	QByteArray m_buffer;
+};
+
+#endif // UARTREPLAY_H
@@ -7,6 +7,8 @@
 #include "fanetmessagedispatcher.h"
 #include "fanet/fanetpayload.h"
 #include "fanet/fanetaddress.h"
+#include "metrics/metrics.h"
+#include "startupprofiler.h"
 
 FanetMessageDispatcher::FanetMessageDispatcher(const FanetConfig &config, const WeatherStationList &stations, FanetRadio *radio, QObject *parent) :
     QObject(parent),
@@ -17,9 +19,14 @@ FanetMessageDispatcher::FanetMessageDispatcher(const FanetConfig &config, const
     m_lastNodeSeen(),
     m_lastWeatherUpdate(),
     m_lastNameUpdate(),
-    m_timer(new QTimer(this))
+    m_timer(new QTimer(this)),
+    m_firstBroadcastDone(false)
 {
 	connect(m_timer, &QTimer::timeout, this, &FanetMessageDispatcher::onTimeout);
+	foreach (AbstractWeatherStation *station, m_stations)
+	{
+		station->setAveragingWindow(m_config.averagingWindow());
+	}
 
 	if (radio)
 	{
@@ -33,29 +40,147 @@ FanetMessageDispatcher::~FanetMessageDispatcher()
 {
 }
 
+void FanetMessageDispatcher::restoreState(const QDateTime &lastNodeSeen, const QDateTime &lastWeatherUpdate, const QDateTime &lastNameUpdate)
+{
+	const QDateTime current = QDateTime::currentDateTimeUtc();
+	// timestamps from the future are ignored (clock changed while we were not running)
+	if (lastNodeSeen.isValid() && lastNodeSeen <= current && (!m_lastNodeSeen.isValid() || lastNodeSeen > m_lastNodeSeen))
+	{
+		m_lastNodeSeen = lastNodeSeen;
+	}
+	if (lastWeatherUpdate.isValid() && lastWeatherUpdate <= current && !m_lastWeatherUpdate.isValid())
+	{
+		m_lastWeatherUpdate = lastWeatherUpdate;
+	}
+	if (lastNameUpdate.isValid() && lastNameUpdate <= current && !m_lastNameUpdate.isValid())
+	{
+		m_lastNameUpdate = lastNameUpdate;
+	}
+}
+
+bool FanetMessageDispatcher::isActive() const
+{
+	return m_config.inactivityTimeout() <= 0 ||
+	       (m_lastNodeSeen.isValid() && m_lastNodeSeen.secsTo(QDateTime::currentDateTimeUtc()) <= m_config.inactivityTimeout());
+}
+
+void FanetMessageDispatcher::prefetchWeatherData()
+{
+	if (!isActive())
+	{
+		return; // no pilots around: weather updates start once a node is seen
+	}
+	LOGGER_DEBUG(m_log, "Fetching weather data while radio is initializing...");
+	foreach (AbstractWeatherStation *station, m_stations)
+	{
+		station->requestUpdate(false); // no jitter, first broadcast needs the data
+	}
+}
+
+void FanetMessageDispatcher::setConfig(const FanetConfig &config)
+{
+	// intervals are checked on every timeout, so they take effect immediately
+	m_config = config;
+	foreach (AbstractWeatherStation *station, m_stations)
+	{
+		station->setAveragingWindow(config.averagingWindow());
+	}
+	m_log.info(QString("config changed: txintervalWeather=%1, txintervalNames=%2, inactivityTimeout=%3, weatherDataMaxAge=%4, averagingWindow=%5")
+	           .arg(config.txIntervalWeather()).arg(config.txIntervalNames()).arg(config.inactivityTimeout())
+	           .arg(config.weatherDataMaxAge()).arg(config.averagingWindow()));
+}
+
+void FanetMessageDispatcher::setStations(const WeatherStationList &stations)
+{
+	if (m_timer->isActive()) // broadcasting: start updating new stations right away
+	{
+		foreach (AbstractWeatherStation *station, stations)
+		{
+			if (!m_stations.contains(station))
+			{
+				station->setUpdateInterval(station->config().updateInterval());
+				station->requestUpdate(true);
+			}
+		}
+	}
+	m_stations = stations;
+	foreach (AbstractWeatherStation *station, m_stations)
+	{
+		station->setAveragingWindow(m_config.averagingWindow());
+	}
+}
+
 void FanetMessageDispatcher::sendWeatherData()
 {
-	m_lastWeatherUpdate = QDateTime::currentDateTimeUtc();
-	const QDateTime maxAge = m_lastWeatherUpdate.addSecs(-m_config.weatherDataMaxAge());
+	const QDateTime current = QDateTime::currentDateTimeUtc();
+	const QDateTime maxAge = current.addSecs(-m_config.weatherDataMaxAge());
+	bool sent = false;
 	foreach (AbstractWeatherStation *station, m_stations)
 	{
-		if (station->lastUpdate() > maxAge)
+		const WeatherSnapshotPtr snapshot = station->snapshot(); // consistent data of the last update
+		if (snapshot->lastUpdate > maxAge)
 		{
-			const FanetPayload::ServiceHeaderFlags header(FanetPayload::SHWind | (station->availableData() & AbstractWeatherStation::Temperature ? FanetPayload::SHTemperature : 0));
-			const QGeoCoordinate pos(station->config().position());
-			const FanetPayload data(FanetPayload::servicePayload(header, pos, station->temperature(), station->windDirection(), station->windSpeed(), station->windGusts(), 0, 0));
+			const AbstractWeatherStation::WeatherDataFlags available = AbstractWeatherStation::WeatherDataFlags::fromInt(snapshot->availableData);
+			const QGeoCoordinate &pos = snapshot->position;
+			int temperature = snapshot->temperature;
+			int windDirection = snapshot->windDirection;
+			int windSpeed = snapshot->windSpeed;
+			int windGusts = snapshot->windGusts;
+			int humidity = snapshot->humidity;
+			if (m_config.averagingWindow() > 0 && snapshot->averageWindow == m_config.averagingWindow())
+			{
+				const WeatherHistory::Aggregate &avg = snapshot->average; // as of the last update
+				if (avg.samples > 0) // otherwise fall back to latest sample
+				{
+					temperature = avg.temperature;
+					windDirection = avg.windDirection;
+					windSpeed = avg.windSpeed;
+					windGusts = avg.windGusts;
+					humidity = avg.humidity;
+				}
+			}
+			if (windGusts < 0)
+			{
+				windGusts = windSpeed; // station does not provide gusts
+			}
+			FanetPayload::ServiceHeaderFlags header(FanetPayload::SHWind);
+			if (available & AbstractWeatherStation::Temperature)
+			{
+				header |= FanetPayload::SHTemperature;
+			}
+			if ((available & AbstractWeatherStation::Humidity) && humidity >= 0)
+			{
+				header |= FanetPayload::SHHumidity;
+			}
+			const FanetPayload data(FanetPayload::servicePayload(header, pos, temperature, windDirection, windSpeed, windGusts, humidity, 0));
 			const FanetAddress bcAddr;
 
 			/// @todo set fanet address of sender (1 address per station needed!) here, once supported
-			m_radio->sendData(bcAddr, data);
+			sent |= m_radio->sendData(bcAddr, data);
 		} else
 		{
-			m_log.debug(QString("Not sending weather data for station #%1 (%2): station has outdated data (last update: %1)")
-			            .arg(station->stationId()).arg(station->stationName(), station->lastUpdate().toString()));
+			LOGGER_DEBUG(m_log, QString("Not sending weather data for station #%1 (%2): station has outdated data (last update: %3)")
+			                    .arg(station->stationId()).arg(station->stationName(), snapshot->lastUpdate.toString()));
 		}
 		if (!m_radio->supportsAddressChange())
 		{
-			return; // skip other stations as radio does not support address change
+			break; // skip other stations as radio does not support address change
+		}
+	}
+	if (!sent && !m_firstBroadcastDone)
+	{
+		return; // no data yet: retry on next timeout instead of waiting a full interval
+	}
+	m_lastWeatherUpdate = current; // later on, failed broadcasts are retried after a full interval only
+	if (!m_firstBroadcastDone)
+	{
+		m_firstBroadcastDone = true;
+		StartupProfiler::mark("first broadcast");
+		const qint64 startup = StartupProfiler::elapsed("first broadcast"); // < 0 if the profiler was not started
+		if (startup >= 0)
+		{
+			Metrics::instance().setStartupTime(startup);
+			m_log.notice(QString("first weather broadcast, startup: %1").arg(StartupProfiler::report()));
 		}
 	}
 }
@@ -84,7 +209,7 @@ void FanetMessageDispatcher::sendStationNames()
 void FanetMessageDispatcher::onTimeout()
 {
 	const QDateTime current = QDateTime::currentDateTimeUtc();
-	if (m_config.inactivityTimeout() > 0 && (!m_lastNodeSeen.isValid() || m_lastNodeSeen.secsTo(QDateTime::currentDateTimeUtc()) > m_config.inactivityTimeout()))
+	if (!isActive())
 	{
 		m_log.info(QString("No Fanet nodes seen within the last %1 minutes, disabling weather data broadcasting...")
 		           .arg(m_config.inactivityTimeout() / 60));
@@ -115,11 +240,16 @@ void FanetMessageDispatcher::disableWeatherUpdates()
 void FanetMessageDispatcher::enabledWeatherUpdates()
 {
 	m_log.debug("Enabling weather updates...");
+	const QDateTime current = QDateTime::currentDateTimeUtc();
 	foreach (AbstractWeatherStation *station, m_stations)
 	{
 		const StationConfig &config = station->config();
 		station->setUpdateInterval(config.updateInterval());
-		station->update();
+		const QDateTime lastUpdate = station->snapshot()->lastUpdate;
+		if (!lastUpdate.isValid() || lastUpdate.secsTo(current) > config.updateInterval())
+		{
+			station->requestUpdate(true); // jittered, to not hit all providers at once
+		}
 	}
 	m_timer->start(1000);
 }
@@ -129,16 +259,17 @@ void FanetMessageDispatcher::onRadioStateChanged(FanetRadio::RadioState state)
 	switch (state)
 	{
 		case FanetRadio::RadioReady:
+			StartupProfiler::mark("radio ready");
 			if (!m_radio->supportsAddressChange() && m_stations.size() > 1)
 			{
-				m_log.warning("Multiple weather stations configured but radio firmware does not support address change. "
-				              "Bradcasting data from 1st weather station via fanet only!");
+				LOGGER_WARNING(m_log, "Multiple weather stations configured but radio firmware does not support address change. "
+				                      "Bradcasting data from 1st weather station via fanet only!");
 			}
 			enabledWeatherUpdates();
 			break;
 		case FanetRadio::RadioError: // fall
 		case FanetRadio::RadioComTimeout:
-			m_log.error("Fanet radio has gone into error state!");
+			LOGGER_ERROR(m_log, "Fanet radio has gone into error state!");
 			disableWeatherUpdates();
 			m_log.info("Trying to re-initialize radio...");
 			m_radio->init();
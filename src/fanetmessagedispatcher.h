@@ -24,6 +24,15 @@ public:
 	explicit FanetMessageDispatcher(const FanetConfig &config, const WeatherStationList &stations, FanetRadio *radio, QObject *parent = nullptr);
 	virtual ~FanetMessageDispatcher() Q_DECL_OVERRIDE;
 
+	QDateTime lastNodeSeen() const { return m_lastNodeSeen; }
+	QDateTime lastWeatherUpdate() const { return m_lastWeatherUpdate; }
+	QDateTime lastNameUpdate() const { return m_lastNameUpdate; }
+	void restoreState(const QDateTime &lastNodeSeen, const QDateTime &lastWeatherUpdate, const QDateTime &lastNameUpdate);
+
+	void prefetchWeatherData(); // startup: fetch data before the radio is ready, if it is going to be broadcasted
+	void setConfig(const FanetConfig &config);
+	void setStations(const WeatherStationList &stations); // config reload: stations not in the list must be deleted by the caller
+
 public slots:
 	void sendWeatherData();
 	void sendStationNames();
@@ -36,6 +45,8 @@ private slots:
 	void onFanetMessageReceived(quint32 addr, const FanetPayload &payload, bool broadcast);
 
 private:
+	bool isActive() const; // nodes seen recently (or no inactivity timeout)
+
 	Logger m_log;
 	FanetConfig m_config;
 	FanetRadio *m_radio;
@@ -44,6 +55,7 @@ private:
 	QDateTime m_lastWeatherUpdate;
 	QDateTime m_lastNameUpdate;
 	QTimer *m_timer;
+	bool m_firstBroadcastDone;
 };
 
 #endif // FANETMESSAGEDISPATCHER_H
@@ -12,6 +12,7 @@
     #include <bcm2835.h>
 #endif
 
+static Logger s_log("Gpio");
 
 Gpio::Gpio(QObject *parent) :
     QObject(parent),
@@ -27,7 +28,7 @@ Gpio::Gpio(QObject *parent) :
 		log.info("Library bcm2835 initialized.");
 	} else
 	{
-		log.error("Failed to initialize lib bcm2835!");
+		LOGGER_ERROR(log, "Failed to initialize lib bcm2835!");
 	}
 #endif
 }
@@ -44,8 +45,8 @@ void Gpio::initPin(GpioPin pin, GpioFunction func, bool invert)
 	quint8 rpin = rpiPin(pin);
 	if (rpin && m_initialized)
 	{
-		Logger("Gpio").debug(QString("Configuring pin %1 as %2%3")
-		                     .arg(pinToString(pin), funcToString(func), invert ? " (inverted)" : ""));
+		LOGGER_DEBUG(s_log, QString("Configuring pin %1 as %2%3")
+		                    .arg(pinToString(pin), funcToString(func), invert ? " (inverted)" : ""));
 #if defined RPI_GPIO
 		bcm2835_gpio_fsel(rpin, static_cast<quint8>(func));
 #endif
@@ -59,8 +60,8 @@ void Gpio::setGpio(GpioPin pin, bool value)
 	quint8 rpin = rpiPin(pin);
 	if (rpin && m_initialized)
 	{
-		Logger("Gpio").debug(QString("Setting gpio %1 to %2")
-		                     .arg(pinToString(pin), isInverted(pin) ^ value ? "true" : "false"));
+		LOGGER_DEBUG(s_log, QString("Setting gpio %1 to %2")
+		                    .arg(pinToString(pin), isInverted(pin) ^ value ? "true" : "false"));
 		bcm2835_gpio_write(rpin, isInverted(pin) ^ value ? HIGH : LOW);
 		return;
 	}
@@ -78,8 +79,8 @@ void Gpio::setGpio(GpioPin pin, bool value)
 			default:
 				return;
 		}
-		Logger("Gpio").debug(QString("Setting uart %1 to %2")
-		                     .arg(pinToString(pin), isInverted(pin) ^ value ? "true" : "false"));
+		LOGGER_DEBUG(s_log, QString("Setting uart %1 to %2")
+		                    .arg(pinToString(pin), isInverted(pin) ^ value ? "true" : "false"));
 	}
 }
 
@@ -0,0 +1,100 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "listenserver.h"
+
+#include <QHostAddress>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QTcpServer>
+#include <QTcpSocket>
+
+
+ListenServer::ListenServer(const QString &name, const ListenConfig &config, const QString &service, QObject *parent) :
+    QObject(parent),
+    m_log(name),
+    m_config(config),
+    m_service(service),
+    m_tcpServer(nullptr),
+    m_localServer(nullptr)
+{
+}
+
+ListenServer::~ListenServer()
+{
+	if (m_localServer)
+	{
+		m_localServer->close(); // removes the socket file
+	}
+}
+
+bool ListenServer::listen()
+{
+	if (!m_config.socket().isEmpty())
+	{
+		m_localServer = new QLocalServer(this);
+		m_localServer->setSocketOptions(QLocalServer::UserAccessOption | QLocalServer::GroupAccessOption);
+		QLocalServer::removeServer(m_config.socket()); // stale socket of a crashed instance
+		connect(m_localServer, &QLocalServer::newConnection, this, &ListenServer::onNewLocalConnection);
+		if (!m_localServer->listen(m_config.socket()))
+		{
+			LOGGER_ERROR(m_log, QString("failed to listen on %1: %2").arg(m_config.socket(), m_localServer->errorString()));
+			return false;
+		}
+	} else
+	{
+		m_tcpServer = new QTcpServer(this);
+		connect(m_tcpServer, &QTcpServer::newConnection, this, &ListenServer::onNewTcpConnection);
+		if (!m_tcpServer->listen(QHostAddress(m_config.host()), m_config.port()))
+		{
+			LOGGER_ERROR(m_log, QString("failed to listen on %1: %2").arg(m_config.toString(), m_tcpServer->errorString()));
+			return false;
+		}
+	}
+	m_log.info(QString("%1 on %2").arg(m_service, m_config.toString()));
+	return true;
+}
+
+bool ListenServer::isListening() const
+{
+	return (m_tcpServer && m_tcpServer->isListening()) || (m_localServer && m_localServer->isListening());
+}
+
+void ListenServer::onNewTcpConnection()
+{
+	while (QTcpSocket *client = m_tcpServer->nextPendingConnection())
+	{
+		connect(client, &QAbstractSocket::disconnected, client, &QObject::deleteLater);
+		if (!acceptClient(client))
+		{
+			closeClient(client);
+		}
+	}
+}
+
+void ListenServer::onNewLocalConnection()
+{
+	while (QLocalSocket *client = m_localServer->nextPendingConnection())
+	{
+		connect(client, &QLocalSocket::disconnected, client, &QObject::deleteLater);
+		if (!acceptClient(client))
+		{
+			closeClient(client);
+		}
+	}
+}
+
+void ListenServer::closeClient(QIODevice *client)
+{
+	// both flush pending data before closing, 'disconnected' deletes the socket
+	if (QAbstractSocket *socket = qobject_cast<QAbstractSocket*>(client))
+	{
+		socket->disconnectFromHost();
+	} else if (QLocalSocket *socket = qobject_cast<QLocalSocket*>(client))
+	{
+		socket->disconnectFromServer();
+	}
+}
@@ -0,0 +1,51 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef LISTENSERVER_H
+#define LISTENSERVER_H
+
+#include <QObject>
+#include <QString>
+#include "logger.h"
+#include "config/listenconfig.h"
+
+class QIODevice;
+class QLocalServer;
+class QTcpServer;
+
+/**
+ * @class ListenServer listens on a local tcp port or a unix socket (see ListenConfig) and hands every
+ *        accepted connection to @fn acceptClient(). Connections are deleted once disconnected.
+ */
+class ListenServer : public QObject
+{
+	Q_OBJECT
+public:
+	virtual ~ListenServer() Q_DECL_OVERRIDE;
+
+	bool listen();
+	bool isListening() const;
+
+protected:
+	explicit ListenServer(const QString &name, const ListenConfig &config, const QString &service, QObject *parent = nullptr);
+
+	virtual bool acceptClient(QIODevice *client) = 0; // false: connection is closed
+	static void closeClient(QIODevice *client);
+
+	Logger m_log;
+	ListenConfig m_config;
+
+private slots:
+	void onNewTcpConnection();
+	void onNewLocalConnection();
+
+private:
+	const QString m_service; // for the log, e.g. "serving metrics"
+	QTcpServer *m_tcpServer;
+	QLocalServer *m_localServer;
+};
+
+#endif // LISTENSERVER_H
@@ -0,0 +1,133 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "journalwriter.h"
+#include "config.h"
+
+#include <QtEndian>
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/**
+ * Journal priorities (syslog levels), same order as Logger::LogType
+ */
+static const char PRIORITY[][12] = {"PRIORITY=2\n", "PRIORITY=3\n", "PRIORITY=4\n", "PRIORITY=5\n", "PRIORITY=6\n", "PRIORITY=7\n"};
+static_assert(sizeof(PRIORITY) / sizeof(PRIORITY[0]) == Logger::UnknownType, "'PRIORITY' must map ALL Logger::LogType values");
+
+static const char FIELD_MESSAGE[]    = "MESSAGE";
+static const char FIELD_IDENTIFIER[] = "SYSLOG_IDENTIFIER=";
+
+
+JournalWriter::JournalWriter() :
+    m_fd(-1),
+    m_identifier(),
+    m_categories(),
+    m_buffer()
+{
+}
+
+JournalWriter::~JournalWriter()
+{
+	close();
+}
+
+bool JournalWriter::open(const QByteArray &identifier)
+{
+	m_identifier = QByteArray(FIELD_IDENTIFIER).append(identifier).append('\n');
+	return isOpen() || connectSocket();
+}
+
+void JournalWriter::close()
+{
+	if (m_fd >= 0)
+	{
+		::close(m_fd);
+		m_fd = -1;
+	}
+}
+
+bool JournalWriter::connectSocket()
+{
+	close();
+	const int fd = ::socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+	if (fd < 0)
+	{
+		return false;
+	}
+	struct sockaddr_un addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strncpy(addr.sun_path, LOG_JOURNAL_SOCKET, sizeof(addr.sun_path) - 1);
+	if (::connect(fd, reinterpret_cast<const struct sockaddr*>(&addr), sizeof(addr)) != 0)
+	{
+		::close(fd);
+		return false;
+	}
+	m_fd = fd;
+	return true;
+}
+
+bool JournalWriter::write(Logger::LogType type, const QString &category, const QString &message, const Logger::Fields &fields)
+{
+	if (m_fd < 0 || type < Logger::Critical || type >= Logger::UnknownType)
+	{
+		return false;
+	}
+
+	m_buffer.resize(0); // keeps capacity
+	m_buffer.append(PRIORITY[type]);
+	m_buffer.append(m_identifier);
+	m_buffer.append(categoryField(category));
+	appendField(FIELD_MESSAGE, message);
+	foreach (const Logger::Field &field, fields)
+	{
+		appendField(field.name, field.value);
+	}
+
+	if (::send(m_fd, m_buffer.constData(), m_buffer.size(), MSG_NOSIGNAL) >= 0)
+	{
+		return true;
+	}
+	if ((errno == ECONNREFUSED || errno == ENOTCONN) && connectSocket()) // journald restarted
+	{
+		return ::send(m_fd, m_buffer.constData(), m_buffer.size(), MSG_NOSIGNAL) >= 0;
+	}
+	return false;
+}
+
+const QByteArray &JournalWriter::categoryField(const QString &category)
+{
+	QHash<QString, QByteArray>::const_iterator it = m_categories.constFind(category);
+	if (it == m_categories.constEnd())
+	{
+		it = m_categories.insert(category, QByteArray(LOG_FIELD_CATEGORY).append('=').append(category.toUtf8()).append('\n'));
+	}
+	return it.value();
+}
+
+void JournalWriter::appendField(const char *name, const QString &value)
+{
+	QByteArray data(value.toUtf8());
+	if (data.endsWith('\n'))
+	{
+		data.chop(1);
+	}
+	m_buffer.append(name);
+	if (data.contains('\n')) // binary format: name '\n' <64bit little endian size> data '\n'
+	{
+		const quint64 size = qToLittleEndian<quint64>(data.size());
+		m_buffer.append('\n');
+		m_buffer.append(reinterpret_cast<const char*>(&size), sizeof(size));
+	} else
+	{
+		m_buffer.append('=');
+	}
+	m_buffer.append(data);
+	m_buffer.append('\n');
+}
@@ -0,0 +1,44 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef JOURNALWRITER_H
+#define JOURNALWRITER_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include "logger.h"
+
+/**
+ * @class JournalWriter sends log messages to systemd's journal using its native protocol (one datagram
+ *        per message, see systemd.journal-fields(7)). Unlike syslog the category and any Logger::Fields are
+ *        stored as separate fields, e.g. 'journalctl FAGS_CATEGORY=FanetRadio FAGS_STATION_ID=101'.
+ * @note not thread-safe, Logger calls it with its mutex locked
+ */
+class JournalWriter
+{
+public:
+	JournalWriter();
+	~JournalWriter();
+
+	bool open(const QByteArray &identifier); // returns false if the journal is not available
+	void close();
+	bool isOpen() const { return m_fd >= 0; }
+
+	bool write(Logger::LogType type, const QString &category, const QString &message, const Logger::Fields &fields);
+
+private:
+	bool connectSocket();
+	const QByteArray &categoryField(const QString &category);
+	void appendField(const char *name, const QString &value);
+
+	int m_fd;
+	QByteArray m_identifier;                 // "SYSLOG_IDENTIFIER=...\n"
+	QHash<QString, QByteArray> m_categories; // "FAGS_CATEGORY=...\n", encoded once per category
+	QByteArray m_buffer;                     // datagram, reused for every message
+};
+
+#endif // JOURNALWRITER_H
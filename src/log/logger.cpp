@@ -13,10 +13,18 @@
 #include <QMutex>
 #include <QIODevice>
 #include <QMutexLocker>
+#include <QHash>
 #include <QTextStream>
 #include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QSemaphore>
+#include <QThread>
+#include <atomic>
 
 #include "logger.h"
+#include "logqueue.h"
+#include "journalwriter.h"
+#include "loglimiter.h"
 #include "config.h"
 
 /**
@@ -43,21 +51,80 @@ void globalMsgHandler(QtMsgType type, const QMessageLogContext &context, const Q
 
 Logger *Logger::s_instance = 0;
 QAtomicInt Logger::s_maxLevel = Logger::Debug;
+QAtomicInt Logger::s_levels[Logger::MaxCategories]; // zero initialized: all categories use s_maxLevel
+
+/**
+ * Interned log categories (a category is the className of a Logger). Ids are never released,
+ * id 0 is used for the global instance, Logger::OverflowCategory once all other ids are taken.
+ */
+struct LogCategories
+{
+	QMutex mutex;
+	QHash<QString, int> ids;
+
+	LogCategories() : mutex(), ids() {}
+};
+
+static LogCategories &logCategories()
+{
+	static LogCategories categories; // constructed on first use, Loggers may be static objects, too
+	return categories;
+}
 
 struct Logger::Private
 {
 	QTextStream console;
 	bool consoleColors;
 	Logger::LogTargets targets;
-	QMutex mutex;
+	QMutex mutex;                 // guards output and settings (async: held by the writer while writing a batch)
+	QElapsedTimer clock;          // monotonic timestamps
+	Logger::TimestampFormat timestampFormat;
+	qint64 stampSecond;           // console timestamp cache: second (since epoch) 'stamp' was built for...
+	QString stamp;                // ...formatted timestamp, only the msecs are patched per message
+	LogQueue queue;
+	JournalWriter journal;
+	LogLimiter limiter;
+	bool limiting;                // fold repetitions and rate limit, see LogLimiter
+	std::atomic<QThread*> writer; // exchanged, so concurrent stopWriter() calls stop (and delete) it once
+	QSemaphore wakeup;
+	std::atomic<bool> async;
+	std::atomic<bool> writerIdle;
+	std::atomic<bool> writerStop;
+	std::atomic<quint64> dropped; // total number of messages dropped (queue full)
 
 	Private() :
 	    console(stdout, QIODevice::WriteOnly),
 	    consoleColors(false),
 	    targets(Logger::LogToConsole),
-	    mutex()
+	    mutex(),
+	    clock(),
+	    timestampFormat(Logger::TimestampSeconds),
+	    stampSecond(-1),
+	    stamp(),
+	    queue(LOG_QUEUE_SIZE),
+	    journal(),
+	    limiter(),
+	    limiting(true),
+	    writer(nullptr),
+	    wakeup(),
+	    async(false),
+	    writerIdle(false),
+	    writerStop(false),
+	    dropped(0)
 	{
+		clock.start();
 	}
+
+	void write(Logger::LogType type, const QString &className, const char *site, qint64 timestamp, qint64 elapsed, const QString &message,
+	           const Logger::Fields &fields);
+	void output(Logger::LogType type, const QString &className, qint64 timestamp, qint64 elapsed, const QString &message,
+	            const Logger::Fields &fields);
+	const QString &formatTimestamp(qint64 timestamp, qint64 elapsed);
+	void flushLimiter();
+	void startWriter();
+	void stopWriter();
+	void runWriter();
+	void drain();
 };
 
 Logger *Logger::instance()
@@ -76,7 +143,10 @@ void Logger::destroy()
 	Q_ASSERT_X(qApp->thread() == QObject().thread(), "Logger::destroy()", "Logger must only be destroyed from main thread!");
 	if (s_instance)
 	{
-		s_instance->log("Logger", Debug, "destroyed.");
+		if (s_instance->isEnabled(Debug))
+		{
+			s_instance->log("Logger", Debug, "destroyed.");
+		}
 		delete s_instance;
 		s_instance = 0;
 	}
@@ -84,17 +154,30 @@ void Logger::destroy()
 
 Logger::Logger(const QString &className) :
     m_d(0),
-    m_className(className)
+    m_className(className),
+    m_category(category(className)),
+    m_fields()
 {
 	// 'className' helps identifying the origin of a log message a lot and therefore should always be set...
 	Q_ASSERT_X(!className.isEmpty(), "Logger::Logger(QString)", "Classname must not be empty!");
 }
 
+Logger::Logger(const QString &className, const Fields &fields) :
+    m_d(0),
+    m_className(className),
+    m_category(category(className)),
+    m_fields(fields)
+{
+	Q_ASSERT_X(!className.isEmpty(), "Logger::Logger(QString, Fields)", "Classname must not be empty!");
+}
+
 Logger::~Logger()
 {
 	if (m_d)
 	{
 		qInstallMessageHandler(0);	// uninstall our customized message handler
+		m_d->stopWriter();
+		m_d->flushLimiter();        // pending 'last message repeated N times'
 		
 		if (m_d->targets.testFlag(LogToSyslog))
 		{
@@ -106,94 +189,265 @@ Logger::~Logger()
 
 void Logger::debug(const QString &message)
 {
-	instance()->log(m_className, Debug, message);
+	if (isEnabled(Debug))
+	{
+		instance()->log(m_className, Debug, message, m_fields);
+	}
 }
 
 void Logger::info(const QString &message)
 {
-	instance()->log(m_className, Info, message);
+	if (isEnabled(Info))
+	{
+		instance()->log(m_className, Info, message, m_fields);
+	}
 }
 
 void Logger::notice(const QString &message)
 {
-	instance()->log(m_className, Notice, message);
+	if (isEnabled(Notice))
+	{
+		instance()->log(m_className, Notice, message, m_fields);
+	}
 }
 
 void Logger::warning(const QString &message)
 {
-	instance()->log(m_className, Warning, message);
+	if (isEnabled(Warning))
+	{
+		instance()->log(m_className, Warning, message, m_fields);
+	}
 }
 
 void Logger::error(const QString &message)
 {
-	instance()->log(m_className, Error, message);
+	if (isEnabled(Error))
+	{
+		instance()->log(m_className, Error, message, m_fields);
+	}
 }
 
 void Logger::critical(const QString &message)
 {
-	instance()->log(m_className, Critical, message);
+	instance()->m_d->stopWriter(); // write pending messages before exiting
+	instance()->log(m_className, Critical, message, m_fields);
 	std::exit(LOGGER_EXIT_CODE_CRITICAL);
 }
 
 Logger::Logger() :
-    m_d(new Private())
+    m_d(new Private()),
+    m_category(0),
+    m_fields()
 {
 	QByteArray term = qgetenv("TERM"); // try to auto-detect whether console supports colors...
 	m_d->consoleColors = (term.contains("xterm") || term.contains("color"));
 	qInstallMessageHandler(globalMsgHandler);
 }
 
-void Logger::log(const QString &className, LogType type, const QString &message)
+void Logger::log(LogType type, const QString &message, const Fields &fields, const char *site)
 {
-	/// @note lock mutex after checking s_maxLevel to prevent blocking if no logging is done
-#if QT_VERSION < QT_VERSION_CHECK(5, 14, 0)
-	if (s_maxLevel.load() < type || type == UnknownType)
-#else
-	if (s_maxLevel.loadRelaxed() < type || type == UnknownType)
-#endif
+	if (type == Critical)
+	{
+		critical(message); // does not return
+	}
+	if (isEnabled(type))
+	{
+		instance()->log(m_className, type, message, m_fields.isEmpty() ? fields : m_fields + fields, site);
+	}
+}
+
+void Logger::log(const QString &className, LogType type, const QString &message, const Fields &fields, const char *site)
+{
+	/// @note log level (global or per category) has already been checked by the caller, see isEnabled()
+	if (type == UnknownType)
 	{
 		return;
 	}
 
 	if (!m_d)
 	{
-		instance()->log(className, type, message);
+		instance()->log(className, type, message, fields, site);
 		return;
 	}
 
-	QMutexLocker lock(&m_d->mutex);
-	if (m_d->targets.testFlag(LogToConsole)) // log to console...
+	if (type != Critical && m_d->async.load(std::memory_order_acquire))
 	{
-		QString logMessage(QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss: %1: %2: %3")
-							   .arg(LOGINFO[type][1], className.isEmpty() ? "unknown" : className, message));
+		if (m_d->queue.push(LogQueue::Record{type, className, site, QDateTime::currentMSecsSinceEpoch(), m_d->clock.elapsed(), message, fields}))
+		{
+			if (m_d->writerIdle.exchange(false))
+			{
+				m_d->wakeup.release();
+			}
+		} else
+		{
+			m_d->dropped.fetch_add(1, std::memory_order_relaxed);
+		}
+		return;
+	}
 
-		if (message.endsWith('\n'))
+	QMutexLocker lock(&m_d->mutex);
+	m_d->write(type, className, site, QDateTime::currentMSecsSinceEpoch(), m_d->clock.elapsed(), message, fields);
+	m_d->console.flush();
+}
+
+void Logger::Private::write(Logger::LogType type, const QString &className, const char *site, qint64 timestamp, qint64 elapsed, const QString &message,
+                            const Logger::Fields &fields)
+{
+	if (limiting)
+	{
+		LogLimiter::Summaries summaries;
+		const bool accepted = limiter.filter(type, className, site, message, elapsed, summaries); // monotonic
+		foreach (const LogLimiter::Summary &summary, summaries)
 		{
-			logMessage.chop(1);
+			output(summary.type, summary.category, timestamp, elapsed, summary.message, Logger::Fields());
 		}
-		if (m_d->consoleColors)
+		if (!accepted)
 		{
-#if QT_VERSION < QT_VERSION_CHECK(5, 14, 0)
-			m_d->console << LOGINFO[type][0] << logMessage << "\x1b\x5b;1;0;0m" << endl; // colorful output
-#else
-			m_d->console << LOGINFO[type][0] << logMessage << "\x1b\x5b;1;0;0m" << Qt::endl; // colorful output
-#endif
-		} else
+			return;
+		}
+	}
+	output(type, className, timestamp, elapsed, message, fields);
+}
+
+void Logger::Private::flushLimiter()
+{
+	LogLimiter::Summaries summaries;
+	limiter.flush(summaries);
+	foreach (const LogLimiter::Summary &summary, summaries)
+	{
+		output(summary.type, summary.category, QDateTime::currentMSecsSinceEpoch(), clock.elapsed(), summary.message, Logger::Fields());
+	}
+	console.flush();
+}
+
+void Logger::Private::output(Logger::LogType type, const QString &className, qint64 timestamp, qint64 elapsed, const QString &message,
+                             const Logger::Fields &fields)
+{
+	if (targets.testFlag(LogToConsole)) // log to console...
+	{
+		if (consoleColors)
 		{
-#if QT_VERSION < QT_VERSION_CHECK(5, 14, 0)
-			m_d->console << logMessage << endl; // no colors
-#else
-			m_d->console << logMessage << Qt::endl; // no colors
-#endif
+			console << LOGINFO[type][0];
 		}
+		console << formatTimestamp(timestamp, elapsed) << ": " << LOGINFO[type][1] << ": ";
+		console << (className.isEmpty() ? QString("unknown") : className) << ": ";
+		console << (message.endsWith('\n') ? QStringView(message).chopped(1) : QStringView(message));
+		console << (consoleColors ? "\x1b\x5b;1;0;0m\n" : "\n"); // reset colors
 	}
 
-	if (m_d->targets.testFlag(LogToSyslog))
+	if (targets.testFlag(LogToSyslog))
 	{
 		static const int prio[] = { LOG_CRIT, LOG_ERR, LOG_WARNING, LOG_NOTICE, LOG_INFO, LOG_DEBUG };
 		static_assert(sizeof(prio) == (sizeof(int) * UnknownType), "'prio' must map ALL Logger::LogType values to it's equivalent syslog prio");
 		syslog(prio[type], "%s: %s", className.toUtf8().constData(), message.toUtf8().constData());
 	}
+
+	if (targets.testFlag(LogToJournal))
+	{
+		journal.write(type, className.isEmpty() ? QString("unknown") : className, message, fields);
+	}
+}
+
+const QString &Logger::Private::formatTimestamp(qint64 timestamp, qint64 elapsed)
+{
+	if (timestampFormat == Logger::TimestampMonotonic)
+	{
+		stampSecond = -1;
+		stamp = QString("%1.%2").arg(elapsed / 1000, 8).arg(elapsed % 1000, 3, 10, QChar('0'));
+		return stamp;
+	}
+
+	// date/time formatting (incl. time zone conversion) is expensive: do it once per second only
+	const qint64 second = timestamp / 1000;
+	if (second != stampSecond)
+	{
+		stampSecond = second;
+		stamp = QDateTime::fromMSecsSinceEpoch(second * 1000).toString(timestampFormat == Logger::TimestampMillis ?
+		                                                                "yyyy-MM-dd hh:mm:ss.000" : "yyyy-MM-dd hh:mm:ss");
+	}
+	if (timestampFormat == Logger::TimestampMillis)
+	{
+		const int msecs = timestamp % 1000;
+		QChar *digits = stamp.data() + stamp.size() - 3;
+		digits[0] = QChar('0' + msecs / 100);
+		digits[1] = QChar('0' + msecs / 10 % 10);
+		digits[2] = QChar('0' + msecs % 10);
+	}
+	return stamp;
+}
+
+void Logger::Private::startWriter()
+{
+	if (!writer.load())
+	{
+		writerStop.store(false);
+		QThread *thread = QThread::create(&Logger::Private::runWriter, this);
+		thread->setObjectName("LogWriter");
+		QThread *expected = nullptr;
+		if (!writer.compare_exchange_strong(expected, thread))
+		{
+			delete thread; // started by another thread meanwhile
+			return;
+		}
+		thread->start(QThread::LowPriority);
+		async.store(true, std::memory_order_release);
+	}
+}
+
+void Logger::Private::stopWriter()
+{
+	QThread *thread = writer.exchange(nullptr); // only one caller gets the thread (e.g. critical() of two threads, dtor)
+	if (thread)
+	{
+		async.store(false, std::memory_order_release); // from now on messages are written synchronously
+		writerStop.store(true);
+		wakeup.release();
+		thread->wait();
+		delete thread;
+		QMutexLocker lock(&mutex);
+		drain(); // whatever was queued after the writer's last batch
+	}
+}
+
+void Logger::Private::runWriter()
+{
+	for (;;)
+	{
+		const bool stop = writerStop.load();
+		if (!queue.isEmpty())
+		{
+			QMutexLocker lock(&mutex);
+			drain();
+			continue;
+		}
+		if (stop)
+		{
+			break;
+		}
+		writerIdle.store(true);
+		if (queue.isEmpty() && !writerStop.load())
+		{
+			wakeup.tryAcquire(1, LOG_WRITER_IDLE_TIMEOUT);
+		}
+		writerIdle.store(false);
+		wakeup.tryAcquire(wakeup.available()); // discard surplus wakeups
+	}
+}
+
+void Logger::Private::drain()
+{
+	LogQueue::Record record;
+	while (queue.pop(record))
+	{
+		write(record.type, record.className, record.site, record.timestamp, record.elapsed, record.message, record.fields);
+	}
+	const quint64 lost = queue.takeDropped();
+	if (lost > 0)
+	{
+		write(Warning, "Logger", nullptr, QDateTime::currentMSecsSinceEpoch(), clock.elapsed(), QString("%1 log message(s) dropped, queue full").arg(lost),
+		      Logger::Fields());
+	}
+	console.flush(); // once per batch
 }
 
 void Logger::logQtMsg(QtMsgType type, const QString &msg)
@@ -201,13 +455,13 @@ void Logger::logQtMsg(QtMsgType type, const QString &msg)
 	switch (type)
 	{
 		case QtDebugMsg:
-			log("QDebug", Debug, msg);
+			if (isEnabled(Debug)) log("QDebug", Debug, msg);
 			break;
 		case QtWarningMsg:
-			log("QWarning", Warning, msg);
+			if (isEnabled(Warning)) log("QWarning", Warning, msg);
 			break;
 		case QtCriticalMsg:
-			log("QCritical", Error, msg);
+			if (isEnabled(Error)) log("QCritical", Error, msg);
 			break;
 		case QtFatalMsg:
 			log("QFatal", Critical, msg);
@@ -235,6 +489,15 @@ void Logger::setLogTargets(LogTargets targets)
 {
 	Logger *log = instance();
 	QMutexLocker lock(&log->m_d->mutex);
+	if (targets.testFlag(LogToJournal) && !log->m_d->journal.open(QCoreApplication::applicationName().toUtf8()))
+	{
+		targets.setFlag(LogToJournal, false); // not running under systemd, fall back to syslog
+		targets.setFlag(LogToSyslog);
+	}
+	if (!targets.testFlag(LogToJournal))
+	{
+		log->m_d->journal.close();
+	}
 	if (log->m_d->targets.testFlag(LogToSyslog) && !targets.testFlag(LogToSyslog))
 	{
 		closelog();
@@ -271,3 +534,128 @@ Logger::LogType Logger::logLevel()
 	return static_cast<Logger::LogType>(s_maxLevel.loadRelaxed());
 #endif
 }
+
+void Logger::setAsync(bool enabled)
+{
+	Logger *log = instance();
+	if (enabled)
+	{
+		log->m_d->startWriter();
+	} else
+	{
+		log->m_d->stopWriter();
+	}
+}
+
+bool Logger::isAsync()
+{
+	return instance()->m_d->async.load(std::memory_order_relaxed);
+}
+
+quint64 Logger::droppedMessages()
+{
+	return instance()->m_d->dropped.load(std::memory_order_relaxed);
+}
+
+void Logger::setTimestampFormat(TimestampFormat format)
+{
+	Logger *log = instance();
+	QMutexLocker lock(&log->m_d->mutex);
+	log->m_d->timestampFormat = format;
+	log->m_d->stampSecond = -1; // rebuild cached timestamp
+}
+
+Logger::TimestampFormat Logger::timestampFormat()
+{
+	Logger *log = instance();
+	QMutexLocker lock(&log->m_d->mutex);
+	return log->m_d->timestampFormat;
+}
+
+void Logger::setRateLimiting(bool enabled)
+{
+	Logger *log = instance();
+	QMutexLocker lock(&log->m_d->mutex);
+	if (log->m_d->limiting && !enabled)
+	{
+		log->m_d->flushLimiter();
+	}
+	log->m_d->limiting = enabled;
+}
+
+quint64 Logger::suppressedMessages()
+{
+	Logger *log = instance();
+	QMutexLocker lock(&log->m_d->mutex);
+	return log->m_d->limiter.suppressed();
+}
+
+int Logger::category(const QString &name)
+{
+	LogCategories &categories = logCategories();
+	QMutexLocker lock(&categories.mutex);
+	const int id = categories.ids.value(name, 0);
+	if (id > 0)
+	{
+		return id;
+	}
+	if (categories.ids.size() + 1 >= OverflowCategory)
+	{
+		return OverflowCategory; // no more ids left, never share the level of the global instance
+	}
+	categories.ids.insert(name, categories.ids.size() + 1);
+	return categories.ids.size();
+}
+
+void Logger::setLogLevel(const QString &category, LogType max)
+{
+	s_levels[Logger::category(category)].storeRelaxed(max + 1);
+}
+
+void Logger::resetLogLevel(const QString &category)
+{
+	s_levels[Logger::category(category)].storeRelaxed(0);
+}
+
+bool Logger::setLogLevels(const QString &spec)
+{
+	bool ok = true;
+	foreach (const QString &entry, spec.split(',', Qt::SkipEmptyParts))
+	{
+		const qsizetype sep = entry.lastIndexOf('=');
+		const QString name = entry.left(sep).trimmed();
+		const QString value = entry.mid(sep + 1).trimmed();
+		bool levelOk = false;
+		const int level = value.toInt(&levelOk);
+		if (sep <= 0 || name.isEmpty())
+		{
+			ok = false;
+		} else if (value == "default")
+		{
+			resetLogLevel(name);
+		} else if (levelOk && level >= Critical && level <= Debug)
+		{
+			setLogLevel(name, static_cast<LogType>(level));
+		} else
+		{
+			ok = false;
+		}
+	}
+	return ok;
+}
+
+QHash<QString, Logger::LogType> Logger::logLevels()
+{
+	QHash<QString, LogType> levels;
+	LogCategories &categories = logCategories();
+	QMutexLocker lock(&categories.mutex);
+	for (QHash<QString, int>::const_iterator it = categories.ids.constBegin(); it != categories.ids.constEnd(); ++it)
+	{
+		const int level = s_levels[it.value()].loadRelaxed() - 1;
+		if (level >= 0)
+		{
+			levels.insert(it.key(), static_cast<LogType>(level));
+		}
+	}
+	return levels;
+}
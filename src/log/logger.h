@@ -9,12 +9,19 @@
 
 #include <QString>
 #include <QFlags>
+#include <QAtomicInt>
+#include <QHash>
+#include <QVector>
 
 /**
- * @class Logger enables the application to send log messages to standard out (console) and/or Syslog
+ * @class Logger enables the application to send log messages to standard out (console), Syslog and/or the systemd journal
  *        It uses the singleton pattern. However, further Logger-Objects can be instantiated holding
  *        only a class/module-name, allowing the reader to easily identify the origin of a log message.
  *
+ * Messages that are logged frequently (e.g. on every rx/tx message or weather update) should use the
+ *        LOGGER_DEBUG()/LOGGER_INFO()/... macros: they check the log level first and do not evaluate the
+ *        message at all if it would be discarded anyway.
+ *
  * @note This class is not fully thread-safe!!!
  *       The main thread (owning the event queue) must be the first thread to either call @fn instance()
  *       or write a log message. Also @fn destroy() must be called from the main thread only - after all
@@ -34,10 +41,21 @@ public:
 	{
 		LogDisabled  = 0x00, /** Hint: use this to disable the logger */
 		LogToConsole = 0x01,
-		LogToSyslog  = 0x02
+		LogToSyslog  = 0x02,
+		LogToJournal = 0x04  /** native journal protocol, stores category and Fields separately */
 	};
 	Q_DECLARE_FLAGS(LogTargets, LogTarget)
 
+	/**
+	 * Console timestamp format
+	 */
+	enum TimestampFormat
+	{
+		TimestampSeconds = 0, /** yyyy-MM-dd hh:mm:ss (default) */
+		TimestampMillis,      /** yyyy-MM-dd hh:mm:ss.zzz */
+		TimestampMonotonic    /** secs.msecs since start, not affected by clock changes (latency debugging) */
+	};
+
 	/**
 	 * Log message type
 	 */
@@ -52,6 +70,18 @@ public:
 		UnknownType // logger internal use only (this must always be the last entry!)
 	} LogType;
 
+	/**
+	 * Structured data attached to a message, e.g. {LOG_FIELD_STATION_ID, "101"}. Fields are only stored
+	 * by LogToJournal, other targets ignore them. @p name must be a valid journal field name (A-Z, 0-9, '_')
+	 * with static storage, see LOG_FIELD_* in config.h
+	 */
+	struct Field
+	{
+		const char *name;
+		QString value;
+	};
+	typedef QVector<Field> Fields;
+
 	/**
 	 * Returns the global Logger instance.
 	 * @warning Must be called by the main thread first! (e.g. by writing a log message before creating other threads)
@@ -76,6 +106,11 @@ public:
 	 *                  be used in log messages. Do not leave empty!
 	 */
 	Logger(const QString &className);
+
+	/**
+	 * Same as above, but @p fields are attached to every message of this Logger (e.g. the station id)
+	 */
+	Logger(const QString &className, const Fields &fields);
 	virtual ~Logger();
 
 	/**
@@ -116,6 +151,21 @@ public:
 	 */
 	virtual void critical(const QString &message);
 
+	/**
+	 * Logs a message of the given @p type with additional @p fields (see LOGGER_FIELDS())
+	 * @param site call site, string literal (see LOGGER_SITE), identifies repeated warnings/errors (@see LogLimiter)
+	 */
+	void log(LogType type, const QString &message, const Fields &fields, const char *site = nullptr);
+
+	/**
+	 * @returns whether messages of the given @p type are currently logged (cheap, no locking)
+	 */
+	bool isEnabled(LogType type) const
+	{
+		const int max = s_levels[m_category].loadRelaxed() - 1; // -1: no category specific level
+		return type <= (max < 0 ? s_maxLevel.loadRelaxed() : max);
+	}
+
 	/**
 	 * Returns the className the Logger has been instaanciated with
 	 */
@@ -167,17 +217,75 @@ public:
 	 * @returns the current max. log level
 	 */
 	static LogType logLevel();
+
+	/**
+	 * Sets the max. log level of a single category (className), overriding the global log level
+	 * for it. This e.g. allows debug output of a single class. Unknown categories are registered.
+	 */
+	static void setLogLevel(const QString &category, LogType max);
+	static void resetLogLevel(const QString &category); // use global log level again
+
+	/**
+	 * Sets category log levels from @p spec, format: <category>=<level 0..5|default>[,...]
+	 * @returns false if (parts of) @p spec could not be parsed
+	 */
+	static bool setLogLevels(const QString &spec);
+
+	/**
+	 * @returns all categories with a specific log level
+	 */
+	static QHash<QString, LogType> logLevels();
+
+	/**
+	 * Enables/Disables asynchronous logging: messages are queued (lock-free) and written by a background
+	 * thread, so the caller never waits for console or syslog. Critical messages are always written
+	 * synchronously. If the queue is full messages are dropped (and counted).
+	 * @default disabled
+	 * @warning Must only be called from main thread
+	 */
+	static void setAsync(bool enabled);
+	static bool isAsync();
+
+	/**
+	 * @returns number of messages dropped in async mode since start
+	 */
+	static quint64 droppedMessages();
+
+	/**
+	 * Enables/Disables folding of repeated warnings/errors and per category/severity rate limiting of them
+	 * (default: enabled)
+	 * @see LogLimiter
+	 */
+	static void setRateLimiting(bool enabled);
+
+	/**
+	 * Sets the format of console timestamps, @default TimestampSeconds
+	 */
+	static void setTimestampFormat(TimestampFormat format);
+	static TimestampFormat timestampFormat();
+
+	/**
+	 * @returns total number of messages folded or suppressed by rate limiting
+	 */
+	static quint64 suppressedMessages();
 	
 protected:
-	void log(const QString &className, LogType type, const QString &message);
+	void log(const QString &className, LogType type, const QString &message, const Fields &fields = Fields(), const char *site = nullptr);
 	
 private:
+	static const int MaxCategories = 256;
+	static const int OverflowCategory = MaxCategories - 1; // shared by all categories once the ids are taken
+
+	static int category(const QString &name); // interns name, returns category id
 	static Logger *s_instance;
 	static QAtomicInt s_maxLevel;
+	static QAtomicInt s_levels[MaxCategories]; // per category: max. level + 1, 0 = use s_maxLevel
 
 	struct Private;
 	Private *const m_d;
 	QString const m_className;
+	int m_category;
+	Fields const m_fields;
 
 	/**
 	 * Private constructor used by instance()
@@ -187,4 +295,22 @@ private:
 
 Q_DECLARE_OPERATORS_FOR_FLAGS(Logger::LogTargets)
 
+/**
+ * Lazy logging: @p message is only evaluated if @p logger would log messages of this level, e.g.
+ * LOGGER_DEBUG(m_log, QString("Msg received: '%1'").arg(m_buffer));
+ * The call site is passed along, so repeated warnings/errors are folded per call site (see LogLimiter).
+ */
+#define LOGGER_STRINGIFY(x) #x
+#define LOGGER_TOSTRING(x) LOGGER_STRINGIFY(x)
+#define LOGGER_SITE __FILE__ ":" LOGGER_TOSTRING(__LINE__)
+#define LOGGER_LOG(logger, type, message) \
+	do { if ((logger).isEnabled(type)) (logger).log(type, message, Logger::Fields(), LOGGER_SITE); } while (false)
+#define LOGGER_DEBUG(logger, message)   LOGGER_LOG(logger, Logger::Debug, message)
+#define LOGGER_INFO(logger, message)    LOGGER_LOG(logger, Logger::Info, message)
+#define LOGGER_NOTICE(logger, message)  LOGGER_LOG(logger, Logger::Notice, message)
+#define LOGGER_WARNING(logger, message) LOGGER_LOG(logger, Logger::Warning, message)
+#define LOGGER_ERROR(logger, message)   LOGGER_LOG(logger, Logger::Error, message)
+#define LOGGER_FIELDS(logger, type, message, fields) \
+	do { if ((logger).isEnabled(type)) (logger).log(type, message, fields, LOGGER_SITE); } while (false)
+
 #endif // LOGGER_H
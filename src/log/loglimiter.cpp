@@ -0,0 +1,145 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "loglimiter.h"
+#include "config.h"
+
+static const qint64 EXPIRE_CHECK_INTERVAL = 1000; // msecs
+static const qint64 REPEAT_INTERVAL       = LOG_REPEAT_SUMMARY_INTERVAL * 1000LL; // msecs
+
+
+LogLimiter::LogLimiter() :
+    m_repeats(),
+    m_buckets(),
+    m_lastExpire(0),
+    m_suppressed(0)
+{
+}
+
+bool LogLimiter::filter(Logger::LogType type, const QString &category, const char *site, const QString &message, qint64 now,
+                        Summaries &summaries)
+{
+	if (now - m_lastExpire >= EXPIRE_CHECK_INTERVAL)
+	{
+		m_lastExpire = now;
+		expire(now, summaries);
+	}
+	if (type == Logger::Critical)
+	{
+		flush(summaries); // last words, make sure nothing is lost
+		return true;
+	}
+	if (type != Logger::Warning && type != Logger::Error)
+	{
+		return true; // regular output (e.g. per frame or per update) is never folded or suppressed
+	}
+	const Site key{category, site, site ? QString() : message};
+	return fold(type, key, message, now, summaries) && limit(type, category, now, summaries);
+}
+
+void LogLimiter::flush(Summaries &summaries)
+{
+	for (QHash<Site, Repeat>::iterator it = m_repeats.begin(); it != m_repeats.end(); ++it)
+	{
+		if (it->count > 0)
+		{
+			summaries << repeated(it.key(), it.value());
+		}
+	}
+}
+
+bool LogLimiter::fold(Logger::LogType type, const Site &key, const QString &message, qint64 now, Summaries &summaries)
+{
+	QHash<Site, Repeat>::iterator it = m_repeats.find(key);
+	if (it == m_repeats.end())
+	{
+		m_repeats.insert(key, Repeat{type, QString(), 0, now});
+		return true;
+	}
+	if (now - it->written < REPEAT_INTERVAL)
+	{
+		it->type = type;
+		it->message = message;
+		it->count++;
+		m_suppressed++;
+		return false;
+	}
+	if (it->count > 0)
+	{
+		summaries << repeated(key, it.value());
+	}
+	it->written = now;
+	return true;
+}
+
+bool LogLimiter::limit(Logger::LogType type, const QString &category, qint64 now, Summaries &summaries)
+{
+	const QPair<QString, int> key(category, static_cast<int>(type));
+	QHash<QPair<QString, int>, Bucket>::iterator it = m_buckets.find(key);
+	if (it == m_buckets.end())
+	{
+		it = m_buckets.insert(key, Bucket{static_cast<double>(LOG_RATE_LIMIT_BURST), now, 0});
+	}
+	Bucket &bucket = it.value();
+	refill(bucket, now);
+	if (bucket.tokens < 1.0)
+	{
+		bucket.suppressed++;
+		m_suppressed++;
+		return false;
+	}
+	bucket.tokens -= 1.0;
+	if (bucket.suppressed > 0)
+	{
+		summaries << Summary{type, category, QString("%1 message(s) suppressed (rate limit)").arg(bucket.suppressed)};
+		bucket.suppressed = 0;
+	}
+	return true;
+}
+
+void LogLimiter::refill(Bucket &bucket, qint64 now)
+{
+	bucket.tokens = qMin<double>(LOG_RATE_LIMIT_BURST, bucket.tokens + qMax<qint64>(0, now - bucket.updated) * LOG_RATE_LIMIT_PER_MIN / 60000.0);
+	bucket.updated = now;
+}
+
+void LogLimiter::expire(qint64 now, Summaries &summaries)
+{
+	// pending summaries are reported without waiting for the next message of the same call site
+	for (QHash<Site, Repeat>::iterator it = m_repeats.begin(); it != m_repeats.end(); )
+	{
+		if (now - it->written < REPEAT_INTERVAL)
+		{
+			++it;
+			continue;
+		}
+		if (it->count > 0)
+		{
+			summaries << repeated(it.key(), it.value());
+		}
+		it = m_repeats.erase(it); // next message of the call site is written right away
+	}
+	for (QHash<QPair<QString, int>, Bucket>::iterator it = m_buckets.begin(); it != m_buckets.end(); ++it)
+	{
+		if (it->suppressed > 0)
+		{
+			refill(it.value(), now);
+			if (it->tokens >= 1.0)
+			{
+				summaries << Summary{static_cast<Logger::LogType>(it.key().second), it.key().first,
+				                     QString("%1 message(s) suppressed (rate limit)").arg(it->suppressed)};
+				it->suppressed = 0;
+			}
+		}
+	}
+}
+
+LogLimiter::Summary LogLimiter::repeated(const Site &key, Repeat &repeat)
+{
+	const Summary summary{repeat.type, key.category, QString("message repeated %1 times, last: %2").arg(repeat.count).arg(repeat.message)};
+	repeat.count = 0;
+	return summary;
+}
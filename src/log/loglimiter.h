@@ -0,0 +1,89 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef LOGLIMITER_H
+#define LOGLIMITER_H
+
+#include <QHash>
+#include <QPair>
+#include <QString>
+#include <QVector>
+#include "logger.h"
+
+/**
+ * @class LogLimiter keeps repeating warnings and errors (e.g. a warning on every update cycle during an
+ *        outage) from flooding the log:
+ *        - messages are identified by category and call site (see LOGGER_WARNING()), or by category and
+ *          text if logged without a call site. Once a message was written, further ones of the same call
+ *          site are folded for LOG_REPEAT_SUMMARY_INTERVAL and then reported as "message repeated N times"
+ *        - each category and severity has a token bucket, messages exceeding it are suppressed and
+ *          reported as "N message(s) suppressed" once the bucket has refilled
+ *        Info, notice and debug messages are passed unchanged, critical messages flush the pending
+ *        reports. Lookups are O(1) (call sites are hashed by address).
+ * @note not thread-safe, Logger calls it with its mutex locked
+ */
+class LogLimiter
+{
+public:
+	struct Summary // to be logged before the current message
+	{
+		Logger::LogType type;
+		QString category;
+		QString message;
+	};
+	typedef QVector<Summary> Summaries;
+
+	LogLimiter();
+
+	/**
+	 * @returns whether the message should be written, @p summaries receives pending reports to write first
+	 * @param site call site (string literal, e.g. "file.cpp:42"), nullptr: the message is identified by its text
+	 * @param now monotonic msecs (wall clock steps must not silence categories)
+	 */
+	bool filter(Logger::LogType type, const QString &category, const char *site, const QString &message, qint64 now,
+	            Summaries &summaries);
+	void flush(Summaries &summaries); // reports all pending repetitions (e.g. on shutdown)
+
+	quint64 suppressed() const { return m_suppressed; }
+
+private:
+	struct Site
+	{
+		QString category;
+		const char *site;
+		QString message; // only if logged without a call site
+
+		bool operator==(const Site &other) const { return site == other.site && category == other.category && message == other.message; }
+		friend size_t qHash(const Site &key, size_t seed = 0) { return qHashMulti(seed, key.category, reinterpret_cast<quintptr>(key.site), key.message); }
+	};
+
+	struct Repeat
+	{
+		Logger::LogType type;
+		QString message; // latest folded message
+		int count;
+		qint64 written;  // last message that was not folded
+	};
+	struct Bucket
+	{
+		double tokens;
+		qint64 updated;
+		int suppressed;
+	};
+
+	bool fold(Logger::LogType type, const Site &key, const QString &message, qint64 now, Summaries &summaries);
+	bool limit(Logger::LogType type, const QString &category, qint64 now, Summaries &summaries);
+	void expire(qint64 now, Summaries &summaries);
+	static void refill(Bucket &bucket, qint64 now);
+	static Summary repeated(const Site &key, Repeat &repeat);
+
+	QHash<Site, Repeat> m_repeats;                // per category and call site
+	QHash<QPair<QString, int>, Bucket> m_buckets; // per category and severity
+	qint64 m_lastExpire;
+	quint64 m_suppressed;
+};
+
+#endif // LOGLIMITER_H
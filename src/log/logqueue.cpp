@@ -0,0 +1,77 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "logqueue.h"
+
+LogQueue::LogQueue(int capacity) :
+    m_slots(),
+    m_mask(0),
+    m_tail(0),
+    m_head(0),
+    m_dropped(0)
+{
+	size_t size = 2;
+	while (size < static_cast<size_t>(qMax(2, capacity)))
+	{
+		size <<= 1;
+	}
+	m_mask = size - 1;
+	m_slots.reset(new Slot[size]);
+	for (size_t i = 0; i < size; i++)
+	{
+		m_slots[i].sequence.store(i, std::memory_order_relaxed);
+	}
+}
+
+bool LogQueue::push(Record &&record)
+{
+	size_t pos = m_tail.load(std::memory_order_relaxed);
+	Slot *slot;
+	for (;;)
+	{
+		slot = &m_slots[pos & m_mask];
+		const size_t seq = slot->sequence.load(std::memory_order_acquire);
+		const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+		if (diff == 0) // slot is free, try to claim it
+		{
+			if (m_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+			{
+				break;
+			}
+		} else if (diff < 0) // consumer has not yet released this slot: full
+		{
+			m_dropped.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		} else // another producer was faster
+		{
+			pos = m_tail.load(std::memory_order_relaxed);
+		}
+	}
+	slot->record = std::move(record);
+	slot->sequence.store(pos + 1, std::memory_order_release); // publish to consumer
+	return true;
+}
+
+bool LogQueue::pop(Record &record)
+{
+	Slot *slot = &m_slots[m_head & m_mask];
+	if (slot->sequence.load(std::memory_order_acquire) != m_head + 1)
+	{
+		return false; // empty (or producer still writing)
+	}
+	record = std::move(slot->record);
+	slot->record.className.clear();
+	slot->record.message.clear();
+	slot->record.fields.clear();
+	slot->sequence.store(m_head + m_mask + 1, std::memory_order_release); // release slot to producers
+	m_head++;
+	return true;
+}
+
+bool LogQueue::isEmpty() const
+{
+	return m_slots[m_head & m_mask].sequence.load(std::memory_order_acquire) != m_head + 1;
+}
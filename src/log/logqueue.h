@@ -0,0 +1,57 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef LOGQUEUE_H
+#define LOGQUEUE_H
+
+#include <QString>
+#include <atomic>
+#include <memory>
+#include "logger.h"
+
+/**
+ * @class LogQueue is a bounded lock-free multi producer/single consumer ring buffer for log records
+ * (each slot carries a sequence number, see D. Vyukov's bounded MPMC queue). Producers never block:
+ * if the ring is full the record is dropped and counted.
+ */
+class LogQueue
+{
+public:
+	struct Record
+	{
+		Logger::LogType type;
+		QString className;
+		const char *site = nullptr; // call site (string literal)
+		qint64 timestamp; // msecs since epoch
+		qint64 elapsed;   // msecs since the logger was created (monotonic)
+		QString message;
+		Logger::Fields fields;
+	};
+
+	explicit LogQueue(int capacity); // rounded up to a power of 2
+	~LogQueue() = default;
+
+	bool push(Record &&record); // any thread, returns false if the queue is full
+	bool pop(Record &record);   // consumer thread only
+	bool isEmpty() const;       // consumer thread only
+
+	quint64 takeDropped() { return m_dropped.exchange(0, std::memory_order_relaxed); }
+
+private:
+	struct Slot
+	{
+		std::atomic<size_t> sequence;
+		Record record;
+	};
+
+	std::unique_ptr<Slot[]> m_slots;
+	size_t m_mask;
+	alignas(64) std::atomic<size_t> m_tail; // next slot to be written by producers
+	alignas(64) size_t m_head;              // next slot to be read by the consumer
+	std::atomic<quint64> m_dropped;
+};
+
+#endif // LOGQUEUE_H
@@ -5,50 +5,91 @@
  */
 
 #include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
 #include <signal.h>
 #include <sys/stat.h>
 #include <sys/types.h>
-#include <QMetaObject>
 #include "application.h"
+#include "startupprofiler.h"
 #include "logger.h"
+#include "config.h"
 
-void sig_handler(int signal)
+static Logger s_log("main");
+static int s_readyPipe = -1; // daemon: write end, see notifyReady()
+static int s_signalPipe[2] = {-1, -1}; // self-pipe: signals are handled by Application::onSignal()
+
+static bool waitReady(int fd) // parent: returns once the daemon is up
 {
-	switch (signal)
+	struct pollfd pfd = {fd, POLLIN, 0};
+	char ready = 0;
+	return poll(&pfd, 1, DAEMON_READY_TIMEOUT) > 0 && read(fd, &ready, 1) == 1; // EOF: daemon died
+}
+
+static void notifyReady()
+{
+	if (s_readyPipe >= 0)
 	{
-		case SIGINT:
-			Logger("main").info("Received SIGINT, shutting down...");
-			break;
-		case SIGTERM:
-			Logger("main").info("Received SIGTERM, shutting down...");
-			break;
-		default:
-			return;
+		const char ready = 1;
+		if (write(s_readyPipe, &ready, 1) != 1)
+		{
+			LOGGER_WARNING(s_log, "failed to notify parent process");
+		}
+		close(s_readyPipe);
+		s_readyPipe = -1;
 	}
-	QMetaObject::invokeMethod(qApp, "quit", Qt::QueuedConnection);
+}
+
+void sig_handler(int signal)
+{
+	// async-signal-safe only: no logging, no allocation, no Qt
+	const int savedErrno = errno;
+	const char sig = static_cast<char>(signal);
+	const ssize_t written = write(s_signalPipe[1], &sig, 1); // fails if the pipe is full: signals are pending anyway
+	Q_UNUSED(written)
+	errno = savedErrno;
 }
 
 int main(int argc, char *argv[])
 {
+	StartupProfiler::start();
 	for (int i = 0; i < argc; i++) // need to parse 'daemon' argument manually, as Application object cannot be created yet :(
 	{
 		const QString arg(argv[i]);
 		if (arg == "-d" || arg == "--daemon") // fork to background (demonize)?
 		{
+			int readyPipe[2];
+			if (pipe(readyPipe) != 0)
+			{
+				return EXIT_FAILURE;
+			}
 			pid_t pid = fork();
 			if (pid < 0)
 			{
 				return EXIT_FAILURE;
 			}
-			if (pid != 0)             // terminate the parent process
+			if (pid != 0)             // terminate the parent process...
 			{
-				sleep(1);             // keep process running until child has written pid-file (fixes synchronisation issue with systemd)
-				return EXIT_SUCCESS;
+				close(readyPipe[1]);  // ...once the daemon has written its pid-file (synchronisation with systemd)
+				return waitReady(readyPipe[0]) ? EXIT_SUCCESS : EXIT_FAILURE;
 			}
+			close(readyPipe[0]);
+			s_readyPipe = readyPipe[1];
 			setsid();                 // make the process a group leader, session leader, and lose control tty
-			close(STDIN_FILENO);
-			close(STDOUT_FILENO);
-			close(STDERR_FILENO);
+			// detach stdin/out/err, but keep fds 0-2 occupied (otherwise the signal pipe would get them)
+			const int devNull = open("/dev/null", O_RDWR);
+			if (devNull < 0)
+			{
+				return EXIT_FAILURE;
+			}
+			dup2(devNull, STDIN_FILENO);
+			dup2(devNull, STDOUT_FILENO);
+			dup2(devNull, STDERR_FILENO);
+			if (devNull > STDERR_FILENO)
+			{
+				close(devNull);
+			}
 			signal(SIGHUP, SIG_IGN);  // ignore sighup (which is send to child when it's parent terminates)
 			umask(0);                 // loose file creation mode mask inherited by parent
 			if ((pid = fork()) < 0)   // fork again, to make sure the process can't reaquire a terminal
@@ -60,13 +101,22 @@ int main(int argc, char *argv[])
 		}
 	}
 
+	if (pipe2(s_signalPipe, O_CLOEXEC | O_NONBLOCK) != 0)
+	{
+		qFatal("Failed to create signal pipe, shutting down...");
+		return 1;
+	}
 	if (signal(SIGINT, sig_handler) == SIG_ERR || signal(SIGTERM, sig_handler) == SIG_ERR)
 	{
 		qFatal("Failed to register signal handler for SIGINT/SIGTERM, shutting down...");
 		return 1;
 	}
+	signal(SIGHUP, sig_handler); // reload config (daemon: ignored until now, see above)
 
 	Application app(argc, argv);
+	app.watchSignals(s_signalPipe[0]); // signals received so far are waiting in the pipe
+	StartupProfiler::mark("daemon ready");
+	notifyReady();
 	return app.exec();
 }
 
@@ -0,0 +1,232 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "metrics.h"
+#include "logger.h"
+#include "fanet/fanetpayload.h"
+#include "fanet/fanetradio.h"
+#include "weatherstation/fetchscheduler.h"
+
+#include <QDateTime>
+#include <QMutexLocker>
+
+static const qint64 LATENCY_BUCKETS[Metrics::LatencyBuckets] = {50, 100, 250, 500, 1000, 2500, 5000, 10000, 15000, 30000}; // msecs
+static const char   REPLY_NAMES[Metrics::ReplyCount][6]      = {"ok", "ack", "nack", "error"};
+static const FanetRadio::RadioState RADIO_STATES[] = {FanetRadio::RadioDisabled, FanetRadio::RadioResetting, FanetRadio::RadioInitializing,
+                                                      FanetRadio::RadioReady, FanetRadio::RadioError, FanetRadio::RadioDevNotFound,
+                                                      FanetRadio::RadioDevOpenFail, FanetRadio::RadioInitTimeout, FanetRadio::RadioComTimeout,
+                                                      FanetRadio::RadioWrongFw};
+
+static QByteArray label(const QString &value) // escaped label value
+{
+	QByteArray escaped = value.toUtf8();
+	escaped.replace('\\', "\\\\").replace('"', "\\\"").replace('\n', "\\n");
+	return escaped;
+}
+
+static void header(QByteArray &out, const char *name, const char *type, const char *help)
+{
+	out.append("# HELP ").append(name).append(' ').append(help).append('\n');
+	out.append("# TYPE ").append(name).append(' ').append(type).append('\n');
+}
+
+static void frames(QByteArray &out, const char *name, const std::atomic<quint64> *counters) // per payload type
+{
+	for (int i = 0; i <= Metrics::PayloadTypes; i++)
+	{
+		const quint64 count = counters[i].load(std::memory_order_relaxed);
+		if (count > 0)
+		{
+			out.append(name).append("{type=\"")
+			   .append(i < Metrics::PayloadTypes ? label(FanetPayload::payloadTypeStr(static_cast<FanetPayload::PayloadType>(i))) : QByteArray("other"))
+			   .append("\"} ").append(QByteArray::number(count)).append('\n');
+		}
+	}
+}
+
+static QByteArray seconds(qint64 msecs)
+{
+	return QByteArray::number(msecs / 1000.0, 'g', 10);
+}
+
+
+void Metrics::Station::polled(qint64 latencyMsecs, bool success)
+{
+	int bucket = 0;
+	while (bucket < LatencyBuckets && latencyMsecs > LATENCY_BUCKETS[bucket])
+	{
+		bucket++;
+	}
+	latency[bucket].fetch_add(1, std::memory_order_relaxed);
+	latencySum.fetch_add(latencyMsecs, std::memory_order_relaxed);
+	polls.fetch_add(1, std::memory_order_relaxed);
+	if (!success)
+	{
+		failures.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+Metrics &Metrics::instance()
+{
+	static Metrics metrics;
+	return metrics;
+}
+
+Metrics::Metrics() :
+    m_rxFrames(),
+    m_txFrames(),
+    m_parseFailures(0),
+    m_replies(),
+    m_radioStates(),
+    m_trafficSubscribers(0),
+    m_trafficDropped(0),
+    m_startupTime(-1),
+    m_mutex(),
+    m_stations()
+{
+}
+
+Metrics::~Metrics()
+{
+	qDeleteAll(m_stations);
+	m_stations.clear();
+}
+
+Metrics::Station *Metrics::addStation(int type, int id, const QString &provider)
+{
+	QMutexLocker lock(&m_mutex);
+	const quint64 key = stationKey(type, id);
+	Station *station = m_stations.value(key, nullptr);
+	if (!station)
+	{
+		station = new Station(); // value-initialized: all counters 0
+		station->type = type;
+		station->id = id;
+		station->provider = provider;
+		m_stations.insert(key, station);
+	}
+	station->refs++;
+	return station;
+}
+
+void Metrics::removeStation(Station *station)
+{
+	QMutexLocker lock(&m_mutex);
+	if (station && --station->refs <= 0)
+	{
+		m_stations.remove(stationKey(station->type, station->id));
+		delete station;
+	}
+}
+
+QByteArray Metrics::render() const
+{
+	QByteArray out;
+	out.reserve(8192);
+
+	header(out, "fags_fanet_rx_frames_total", "counter", "Fanet frames received by payload type");
+	frames(out, "fags_fanet_rx_frames_total", m_rxFrames);
+	header(out, "fags_fanet_tx_frames_total", "counter", "Fanet frames sent by payload type");
+	frames(out, "fags_fanet_tx_frames_total", m_txFrames);
+
+	header(out, "fags_fanet_parse_failures_total", "counter", "Messages from the radio that could not be parsed");
+	out.append("fags_fanet_parse_failures_total ").append(QByteArray::number(m_parseFailures.load(std::memory_order_relaxed))).append('\n');
+
+	header(out, "fags_fanet_replies_total", "counter", "Command replies (FNR) of the radio");
+	for (int i = 0; i < ReplyCount; i++)
+	{
+		out.append("fags_fanet_replies_total{reply=\"").append(REPLY_NAMES[i]).append("\"} ")
+		   .append(QByteArray::number(m_replies[i].load(std::memory_order_relaxed))).append('\n');
+	}
+
+	header(out, "fags_radio_state_transitions_total", "counter", "Radio state changes by new state");
+	for (FanetRadio::RadioState state : RADIO_STATES)
+	{
+		out.append("fags_radio_state_transitions_total{state=\"").append(label(FanetRadio::radioStateStr(state))).append("\"} ")
+		   .append(QByteArray::number(m_radioStates[radioStateIndex(state)].load(std::memory_order_relaxed))).append('\n');
+	}
+
+	header(out, "fags_traffic_subscribers", "gauge", "Clients connected to the traffic stream");
+	out.append("fags_traffic_subscribers ").append(QByteArray::number(m_trafficSubscribers.load(std::memory_order_relaxed))).append('\n');
+	header(out, "fags_traffic_dropped_total", "counter", "Traffic records dropped for slow subscribers");
+	out.append("fags_traffic_dropped_total ").append(QByteArray::number(m_trafficDropped.load(std::memory_order_relaxed))).append('\n');
+
+	const qint64 startupTime = m_startupTime.load(std::memory_order_relaxed);
+	if (startupTime >= 0)
+	{
+		header(out, "fags_startup_first_broadcast_seconds", "gauge", "Time from process start to the first weather broadcast");
+		out.append("fags_startup_first_broadcast_seconds ").append(seconds(startupTime)).append('\n');
+	}
+
+	// samples of a metric must not be interleaved with other metrics: one buffer per metric
+	const qint64 now = QDateTime::currentMSecsSinceEpoch();
+	QByteArray polls, failures, latency, age;
+	QMutexLocker lock(&m_mutex); // stations must not be removed while rendering
+	foreach (const Station *station, m_stations)
+	{
+		QByteArray labels = QByteArray("station=\"").append(QByteArray::number(station->id)).append('"');
+		if (!station->provider.isEmpty())
+		{
+			labels.append(",provider=\"").append(label(station->provider)).append('"');
+		}
+		polls.append("fags_station_polls_total{").append(labels).append("} ")
+		     .append(QByteArray::number(station->polls.load(std::memory_order_relaxed))).append('\n');
+		failures.append("fags_station_poll_failures_total{").append(labels).append("} ")
+		        .append(QByteArray::number(station->failures.load(std::memory_order_relaxed))).append('\n');
+		quint64 cumulative = 0;
+		for (int i = 0; i <= LatencyBuckets; i++)
+		{
+			cumulative += station->latency[i].load(std::memory_order_relaxed);
+			latency.append("fags_station_poll_latency_seconds_bucket{").append(labels).append(",le=\"")
+			       .append(i < LatencyBuckets ? seconds(LATENCY_BUCKETS[i]) : QByteArray("+Inf")).append("\"} ")
+			       .append(QByteArray::number(cumulative)).append('\n');
+		}
+		latency.append("fags_station_poll_latency_seconds_sum{").append(labels).append("} ")
+		       .append(seconds(station->latencySum.load(std::memory_order_relaxed))).append('\n');
+		latency.append("fags_station_poll_latency_seconds_count{").append(labels).append("} ").append(QByteArray::number(cumulative)).append('\n');
+		const qint64 lastUpdate = station->lastUpdate.load(std::memory_order_relaxed);
+		if (lastUpdate > 0)
+		{
+			age.append("fags_station_data_age_seconds{").append(labels).append("} ").append(seconds(qMax<qint64>(0, now - lastUpdate))).append('\n');
+		}
+	}
+	lock.unlock();
+	header(out, "fags_station_polls_total", "counter", "Weather station updates (polls)");
+	out.append(polls);
+	header(out, "fags_station_poll_failures_total", "counter", "Failed weather station updates");
+	out.append(failures);
+	header(out, "fags_station_poll_latency_seconds", "histogram", "Time from starting an update until it finished");
+	out.append(latency);
+	header(out, "fags_station_data_age_seconds", "gauge", "Age of the station's latest weather data");
+	out.append(age);
+
+	const FetchScheduler *scheduler = FetchScheduler::instance(); // lives in the main thread, like the metrics server
+	if (scheduler)
+	{
+		QByteArray wait, waitMax, queued;
+		foreach (const QString &provider, scheduler->providers())
+		{
+			const FetchScheduler::ProviderStats stats = scheduler->stats(provider);
+			const QByteArray labels = QByteArray("{provider=\"").append(label(provider)).append("\"} ");
+			wait.append("fags_fetch_queue_wait_seconds_sum").append(labels).append(seconds(stats.waitTotal)).append('\n');
+			wait.append("fags_fetch_queue_wait_seconds_count").append(labels).append(QByteArray::number(stats.requests)).append('\n');
+			waitMax.append("fags_fetch_queue_wait_max_seconds").append(labels).append(seconds(stats.waitMax)).append('\n');
+			queued.append("fags_fetch_queued_requests").append(labels).append(QByteArray::number(stats.queued)).append('\n');
+		}
+		header(out, "fags_fetch_queue_wait_seconds", "summary", "Time requests waited in the provider's fetch queue (count: requests started)");
+		out.append(wait);
+		header(out, "fags_fetch_queue_wait_max_seconds", "gauge", "Longest time a request waited in the provider's fetch queue");
+		out.append(waitMax);
+		header(out, "fags_fetch_queued_requests", "gauge", "Requests currently waiting in the provider's fetch queue");
+		out.append(queued);
+	}
+
+	header(out, "fags_log_dropped_total", "counter", "Log messages dropped (async logging, queue full)");
+	out.append("fags_log_dropped_total ").append(QByteArray::number(Logger::droppedMessages())).append('\n');
+	header(out, "fags_log_suppressed_total", "counter", "Log messages folded or suppressed by rate limiting");
+	out.append("fags_log_suppressed_total ").append(QByteArray::number(Logger::suppressedMessages())).append('\n');
+	return out;
+}
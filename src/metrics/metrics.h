@@ -0,0 +1,90 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <atomic>
+
+/**
+ * @class Metrics holds the daemon's counters, rendered in Prometheus' text format (see MetricsServer).
+ *        All counters are lock-free atomics and may be updated from any thread. Only (un-)registering
+ *        a station takes a lock, the returned Station stays valid until it is removed again.
+ */
+class Metrics
+{
+public:
+	enum Reply // FNR replies of the radio
+	{
+		ReplyOk = 0,
+		ReplyAck,
+		ReplyNack,
+		ReplyError,
+		ReplyCount
+	};
+
+	static const int PayloadTypes   = 16; // fanet payload types 0x00..0x0f, others are counted as 'other'
+	static const int RadioStates    = 16; // see index()
+	static const int LatencyBuckets = 10; // see LATENCY_BUCKETS in metrics.cpp
+
+	struct Station
+	{
+		int type;   // StationConfig::StationType
+		int id;
+		QString provider;
+		int refs;   // registrations, guarded by Metrics' mutex
+		std::atomic<quint64> polls;
+		std::atomic<quint64> failures;
+		std::atomic<quint64> latency[LatencyBuckets + 1]; // per bucket (not cumulative), last one: +Inf
+		std::atomic<qint64> latencySum;                   // msecs
+		std::atomic<qint64> lastUpdate;                   // of the latest data, msecs since epoch (0 = none)
+
+		void polled(qint64 latencyMsecs, bool success);
+		void dataUpdated(qint64 timestamp) { lastUpdate.store(timestamp, std::memory_order_relaxed); }
+	};
+
+	static Metrics &instance();
+	~Metrics();
+
+	void frameReceived(int payloadType) { m_rxFrames[payloadIndex(payloadType)].fetch_add(1, std::memory_order_relaxed); }
+	void frameSent(int payloadType) { m_txFrames[payloadIndex(payloadType)].fetch_add(1, std::memory_order_relaxed); }
+	void parseFailure() { m_parseFailures.fetch_add(1, std::memory_order_relaxed); }
+	void reply(Reply reply) { m_replies[reply].fetch_add(1, std::memory_order_relaxed); }
+	void radioStateChanged(int state) { m_radioStates[radioStateIndex(state)].fetch_add(1, std::memory_order_relaxed); }
+	void setTrafficSubscribers(int count) { m_trafficSubscribers.store(count, std::memory_order_relaxed); }
+	void trafficDropped() { m_trafficDropped.fetch_add(1, std::memory_order_relaxed); }
+	void setStartupTime(qint64 msecs) { m_startupTime.store(msecs, std::memory_order_relaxed); } // until the first broadcast
+
+	Station *addStation(int type, int id, const QString &provider = QString()); // shared by stations of the same type and id
+	void removeStation(Station *station); // its samples are no longer rendered once the last user is gone
+
+	QByteArray render() const; // text exposition format 0.0.4
+
+private:
+	Metrics();
+	Q_DISABLE_COPY(Metrics)
+
+	static int payloadIndex(int type) { return (type >= 0 && type < PayloadTypes) ? type : PayloadTypes; }
+	static int radioStateIndex(int state) { return ((state & 0x80) ? 8 : 0) + (state & 0x07); } // FanetRadio::RadioState
+	static quint64 stationKey(int type, int id) { return (static_cast<quint64>(static_cast<quint32>(type)) << 32) | static_cast<quint32>(id); }
+
+	std::atomic<quint64> m_rxFrames[PayloadTypes + 1];
+	std::atomic<quint64> m_txFrames[PayloadTypes + 1];
+	std::atomic<quint64> m_parseFailures;
+	std::atomic<quint64> m_replies[ReplyCount];
+	std::atomic<quint64> m_radioStates[RadioStates];
+	std::atomic<int> m_trafficSubscribers;
+	std::atomic<quint64> m_trafficDropped;
+	std::atomic<qint64> m_startupTime;
+	mutable QMutex m_mutex; // guards m_stations (the registry, not the counters)
+	QHash<quint64, Station*> m_stations; // by stationKey()
+};
+
+#endif // METRICS_H
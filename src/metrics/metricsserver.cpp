@@ -0,0 +1,88 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "metricsserver.h"
+#include "metrics.h"
+#include "config.h"
+
+#include <QIODevice>
+#include <QTimer>
+
+static const char CONTENT_TYPE[] = "text/plain; version=0.0.4; charset=utf-8";
+static const char PATH[]         = "/metrics";
+
+
+MetricsServer::MetricsServer(const ListenConfig &config, QObject *parent) :
+    ListenServer("MetricsServer", config, "serving metrics", parent)
+{
+}
+
+MetricsServer::~MetricsServer()
+{
+}
+
+bool MetricsServer::acceptClient(QIODevice *client)
+{
+	QTimer *timeout = new QTimer(client);
+	timeout->setSingleShot(true);
+	connect(timeout, &QTimer::timeout, this, &MetricsServer::onTimeout);
+	timeout->start(METRICS_CLIENT_TIMEOUT);
+	connect(client, &QIODevice::readyRead, this, &MetricsServer::onReadyRead);
+	return true;
+}
+
+void MetricsServer::onReadyRead()
+{
+	QIODevice *client = qobject_cast<QIODevice*>(sender());
+	if (!client)
+	{
+		return;
+	}
+	const QByteArray data = client->peek(METRICS_REQUEST_SIZE_MAX);
+	if (!data.contains("\r\n\r\n") && !data.contains("\n\n"))
+	{
+		if (data.size() >= METRICS_REQUEST_SIZE_MAX)
+		{
+			reply(client, "431 Request Header Fields Too Large", QByteArray());
+		}
+		return; // wait for the complete request header
+	}
+
+	const QList<QByteArray> request = data.left(data.indexOf('\n')).trimmed().split(' '); // e.g. "GET /metrics HTTP/1.1"
+	if (request.size() < 2 || request.at(0) != "GET")
+	{
+		reply(client, "405 Method Not Allowed", QByteArray());
+	} else if (request.at(1) != PATH && !request.at(1).startsWith(QByteArray(PATH).append('?')))
+	{
+		reply(client, "404 Not Found", QByteArray());
+	} else
+	{
+		reply(client, "200 OK", Metrics::instance().render());
+	}
+}
+
+void MetricsServer::onTimeout()
+{
+	QIODevice *client = qobject_cast<QIODevice*>(sender() ? sender()->parent() : nullptr);
+	if (client)
+	{
+		client->disconnect(this);
+		closeClient(client);
+	}
+}
+
+void MetricsServer::reply(QIODevice *client, const QByteArray &status, const QByteArray &body)
+{
+	client->disconnect(this); // one request per connection
+	QByteArray header("HTTP/1.0 ");
+	header.append(status).append("\r\n");
+	header.append("Content-Type: ").append(CONTENT_TYPE).append("\r\n");
+	header.append("Content-Length: ").append(QByteArray::number(body.size())).append("\r\n");
+	header.append("Connection: close\r\n\r\n");
+	client->write(header);
+	client->write(body);
+	closeClient(client);
+}
@@ -0,0 +1,34 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef METRICSSERVER_H
+#define METRICSSERVER_H
+
+#include "listenserver.h"
+
+/**
+ * @class MetricsServer answers 'GET /metrics' with Metrics::render() (minimal http/1.0, one request
+ *        per connection) on a local tcp port or a unix socket, see ListenConfig.
+ */
+class MetricsServer : public ListenServer
+{
+	Q_OBJECT
+public:
+	explicit MetricsServer(const ListenConfig &config, QObject *parent = nullptr);
+	virtual ~MetricsServer() Q_DECL_OVERRIDE;
+
+protected:
+	virtual bool acceptClient(QIODevice *client) Q_DECL_OVERRIDE;
+
+private slots:
+	void onReadyRead();
+	void onTimeout();
+
+private:
+	void reply(QIODevice *client, const QByteArray &status, const QByteArray &body);
+};
+
+#endif // METRICSSERVER_H
@@ -0,0 +1,456 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "mqttclient.h"
+#include "config.h"
+
+#include <QCoreApplication>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QHash>
+
+static const quint8 MQTT_CONNECT          = 0x10;
+static const quint8 MQTT_CONNACK          = 0x20;
+static const quint8 MQTT_PUBLISH          = 0x30;
+static const quint8 MQTT_PUBACK           = 0x40;
+static const quint8 MQTT_SUBSCRIBE        = 0x82; // reserved flags must be 0010
+static const quint8 MQTT_SUBACK           = 0x90;
+static const quint8 MQTT_UNSUBSCRIBE      = 0xA2; // reserved flags must be 0010
+static const quint8 MQTT_UNSUBACK         = 0xB0;
+static const quint8 MQTT_PINGREQ          = 0xC0;
+static const quint8 MQTT_PINGRESP         = 0xD0;
+static const quint8 MQTT_DISCONNECT       = 0xE0;
+static const quint8 MQTT_TYPE_MASK        = 0xF0;
+
+static const char   MQTT_PROTOCOL_NAME[]  = "MQTT";
+static const quint8 MQTT_PROTOCOL_LEVEL   = 0x04; // 3.1.1
+static const quint8 MQTT_FLAG_CLEAN       = 0x02;
+static const quint8 MQTT_FLAG_PASSWORD    = 0x40;
+static const quint8 MQTT_FLAG_USERNAME    = 0x80;
+static const quint8 MQTT_QOS_MASK         = 0x06;
+
+static const int    MQTT_KEEPALIVE_SECS   = 60;
+static const int    MQTT_PACKET_SIZE_MAX  = 64 * 1024; // we only expect small sensor payloads
+static const int    RECONNECT_DELAY_MIN   = 5 * 1000;
+static const int    RECONNECT_DELAY_MAX   = 5 * 60 * 1000;
+
+
+static QHash<QString, MqttClient*> &clients()
+{
+	static QHash<QString, MqttClient*> s_clients;
+	return s_clients;
+}
+
+MqttClient *MqttClient::acquire(const QString &host, quint16 port, const QString &username, const QString &password)
+{
+	MqttClient *client = clients().value(key(host, port, username));
+	if (!client)
+	{
+		client = new MqttClient(host, port, username, password);
+		clients().insert(key(host, port, username), client);
+	}
+	client->m_refCount++;
+	return client;
+}
+
+void MqttClient::release()
+{
+	if (--m_refCount <= 0)
+	{
+		clients().remove(key(m_host, m_port, m_username));
+		delete this;
+	}
+}
+
+QString MqttClient::key(const QString &host, quint16 port, const QString &username)
+{
+	return QString("%1@%2:%3").arg(username, host).arg(port);
+}
+
+MqttSubscription::MqttSubscription(const QString &filter, QObject *parent) :
+    QObject(parent),
+    m_filter(filter),
+    m_levels(filter.split('/')),
+    m_wildcard(filter.contains('+') || filter.contains('#')),
+    m_refCount(0)
+{
+}
+
+MqttSubscription::~MqttSubscription()
+{
+}
+
+bool MqttSubscription::matches(const QStringList &topicLevels) const
+{
+	for (int i = 0; i < m_levels.size(); i++)
+	{
+		const QString &level = m_levels.at(i);
+		if (level == "#")
+		{
+			return true; // matches parent level and any number of child levels
+		}
+		if (i >= topicLevels.size() || (level != "+" && level != topicLevels.at(i)))
+		{
+			return false;
+		}
+	}
+	return m_levels.size() == topicLevels.size();
+}
+
+MqttClient::MqttClient(const QString &host, quint16 port, const QString &username, const QString &password, QObject *parent) :
+    QObject(parent),
+    m_log(QString("MqttClient-%1:%2").arg(host).arg(port)),
+    m_host(host),
+    m_port(port),
+    m_username(username),
+    m_password(password),
+    m_socket(new QTcpSocket(this)),
+    m_keepAliveTimer(new QTimer(this)),
+    m_reconnectTimer(new QTimer(this)),
+    m_buffer(),
+    m_subscriptions(),
+    m_wildcards(),
+    m_packetId(0),
+    m_refCount(0),
+    m_reconnectDelay(RECONNECT_DELAY_MIN),
+    m_connected(false),
+    m_pingPending(false)
+{
+	m_reconnectTimer->setSingleShot(true);
+	connect(m_reconnectTimer, &QTimer::timeout, this, &MqttClient::connectToBroker);
+	connect(m_keepAliveTimer, &QTimer::timeout, this, &MqttClient::onKeepAlive);
+	connect(m_socket, &QTcpSocket::connected, this, &MqttClient::onConnected);
+	connect(m_socket, &QTcpSocket::disconnected, this, &MqttClient::onDisconnected);
+	connect(m_socket, &QTcpSocket::errorOccurred, this, &MqttClient::onErrorOccurred);
+	connect(m_socket, &QTcpSocket::readyRead, this, &MqttClient::onReadyRead);
+	if (m_username.isEmpty() && !m_password.isEmpty())
+	{
+		LOGGER_ERROR(m_log, "password given without user name, connecting without credentials");
+	}
+	QMetaObject::invokeMethod(this, "connectToBroker", Qt::QueuedConnection); // subscriptions are collected first
+}
+
+MqttClient::~MqttClient()
+{
+	m_socket->disconnect(this);
+	if (m_socket->state() == QAbstractSocket::ConnectedState)
+	{
+		m_socket->write(encodePacket(MQTT_DISCONNECT, QByteArray()));
+		m_socket->flush();
+	}
+	m_socket->abort();
+}
+
+MqttSubscription *MqttClient::subscribe(const QString &filter)
+{
+	MqttSubscription *subscription = m_subscriptions.value(filter);
+	if (!subscription)
+	{
+		subscription = new MqttSubscription(filter, this);
+		m_subscriptions.insert(filter, subscription);
+		if (subscription->isWildcard())
+		{
+			m_wildcards << subscription;
+		}
+		if (m_connected)
+		{
+			sendSubscribe(QStringList() << filter);
+		}
+	}
+	subscription->m_refCount++; // already subscribed (by another station) otherwise
+	return subscription;
+}
+
+void MqttClient::unsubscribe(MqttSubscription *subscription)
+{
+	if (!subscription || m_subscriptions.value(subscription->filter()) != subscription || --subscription->m_refCount > 0)
+	{
+		return;
+	}
+	m_subscriptions.remove(subscription->filter());
+	m_wildcards.removeOne(subscription);
+	if (m_connected)
+	{
+		sendUnsubscribe(subscription->filter());
+	}
+	subscription->deleteLater(); // may be emitting right now
+}
+
+void MqttClient::dispatch(const QString &topic, const QByteArray &payload)
+{
+	MqttSubscription *subscription = m_subscriptions.value(topic);
+	if (subscription && !subscription->isWildcard())
+	{
+		emit subscription->messageReceived(topic, payload);
+	}
+	if (m_wildcards.isEmpty())
+	{
+		return;
+	}
+	const QStringList levels = topic.split('/');
+	foreach (MqttSubscription *wildcard, m_wildcards) // iterates a copy, subscribers may unsubscribe
+	{
+		if (wildcard->matches(levels))
+		{
+			emit wildcard->messageReceived(topic, payload);
+		}
+	}
+}
+
+void MqttClient::connectToBroker()
+{
+	if (m_socket->state() == QAbstractSocket::UnconnectedState)
+	{
+		m_log.debug("connecting...");
+		m_buffer.clear();
+		m_socket->connectToHost(m_host, m_port);
+	}
+}
+
+void MqttClient::onConnected()
+{
+	QByteArray body = encodeString(MQTT_PROTOCOL_NAME);
+	const bool password = !m_username.isEmpty() && !m_password.isEmpty(); // MQTT 3.1.1 (3.1.2.9): no password without user name
+	quint8 flags = MQTT_FLAG_CLEAN;
+	flags |= m_username.isEmpty() ? 0 : MQTT_FLAG_USERNAME;
+	flags |= password ? MQTT_FLAG_PASSWORD : 0;
+	body.append(static_cast<char>(MQTT_PROTOCOL_LEVEL));
+	body.append(static_cast<char>(flags));
+	body.append(static_cast<char>(MQTT_KEEPALIVE_SECS >> 8));
+	body.append(static_cast<char>(MQTT_KEEPALIVE_SECS & 0xFF));
+	body.append(encodeString(QString("%1-%2-%3").arg(APP_NAME).arg(QCoreApplication::applicationPid()).arg(reinterpret_cast<quintptr>(this), 0, 16).toUtf8()));
+	if (!m_username.isEmpty())
+	{
+		body.append(encodeString(m_username.toUtf8()));
+	}
+	if (password)
+	{
+		body.append(encodeString(m_password.toUtf8()));
+	}
+	m_socket->write(encodePacket(MQTT_CONNECT, body));
+}
+
+void MqttClient::onErrorOccurred()
+{
+	LOGGER_WARNING(m_log, QString("connection error: %1").arg(m_socket->errorString()));
+	if (m_socket->state() == QAbstractSocket::UnconnectedState && !m_connected)
+	{
+		scheduleReconnect(); // connect attempt failed, 'disconnected' is not emitted in this case
+	}
+}
+
+void MqttClient::onDisconnected()
+{
+	m_keepAliveTimer->stop();
+	if (m_connected)
+	{
+		m_connected = false;
+		LOGGER_WARNING(m_log, "connection to broker lost");
+		emit connectedChanged(false);
+	}
+	scheduleReconnect();
+}
+
+void MqttClient::scheduleReconnect()
+{
+	if (!m_reconnectTimer->isActive())
+	{
+		m_log.info(QString("reconnecting in %1sec.").arg(m_reconnectDelay / 1000));
+		m_reconnectTimer->start(m_reconnectDelay);
+		m_reconnectDelay = qMin(m_reconnectDelay * 2, RECONNECT_DELAY_MAX);
+	}
+}
+
+void MqttClient::onKeepAlive()
+{
+	if (m_pingPending)
+	{
+		LOGGER_WARNING(m_log, "broker did not answer ping, reconnecting...");
+		m_socket->abort(); // emits disconnected
+		return;
+	}
+	m_pingPending = true;
+	m_socket->write(encodePacket(MQTT_PINGREQ, QByteArray()));
+}
+
+void MqttClient::onReadyRead()
+{
+	m_buffer.append(m_socket->readAll());
+	while (m_buffer.size() >= 2)
+	{
+		// fixed header: type/flags + remaining length (variable length encoding, max. 4 bytes)
+		qsizetype pos = 1;
+		int length = 0;
+		int shift = 0;
+		quint8 byte;
+		do
+		{
+			if (pos >= m_buffer.size())
+			{
+				return; // need more data
+			}
+			if (shift > 21)
+			{
+				LOGGER_ERROR(m_log, "malformed packet length, disconnecting...");
+				m_socket->abort();
+				return;
+			}
+			byte = static_cast<quint8>(m_buffer.at(pos++));
+			length |= (byte & 0x7F) << shift;
+			shift += 7;
+		} while (byte & 0x80);
+
+		if (length > MQTT_PACKET_SIZE_MAX)
+		{
+			LOGGER_ERROR(m_log, QString("packet too large (%1 bytes), disconnecting...").arg(length));
+			m_socket->abort();
+			return;
+		}
+		if (m_buffer.size() < pos + length)
+		{
+			return; // need more data
+		}
+
+		const quint8 header = static_cast<quint8>(m_buffer.at(0));
+		const QByteArray body = m_buffer.mid(pos, length);
+		m_buffer.remove(0, pos + length);
+		if (!processPacket(header, body))
+		{
+			m_socket->abort();
+			return;
+		}
+	}
+}
+
+bool MqttClient::processPacket(quint8 header, const QByteArray &body)
+{
+	switch (header & MQTT_TYPE_MASK)
+	{
+		case MQTT_CONNACK:
+			if (body.size() != 2 || body.at(1) != 0)
+			{
+				LOGGER_ERROR(m_log, QString("connection refused by broker (code: %1)").arg(body.size() == 2 ? body.at(1) : -1));
+				return false;
+			}
+			m_log.info(QString("connected to broker, subscribing %1 topic filter(s)").arg(m_subscriptions.size()));
+			m_connected = true;
+			m_pingPending = false;
+			m_reconnectDelay = RECONNECT_DELAY_MIN;
+			m_keepAliveTimer->start(MQTT_KEEPALIVE_SECS * 1000 / 2);
+			if (!m_subscriptions.isEmpty())
+			{
+				sendSubscribe(m_subscriptions.keys());
+			}
+			emit connectedChanged(true);
+			return true;
+		case MQTT_PUBLISH:
+		{
+			const int qos = (header & MQTT_QOS_MASK) >> 1;
+			if (body.size() < 2)
+			{
+				return false;
+			}
+			const int topicLen = (static_cast<quint8>(body.at(0)) << 8) | static_cast<quint8>(body.at(1));
+			qsizetype pos = 2 + topicLen;
+			if (body.size() < pos + (qos > 0 ? 2 : 0))
+			{
+				return false;
+			}
+			const QString topic = QString::fromUtf8(body.constData() + 2, topicLen);
+			if (qos > 0)
+			{
+				const QByteArray packetId = body.mid(pos, 2);
+				pos += 2;
+				if (qos == 1)
+				{
+					m_socket->write(encodePacket(MQTT_PUBACK, packetId));
+				}
+			}
+			dispatch(topic, body.mid(pos));
+			return true;
+		}
+		case MQTT_SUBACK:
+			for (qsizetype i = 2; i < body.size(); i++)
+			{
+				if (static_cast<quint8>(body.at(i)) == 0x80)
+				{
+					LOGGER_ERROR(m_log, "broker rejected subscription");
+				}
+			}
+			return true;
+		case MQTT_UNSUBACK:
+			return true;
+		case MQTT_PINGRESP:
+			m_pingPending = false;
+			return true;
+		default:
+			LOGGER_WARNING(m_log, QString("ignoring unexpected packet type: 0x%1").arg(static_cast<int>(header), 2, 16, QChar('0')));
+			return true;
+	}
+}
+
+quint16 MqttClient::nextPacketId()
+{
+	if (++m_packetId == 0)
+	{
+		m_packetId = 1; // packet id 0 is not allowed
+	}
+	return m_packetId;
+}
+
+void MqttClient::sendSubscribe(const QStringList &filters)
+{
+	const quint16 packetId = nextPacketId();
+	QByteArray body;
+	body.append(static_cast<char>(packetId >> 8));
+	body.append(static_cast<char>(packetId & 0xFF));
+	foreach (const QString &filter, filters)
+	{
+		body.append(encodeString(filter.toUtf8()));
+		body.append('\0'); // QoS 0
+		LOGGER_DEBUG(m_log, QString("subscribing '%1'").arg(filter));
+	}
+	m_socket->write(encodePacket(MQTT_SUBSCRIBE, body));
+}
+
+void MqttClient::sendUnsubscribe(const QString &filter)
+{
+	const quint16 packetId = nextPacketId();
+	QByteArray body;
+	body.append(static_cast<char>(packetId >> 8));
+	body.append(static_cast<char>(packetId & 0xFF));
+	body.append(encodeString(filter.toUtf8()));
+	LOGGER_DEBUG(m_log, QString("unsubscribing '%1'").arg(filter));
+	m_socket->write(encodePacket(MQTT_UNSUBSCRIBE, body));
+}
+
+QByteArray MqttClient::encodeString(const QByteArray &str)
+{
+	QByteArray data;
+	data.append(static_cast<char>((str.size() >> 8) & 0xFF));
+	data.append(static_cast<char>(str.size() & 0xFF));
+	data.append(str);
+	return data;
+}
+
+QByteArray MqttClient::encodePacket(quint8 header, const QByteArray &body)
+{
+	QByteArray data;
+	data.append(static_cast<char>(header));
+	qsizetype length = body.size();
+	do
+	{
+		quint8 byte = length & 0x7F;
+		length >>= 7;
+		if (length > 0)
+		{
+			byte |= 0x80;
+		}
+		data.append(static_cast<char>(byte));
+	} while (length > 0);
+	data.append(body);
+	return data;
+}
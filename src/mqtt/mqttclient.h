@@ -0,0 +1,113 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef MQTTCLIENT_H
+#define MQTTCLIENT_H
+
+#include <QObject>
+#include <QString>
+#include <QByteArray>
+#include <QStringList>
+#include <QHash>
+#include <QList>
+#include "logger.h"
+
+class QTcpSocket;
+class QTimer;
+
+/**
+ * @class MqttSubscription is a topic filter subscribed by one or more stations of a @ref MqttClient,
+ * messages matching the filter are emitted by the subscription only.
+ */
+class MqttSubscription : public QObject
+{
+	Q_OBJECT
+public:
+	QString filter() const { return m_filter; }
+
+signals:
+	void messageReceived(const QString &topic, const QByteArray &payload);
+
+private:
+	friend class MqttClient;
+	explicit MqttSubscription(const QString &filter, QObject *parent = nullptr);
+	virtual ~MqttSubscription() Q_DECL_OVERRIDE;
+
+	bool isWildcard() const { return m_wildcard; }
+	bool matches(const QStringList &topicLevels) const;
+
+	const QString m_filter;
+	const QStringList m_levels;
+	const bool m_wildcard;
+	int m_refCount;
+};
+
+/**
+ * @class MqttClient is a minimal MQTT 3.1.1 client (subscribe only, QoS 0/1) on top of QTcpSocket.
+ * Clients are shared per broker: @fn acquire() returns the existing connection for host/port/user,
+ * so any number of stations use a single TCP session. Every topic filter is subscribed once, a message
+ * is dispatched to the subscriptions matching its topic (lookup for plain topics, wildcard filters are
+ * matched against the topic levels) instead of being offered to every station.
+ */
+class MqttClient : public QObject
+{
+	Q_OBJECT
+public:
+	static MqttClient *acquire(const QString &host, quint16 port, const QString &username = QString(), const QString &password = QString());
+	void release();
+
+
+	bool isConnected() const { return m_connected; }
+	QString broker() const { return QString("%1:%2").arg(m_host).arg(m_port); }
+
+	MqttSubscription *subscribe(const QString &filter); // shared by all subscribers of the filter
+	void unsubscribe(MqttSubscription *subscription);
+
+signals:
+	void connectedChanged(bool connected);
+
+private slots:
+	void connectToBroker();
+	void onConnected();
+	void onDisconnected();
+	void onErrorOccurred();
+	void onReadyRead();
+	void onKeepAlive();
+
+private:
+	explicit MqttClient(const QString &host, quint16 port, const QString &username, const QString &password, QObject *parent = nullptr);
+	virtual ~MqttClient() Q_DECL_OVERRIDE;
+
+	static QString key(const QString &host, quint16 port, const QString &username);
+	static QByteArray encodeString(const QByteArray &str);
+	static QByteArray encodePacket(quint8 header, const QByteArray &body);
+
+	bool processPacket(quint8 header, const QByteArray &body);
+	void sendSubscribe(const QStringList &filters);
+	void sendUnsubscribe(const QString &filter);
+	void dispatch(const QString &topic, const QByteArray &payload);
+	quint16 nextPacketId();
+	void scheduleReconnect();
+
+	Logger m_log;
+	const QString m_host;
+	const quint16 m_port;
+	const QString m_username;
+	const QString m_password;
+	QTcpSocket *m_socket;
+	QTimer *m_keepAliveTimer;
+	QTimer *m_reconnectTimer;
+	QByteArray m_buffer;
+	QHash<QString, MqttSubscription*> m_subscriptions; // by filter
+	QList<MqttSubscription*> m_wildcards;              // filters containing '+' or '#'
+	quint16 m_packetId;
+	int m_refCount;
+	int m_reconnectDelay;
+	bool m_connected;
+	bool m_pingPending;
+};
+
+#endif // MQTTCLIENT_H
@@ -0,0 +1,51 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "startupprofiler.h"
+
+#include <QStringList>
+#include <cstring>
+
+QElapsedTimer StartupProfiler::s_clock;
+QList<StartupProfiler::Phase> StartupProfiler::s_phases;
+
+
+void StartupProfiler::start()
+{
+	s_clock.start(); // monotonic, so it keeps counting in the forked daemon
+	s_phases.clear();
+}
+
+void StartupProfiler::mark(const char *phase)
+{
+	if (!s_clock.isValid() || elapsed(phase) >= 0)
+	{
+		return;
+	}
+	s_phases.append({phase, s_clock.elapsed()});
+}
+
+qint64 StartupProfiler::elapsed(const char *phase)
+{
+	for (const Phase &p : s_phases)
+	{
+		if (p.name == phase || strcmp(p.name, phase) == 0)
+		{
+			return p.elapsed;
+		}
+	}
+	return -1;
+}
+
+QString StartupProfiler::report()
+{
+	QStringList phases;
+	for (const Phase &p : s_phases)
+	{
+		phases << QString("%1: %2ms").arg(p.name).arg(p.elapsed);
+	}
+	return phases.join(", ");
+}
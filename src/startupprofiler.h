@@ -0,0 +1,40 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef STARTUPPROFILER_H
+#define STARTUPPROFILER_H
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QString>
+
+/**
+ * @class StartupProfiler records when the startup phases (config loaded, radio ready, first station data, ...)
+ *        were reached, relative to the start of main(). Only the first mark() of a phase counts, so it can
+ *        be called on every pass of a code path. Main thread only.
+ */
+class StartupProfiler
+{
+public:
+	static void start();
+	static void mark(const char *phase); // phase must be a string literal
+	static qint64 elapsed(const char *phase); // msecs, -1 if not reached (yet)
+	static QString report(); // e.g. "config: 15ms, radio ready: 3230ms, ..."
+
+private:
+	StartupProfiler() = delete;
+
+	struct Phase
+	{
+		const char *name;
+		qint64 elapsed;
+	};
+
+	static QElapsedTimer s_clock;
+	static QList<Phase> s_phases;
+};
+
+#endif // STARTUPPROFILER_H
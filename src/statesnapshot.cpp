@@ -0,0 +1,213 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "statesnapshot.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QByteArray>
+#include <QtEndian>
+#include <QTimeZone>
+
+static const quint32 SNAPSHOT_MAGIC        = 0x53474146; // "FAGS"
+static const quint16 SNAPSHOT_VERSION      = 1;
+static const int     SNAPSHOT_HEADER_SIZE  = 48;
+static const int     SNAPSHOT_RECORD_SIZE  = 40;
+static const quint32 SNAPSHOT_RECORDS_MAX  = 4096; // sanity check for corrupted files
+
+// header layout (offsets)
+static const int HDR_MAGIC                 = 0;  // u32
+static const int HDR_VERSION               = 4;  // u16
+static const int HDR_RECORD_SIZE           = 6;  // u16
+static const int HDR_COUNT                 = 8;  // u32
+static const int HDR_CHECKSUM              = 12; // u16 (crc16 of records), followed by u16 reserved
+static const int HDR_CREATED               = 16; // i64, msecs since epoch (0 = invalid)
+static const int HDR_LAST_NODE             = 24; // i64
+static const int HDR_LAST_WEATHER          = 32; // i64
+static const int HDR_LAST_NAMES            = 40; // i64
+
+// record layout (offsets)
+static const int REC_TYPE                  = 0;  // u8, followed by 3 bytes padding
+static const int REC_ID                    = 4;  // i32
+static const int REC_TIMESTAMP             = 8;  // i64
+static const int REC_WIND_DIR              = 16; // i32
+static const int REC_WIND_SPEED            = 20; // i32
+static const int REC_WIND_GUSTS            = 24; // i32
+static const int REC_TEMPERATURE           = 28; // i32
+static const int REC_HUMIDITY              = 32; // i32, followed by 4 bytes reserved
+
+
+static qint64 toMSecs(const QDateTime &dt)
+{
+	return dt.isValid() ? dt.toMSecsSinceEpoch() : 0;
+}
+
+static QDateTime fromMSecs(qint64 msecs)
+{
+	return msecs > 0 ? QDateTime::fromMSecsSinceEpoch(msecs, QTimeZone::UTC) : QDateTime();
+}
+
+
+StateSnapshot::StateSnapshot() :
+    m_log("StateSnapshot"),
+    m_created(),
+    m_lastNodeSeen(),
+    m_lastWeatherUpdate(),
+    m_lastNameUpdate(),
+    m_stations()
+{
+}
+
+void StateSnapshot::clear()
+{
+	m_created = QDateTime();
+	m_lastNodeSeen = QDateTime();
+	m_lastWeatherUpdate = QDateTime();
+	m_lastNameUpdate = QDateTime();
+	m_stations.clear();
+}
+
+void StateSnapshot::setDispatcherState(const QDateTime &lastNodeSeen, const QDateTime &lastWeatherUpdate, const QDateTime &lastNameUpdate)
+{
+	m_lastNodeSeen = lastNodeSeen;
+	m_lastWeatherUpdate = lastWeatherUpdate;
+	m_lastNameUpdate = lastNameUpdate;
+}
+
+void StateSnapshot::addStation(int type, int id, const WeatherHistory::Sample &sample)
+{
+	m_stations.append(StationRecord{type, id, sample});
+}
+
+bool StateSnapshot::findStation(int type, int id, WeatherHistory::Sample *sample) const
+{
+	for (const StationRecord &rec : m_stations)
+	{
+		if (rec.type == type && rec.id == id)
+		{
+			if (sample)
+			{
+				*sample = rec.sample;
+			}
+			return true;
+		}
+	}
+	return false;
+}
+
+bool StateSnapshot::load(const QString &fileName)
+{
+	clear();
+	QFile file(fileName);
+	if (!file.exists())
+	{
+		m_log.debug(QString("no snapshot found: %1").arg(fileName));
+		return false;
+	}
+	if (!file.open(QIODevice::ReadOnly))
+	{
+		LOGGER_WARNING(m_log, QString("failed to open snapshot '%1': %2").arg(fileName, file.errorString()));
+		return false;
+	}
+
+	const qint64 size = file.size();
+	if (size < SNAPSHOT_HEADER_SIZE)
+	{
+		LOGGER_WARNING(m_log, QString("ignoring snapshot '%1': file too small").arg(fileName));
+		return false;
+	}
+	const uchar *data = file.map(0, size);
+	if (!data)
+	{
+		LOGGER_WARNING(m_log, QString("failed to map snapshot '%1': %2").arg(fileName, file.errorString()));
+		return false;
+	}
+
+	const quint32 count = qFromLittleEndian<quint32>(data + HDR_COUNT);
+	if (qFromLittleEndian<quint32>(data + HDR_MAGIC) != SNAPSHOT_MAGIC
+	        || qFromLittleEndian<quint16>(data + HDR_VERSION) != SNAPSHOT_VERSION
+	        || qFromLittleEndian<quint16>(data + HDR_RECORD_SIZE) != SNAPSHOT_RECORD_SIZE
+	        || count > SNAPSHOT_RECORDS_MAX
+	        || size != SNAPSHOT_HEADER_SIZE + static_cast<qint64>(count) * SNAPSHOT_RECORD_SIZE)
+	{
+		LOGGER_WARNING(m_log, QString("ignoring snapshot '%1': unsupported format").arg(fileName));
+		file.unmap(const_cast<uchar*>(data));
+		return false;
+	}
+	const QByteArrayView records(data + SNAPSHOT_HEADER_SIZE, count * SNAPSHOT_RECORD_SIZE);
+	if (qChecksum(records) != qFromLittleEndian<quint16>(data + HDR_CHECKSUM))
+	{
+		LOGGER_WARNING(m_log, QString("ignoring snapshot '%1': checksum mismatch").arg(fileName));
+		file.unmap(const_cast<uchar*>(data));
+		return false;
+	}
+
+	m_created = fromMSecs(qFromLittleEndian<qint64>(data + HDR_CREATED));
+	m_lastNodeSeen = fromMSecs(qFromLittleEndian<qint64>(data + HDR_LAST_NODE));
+	m_lastWeatherUpdate = fromMSecs(qFromLittleEndian<qint64>(data + HDR_LAST_WEATHER));
+	m_lastNameUpdate = fromMSecs(qFromLittleEndian<qint64>(data + HDR_LAST_NAMES));
+	m_stations.reserve(count);
+	for (quint32 i = 0; i < count; i++)
+	{
+		const uchar *rec = data + SNAPSHOT_HEADER_SIZE + i * SNAPSHOT_RECORD_SIZE;
+		const WeatherHistory::Sample sample{qFromLittleEndian<qint64>(rec + REC_TIMESTAMP),
+		                                    qFromLittleEndian<qint32>(rec + REC_WIND_SPEED),
+		                                    qFromLittleEndian<qint32>(rec + REC_WIND_GUSTS),
+		                                    qFromLittleEndian<qint32>(rec + REC_WIND_DIR),
+		                                    qFromLittleEndian<qint32>(rec + REC_TEMPERATURE),
+		                                    qFromLittleEndian<qint32>(rec + REC_HUMIDITY)};
+		m_stations.append(StationRecord{rec[REC_TYPE], qFromLittleEndian<qint32>(rec + REC_ID), sample});
+	}
+	file.unmap(const_cast<uchar*>(data));
+	m_log.debug(QString("loaded snapshot from %1 (%2 stations, created: %3)").arg(fileName).arg(count).arg(m_created.toString()));
+	return true;
+}
+
+bool StateSnapshot::save(const QString &fileName) const
+{
+	QByteArray buffer(SNAPSHOT_HEADER_SIZE + m_stations.size() * SNAPSHOT_RECORD_SIZE, '\0');
+	uchar *data = reinterpret_cast<uchar*>(buffer.data());
+
+	for (int i = 0; i < m_stations.size(); i++)
+	{
+		const StationRecord &station = m_stations.at(i);
+		uchar *rec = data + SNAPSHOT_HEADER_SIZE + i * SNAPSHOT_RECORD_SIZE;
+		rec[REC_TYPE] = static_cast<uchar>(station.type);
+		qToLittleEndian<qint32>(station.id, rec + REC_ID);
+		qToLittleEndian<qint64>(station.sample.timestamp, rec + REC_TIMESTAMP);
+		qToLittleEndian<qint32>(station.sample.windDirection, rec + REC_WIND_DIR);
+		qToLittleEndian<qint32>(station.sample.windSpeed, rec + REC_WIND_SPEED);
+		qToLittleEndian<qint32>(station.sample.windGusts, rec + REC_WIND_GUSTS);
+		qToLittleEndian<qint32>(station.sample.temperature, rec + REC_TEMPERATURE);
+		qToLittleEndian<qint32>(station.sample.humidity, rec + REC_HUMIDITY);
+	}
+
+	qToLittleEndian<quint32>(SNAPSHOT_MAGIC, data + HDR_MAGIC);
+	qToLittleEndian<quint16>(SNAPSHOT_VERSION, data + HDR_VERSION);
+	qToLittleEndian<quint16>(SNAPSHOT_RECORD_SIZE, data + HDR_RECORD_SIZE);
+	qToLittleEndian<quint32>(m_stations.size(), data + HDR_COUNT);
+	qToLittleEndian<quint16>(qChecksum(QByteArrayView(buffer).sliced(SNAPSHOT_HEADER_SIZE)), data + HDR_CHECKSUM);
+	qToLittleEndian<qint64>(QDateTime::currentMSecsSinceEpoch(), data + HDR_CREATED);
+	qToLittleEndian<qint64>(toMSecs(m_lastNodeSeen), data + HDR_LAST_NODE);
+	qToLittleEndian<qint64>(toMSecs(m_lastWeatherUpdate), data + HDR_LAST_WEATHER);
+	qToLittleEndian<qint64>(toMSecs(m_lastNameUpdate), data + HDR_LAST_NAMES);
+
+	const QDir dir = QFileInfo(fileName).absoluteDir();
+	if (!dir.exists() && !dir.mkpath("."))
+	{
+		LOGGER_WARNING(m_log, QString("failed to create state directory '%1'").arg(dir.path()));
+		return false;
+	}
+	QSaveFile file(fileName); // writes to temp. file and renames it on commit, so there is never a partial snapshot
+	if (!file.open(QIODevice::WriteOnly) || file.write(buffer) != buffer.size() || !file.commit())
+	{
+		LOGGER_WARNING(m_log, QString("failed to write snapshot '%1': %2").arg(fileName, file.errorString()));
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,57 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef STATESNAPSHOT_H
+#define STATESNAPSHOT_H
+
+#include <QList>
+#include <QString>
+#include <QDateTime>
+#include "logger.h"
+#include "weatherstation/weatherhistory.h"
+
+/**
+ * @class StateSnapshot holds the runtime state (latest sample of each weather station and the dispatcher's
+ * timestamps) that is persisted across restarts. The file consists of a fixed size header followed by
+ * fixed size records (all values little endian), it is written atomically and memory-mapped for reading.
+ */
+class StateSnapshot
+{
+public:
+	struct StationRecord
+	{
+		int type; // StationConfig::StationType
+		int id;
+		WeatherHistory::Sample sample;
+	};
+
+	StateSnapshot();
+	~StateSnapshot() = default;
+
+	bool load(const QString &fileName);
+	bool save(const QString &fileName) const;
+	void clear();
+
+	QDateTime created() const { return m_created; }
+	QDateTime lastNodeSeen() const { return m_lastNodeSeen; }
+	QDateTime lastWeatherUpdate() const { return m_lastWeatherUpdate; }
+	QDateTime lastNameUpdate() const { return m_lastNameUpdate; }
+	void setDispatcherState(const QDateTime &lastNodeSeen, const QDateTime &lastWeatherUpdate, const QDateTime &lastNameUpdate);
+
+	const QList<StationRecord> &stations() const { return m_stations; }
+	void addStation(int type, int id, const WeatherHistory::Sample &sample);
+	bool findStation(int type, int id, WeatherHistory::Sample *sample) const;
+
+private:
+	mutable Logger m_log;
+	QDateTime m_created;
+	QDateTime m_lastNodeSeen;
+	QDateTime m_lastWeatherUpdate;
+	QDateTime m_lastNameUpdate;
+	QList<StationRecord> m_stations;
+};
+
+#endif // STATESNAPSHOT_H
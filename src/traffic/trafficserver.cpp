@@ -0,0 +1,172 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "trafficserver.h"
+#include "fanet/fanetradio.h"
+#include "fanet/fanetaddress.h"
+#include "fanet/fanetpayload.h"
+#include "metrics/metrics.h"
+#include "config.h"
+
+#include <QIODevice>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+static void insertPosition(QJsonObject &record, const QGeoCoordinate &pos)
+{
+	if (pos.isValid())
+	{
+		record.insert("lat", pos.latitude());
+		record.insert("lon", pos.longitude());
+	}
+}
+
+static QByteArray encode(const FanetAddress &addr, const FanetPayload &payload, bool broadcast, qint64 timestamp)
+{
+	QJsonObject record;
+	record.insert("ts", timestamp);
+	record.insert("addr", QString::fromLatin1(addr.toHex(':')));
+	record.insert("type", FanetPayload::payloadTypeStr(payload.type()));
+	record.insert("broadcast", broadcast);
+	switch (payload.type()) // same fields as ReceiveEvent::toString(), in base units
+	{
+		case FanetPayload::PTName:
+			record.insert("name", payload.name());
+			break;
+		case FanetPayload::PTMessage:
+			record.insert("message", payload.message());
+			break;
+		case FanetPayload::PTTracking:
+			insertPosition(record, payload.position());
+			record.insert("altitude", payload.altitude());
+			record.insert("speed", payload.speed() / 10.0);
+			record.insert("climb", payload.climb() / 10.0);
+			record.insert("heading", payload.heading());
+			record.insert("aircraft", FanetPayload::aircraftTypeStr(payload.aircraftType()));
+			record.insert("online", payload.onlineTracking());
+			break;
+		case FanetPayload::PTThermal:
+			insertPosition(record, payload.position());
+			record.insert("quality", payload.quality());
+			record.insert("altitude", payload.altitude());
+			record.insert("climb", payload.climb() / 10.0);
+			record.insert("wind", payload.speed() / 10.0);
+			record.insert("dir", payload.heading());
+			break;
+		case FanetPayload::PTGroundTracking:
+			insertPosition(record, payload.position());
+			record.insert("ground", FanetPayload::groundTrackingTypeStr(payload.groundTrackingType()));
+			record.insert("online", payload.onlineTracking());
+			break;
+		case FanetPayload::PTHWInfo:
+		case FanetPayload::PTHWInfoOld:
+			record.insert("device", payload.deviceType(addr.manufacturerId()));
+			record.insert("firmware", payload.firmwareBuild());
+			record.insert("uptime", payload.uptime());
+			break;
+		case FanetPayload::PTService:
+			insertPosition(record, payload.position());
+			record.insert("temperature", payload.temperature() / 10.0);
+			record.insert("dir", payload.dir());
+			record.insert("wind", payload.wind() / 10.0);
+			record.insert("gusts", payload.gusts() / 10.0);
+			break;
+		default:
+			break; // raw data only
+	}
+	record.insert("data", QString::fromLatin1(payload.data().toHex()));
+	return QJsonDocument(record).toJson(QJsonDocument::Compact).append('\n');
+}
+
+
+TrafficServer::TrafficServer(const ListenConfig &config, FanetRadio *radio, QObject *parent) :
+    ListenServer("TrafficServer", config, "streaming fanet traffic", parent),
+    m_subscribers()
+{
+	if (radio)
+	{
+		connect(radio, &FanetRadio::messageReceived, this, &TrafficServer::onMessageReceived);
+	}
+}
+
+TrafficServer::~TrafficServer()
+{
+	foreach (const Subscriber &subscriber, m_subscribers)
+	{
+		subscriber.dev->disconnect(this);
+	}
+}
+
+bool TrafficServer::acceptClient(QIODevice *client)
+{
+	if (m_subscribers.size() >= TRAFFIC_SUBSCRIBERS_MAX)
+	{
+		LOGGER_WARNING(m_log, QString("rejecting subscriber: limit of %1 reached").arg(TRAFFIC_SUBSCRIBERS_MAX));
+		return false;
+	}
+	connect(client, &QIODevice::readyRead, this, &TrafficServer::onReadyRead);
+	connect(client, &QObject::destroyed, this, &TrafficServer::onSubscriberDestroyed);
+	m_subscribers.append({client, 0});
+	Metrics::instance().setTrafficSubscribers(m_subscribers.size());
+	LOGGER_DEBUG(m_log, QString("subscriber connected (%1 total)").arg(m_subscribers.size()));
+	return true;
+}
+
+void TrafficServer::onReadyRead()
+{
+	QIODevice *client = qobject_cast<QIODevice*>(sender());
+	if (client)
+	{
+		client->readAll(); // subscribers have nothing to say
+	}
+}
+
+void TrafficServer::onSubscriberDestroyed(QObject *obj)
+{
+	for (int i = 0; i < m_subscribers.size(); i++)
+	{
+		if (m_subscribers.at(i).dev == obj) // pointer comparison only, obj is no QIODevice anymore
+		{
+			m_subscribers.removeAt(i);
+			Metrics::instance().setTrafficSubscribers(m_subscribers.size());
+			LOGGER_DEBUG(m_log, QString("subscriber disconnected (%1 left)").arg(m_subscribers.size()));
+			return;
+		}
+	}
+}
+
+void TrafficServer::onMessageReceived(quint32 addr, const FanetPayload &payload, bool broadcast, qint64 timestamp)
+{
+	if (m_subscribers.isEmpty())
+	{
+		return;
+	}
+	publish(encode(FanetAddress(addr), payload, broadcast, timestamp));
+}
+
+void TrafficServer::publish(const QByteArray &record)
+{
+	for (Subscriber &subscriber : m_subscribers)
+	{
+		if (!subscriber.dev->isOpen())
+		{
+			continue; // closing, destroyed soon
+		}
+		const qint64 pending = subscriber.dev->bytesToWrite();
+		if (pending + record.size() > TRAFFIC_CLIENT_BUFFER_MAX)
+		{
+			subscriber.dropped++;
+			Metrics::instance().trafficDropped();
+			continue; // slow subscriber: drop the record, never block or buffer without limit
+		}
+		if (subscriber.dropped > 0)
+		{
+			subscriber.dev->write(QByteArray("{\"dropped\":").append(QByteArray::number(subscriber.dropped)).append("}\n"));
+			subscriber.dropped = 0;
+		}
+		subscriber.dev->write(record);
+	}
+}
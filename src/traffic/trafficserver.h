@@ -0,0 +1,52 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef TRAFFICSERVER_H
+#define TRAFFICSERVER_H
+
+#include <QList>
+#include "listenserver.h"
+
+class FanetRadio;
+class FanetPayload;
+
+/**
+ * @class TrafficServer streams received fanet frames to its subscribers as NDJSON, one object per frame:
+ *        {"ts":<msecs since epoch>,"addr":"01:0abc","type":"Tracking","broadcast":true,...decoded fields...,"data":"<hex>"}
+ *        A record is encoded once and appended to every subscriber's socket buffer. If a buffer exceeds
+ *        TRAFFIC_CLIENT_BUFFER_MAX the record is dropped for that subscriber only, once the subscriber
+ *        catches up it receives {"dropped":<n>} first. Data sent by subscribers is ignored.
+ */
+class TrafficServer : public ListenServer
+{
+	Q_OBJECT
+public:
+	explicit TrafficServer(const ListenConfig &config, FanetRadio *radio, QObject *parent = nullptr);
+	virtual ~TrafficServer() Q_DECL_OVERRIDE;
+
+	int subscribers() const { return m_subscribers.size(); }
+
+protected:
+	virtual bool acceptClient(QIODevice *client) Q_DECL_OVERRIDE;
+
+private slots:
+	void onReadyRead();
+	void onSubscriberDestroyed(QObject *obj);
+	void onMessageReceived(quint32 addr, const FanetPayload &payload, bool broadcast, qint64 timestamp);
+
+private:
+	struct Subscriber
+	{
+		QIODevice *dev;
+		quint64 dropped; // records not sent since the last notice
+	};
+
+	void publish(const QByteArray &record);
+
+	QList<Subscriber> m_subscribers;
+};
+
+#endif // TRAFFICSERVER_H
@@ -5,29 +5,82 @@
  */
 
 #include "abstractweatherstation.h"
-#include "holfuyapi.h"
-#include "holfuywidget.h"
-#include "windbirdapi.h"
+#include "stationregistry.h"
+#include "fetchscheduler.h"
+#include "config.h"
+#include "metrics/metrics.h"
+#include "startupprofiler.h"
+#include "logger.h"
 
+#include <QNetworkRequest>
+#include <QNetworkReply>
+#include <QHash>
 #include <QTimer>
 
+static const int  ADAPTIVE_MARGIN_MSEC            = 5 * 1000;  // fetch 5sec. after expected publishing time
+static const int  ADAPTIVE_RETRY_DIVISOR          = 6;         // station is late: retry after 1/6 of its period...
+static const int  ADAPTIVE_RETRY_MIN_MSEC         = 10 * 1000; // ...but not within 10sec.
+static const int  ADAPTIVE_INTERVAL_MAX_MSEC      = 30 * 60 * 1000;
+
+static const int  HTTP_STATUS_NOT_MODIFIED        = 304;
+static const char HTTP_HEADER_ETAG[]              = "ETag";
+static const char HTTP_HEADER_LAST_MODIFIED[]     = "Last-Modified";
+static const char HTTP_HEADER_IF_NONE_MATCH[]     = "If-None-Match";
+static const char HTTP_HEADER_IF_MODIFIED_SINCE[] = "If-Modified-Since";
+
+static Logger s_log("AbstractWeatherStation");
+
 
 AbstractWeatherStation::AbstractWeatherStation(QObject *parent) :
     QObject(parent),
     m_updateIntervalSecs(0),
+    m_adaptive(false),
     m_timer(new QTimer(this)),
-    m_config()
+    m_due(),
+    m_config(),
+    m_cadence(),
+    m_history(WEATHER_HISTORY_SIZE),
+    m_etag(),
+    m_lastModified(),
+    m_contentHash(0),
+    m_contentSize(-1),
+    m_parsedUpdates(0),
+    m_skippedUpdates(0),
+    m_networkError(false),
+    m_averageWindowSecs(0),
+    m_snapshot(std::make_shared<const WeatherSnapshot>()),
+    m_metrics(nullptr)
 {
-	connect(m_timer, &QTimer::timeout, this, &AbstractWeatherStation::update);
+	m_timer->setSingleShot(m_adaptive);
+	connect(m_timer, &QTimer::timeout, this, &AbstractWeatherStation::onUpdateTimer);
+	connect(this, &AbstractWeatherStation::updateFinished, this, &AbstractWeatherStation::recordSample);
+	connect(this, &AbstractWeatherStation::updateFinished, this, &AbstractWeatherStation::scheduleNextUpdate);
 }
 
 AbstractWeatherStation::AbstractWeatherStation(const StationConfig &config, QObject *parent) :
     QObject(parent),
     m_updateIntervalSecs(0),
+    m_adaptive(config.adaptiveInterval()),
     m_timer(new QTimer(this)),
-    m_config(config)
+    m_due(),
+    m_config(config),
+    m_cadence(),
+    m_history(WEATHER_HISTORY_SIZE),
+    m_etag(),
+    m_lastModified(),
+    m_contentHash(0),
+    m_contentSize(-1),
+    m_parsedUpdates(0),
+    m_skippedUpdates(0),
+    m_networkError(false),
+    m_averageWindowSecs(0),
+    m_snapshot(std::make_shared<const WeatherSnapshot>()),
+    m_metrics(nullptr)
 {
-	connect(m_timer, &QTimer::timeout, this, &AbstractWeatherStation::update);
+	m_timer->setSingleShot(m_adaptive);
+	connect(m_timer, &QTimer::timeout, this, &AbstractWeatherStation::onUpdateTimer);
+	connect(this, &AbstractWeatherStation::updateFinished, this, &AbstractWeatherStation::recordSample);
+	connect(this, &AbstractWeatherStation::updateFinished, this, &AbstractWeatherStation::scheduleNextUpdate);
 	if (config.updateInterval() > 0)
 	{
 		setUpdateInterval(config.updateInterval());
@@ -36,6 +89,14 @@ AbstractWeatherStation::AbstractWeatherStation(const StationConfig &config, QObj
 
 AbstractWeatherStation::~AbstractWeatherStation()
 {
+	if (m_metrics)
+	{
+		Metrics::instance().removeStation(m_metrics);
+	}
+	if (FetchScheduler::instance())
+	{
+		FetchScheduler::instance()->remove(this);
+	}
 	if (m_timer->isActive())
 	{
 		m_timer->stop();
@@ -46,16 +107,10 @@ AbstractWeatherStation* AbstractWeatherStation::fromConfig(const StationConfig &
 {
 	if (config.isValid())
 	{
-		switch (config.stationType())
+		const StationRegistry::Provider *provider = StationRegistry::instance().provider(config.stationType());
+		if (provider)
 		{
-			case StationConfig::HolfuyApi:
-				return new HolfuyApi(config, parent);
-			case StationConfig::HolfuyWidget:
-				return new HolfuyWidget(config, parent);
-			case StationConfig::Windbird:
-				return new WindbirdApi(config, parent);
-			default:
-				break;
+			return provider->factory(config, parent);
 		}
 	}
 	return nullptr;
@@ -63,14 +118,275 @@ AbstractWeatherStation* AbstractWeatherStation::fromConfig(const StationConfig &
 
 void AbstractWeatherStation::setUpdateInterval(int secs)
 {
+	if (secs > 0 && secs < minUpdateInterval())
+	{
+		secs = minUpdateInterval(); // provider does not allow polling more often
+	}
 	if (secs != m_updateIntervalSecs)
 	{
 		if (secs > 0)
+		{
 			m_timer->start(secs * 1000);
-		else
+		} else
+		{
 			m_timer->stop();
+			m_due.invalidate();
+			if (FetchScheduler::instance())
+			{
+				FetchScheduler::instance()->remove(this); // drop pending request
+			}
+		}
 
 		m_updateIntervalSecs = secs;
 		emit updateIntervalChanged(secs);
 	}
 }
+
+QUrl AbstractWeatherStation::providerUrl(const QString &url) const
+{
+	QUrl result(url);
+	const QUrl base(m_config.attribute(CONFIG_ATTR_URL));
+	if (base.isValid() && !base.host().isEmpty())
+	{
+		result.setScheme(base.scheme());
+		result.setHost(base.host());
+		result.setPort(base.port());
+	}
+	return result;
+}
+
+void AbstractWeatherStation::prepareRequest(QNetworkRequest &request) const
+{
+	if (!m_etag.isEmpty())
+	{
+		request.setRawHeader(HTTP_HEADER_IF_NONE_MATCH, m_etag);
+	}
+	if (!m_lastModified.isEmpty())
+	{
+		request.setRawHeader(HTTP_HEADER_IF_MODIFIED_SINCE, m_lastModified);
+	}
+}
+
+bool AbstractWeatherStation::isNotModified(const QNetworkReply *reply)
+{
+	if (reply && reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == HTTP_STATUS_NOT_MODIFIED)
+	{
+		m_skippedUpdates++;
+		return true;
+	}
+	return false;
+}
+
+bool AbstractWeatherStation::isContentUnchanged(QByteArrayView data)
+{
+	if (m_contentSize == data.size() && m_contentHash == qHash(data))
+	{
+		m_skippedUpdates++;
+		return true;
+	}
+	return false;
+}
+
+void AbstractWeatherStation::setContentParsed(QByteArrayView data, const QNetworkReply *reply)
+{
+	// validators are stored after successful parsing only, so a reply that failed to parse will be fetched again
+	m_contentHash = qHash(data);
+	m_contentSize = data.size();
+	if (reply)
+	{
+		m_etag = reply->rawHeader(HTTP_HEADER_ETAG);
+		m_lastModified = reply->rawHeader(HTTP_HEADER_LAST_MODIFIED);
+	}
+	m_parsedUpdates++;
+}
+
+Metrics::Station *AbstractWeatherStation::metrics()
+{
+	if (!m_metrics)
+	{
+		const StationRegistry::Provider *info = StationRegistry::instance().provider(m_config.stationType());
+		m_metrics = Metrics::instance().addStation(m_config.stationType(), stationId(), info ? info->element : QString());
+	}
+	return m_metrics;
+}
+
+bool AbstractWeatherStation::restoreState(const WeatherHistory::Sample &sample)
+{
+	if (lastUpdate().isValid() || sample.timestamp <= 0 || !applyState(sample))
+	{
+		return false;
+	}
+	s_log.info(QString("restored data from %1 (%2 UTC)")
+	           .arg(stationName().isEmpty() ? QString::number(stationId()) : stationName(), lastUpdate().toUTC().time().toString()));
+	const WeatherDataFlags available = availableData();
+	if (available & WindDirection)
+	{
+		emit windDirectionChanged(windDirection());
+	}
+	if (available & WindSpeed)
+	{
+		emit windSpeedChanged(windSpeed());
+	}
+	if (available & WindSpeedGust)
+	{
+		emit windGustsChanged(windGusts());
+	}
+	if (available & Temperature)
+	{
+		emit temperatureChanged(temperature());
+	}
+	if (available & Humidity)
+	{
+		emit humidityChanged(humidity());
+	}
+	emit lastUpdateChanged(lastUpdate());
+	m_history.append(sample);
+	publishSnapshot();
+	return true;
+}
+
+AbstractWeatherStation::WeatherDataFlags AbstractWeatherStation::validData(const WeatherHistory::Sample &sample) const
+{
+	WeatherDataFlags flags = NoData;
+	if (sample.windSpeed >= 0)
+	{
+		flags |= WindSpeed;
+	}
+	if (sample.windGusts >= 0)
+	{
+		flags |= WindSpeedGust;
+	}
+	if (sample.windDirection >= 0)
+	{
+		flags |= WindDirection;
+	}
+	if (sample.temperature != TemperatureInvalid * 10)
+	{
+		flags |= Temperature;
+	}
+	if (sample.humidity >= 0)
+	{
+		flags |= Humidity;
+	}
+	return flags;
+}
+
+void AbstractWeatherStation::requestUpdate(bool jitter)
+{
+	if (FetchScheduler::instance())
+	{
+		FetchScheduler::instance()->enqueue(this, jitter);
+	} else
+	{
+		startUpdate();
+	}
+}
+
+void AbstractWeatherStation::startUpdate()
+{
+	if (m_updateIntervalSecs > 0)
+	{
+		const qint64 interval = m_updateIntervalSecs * 1000;
+		if (!m_due.isValid())
+		{
+			// first (or explicitly requested) update: keep the phase the scheduler has chosen (spreads stations over the interval)
+			m_timer->start(static_cast<int>(interval));
+		} else if (m_adaptive)
+		{
+			// fallback counted from the due time, rescheduled once the update has finished
+			m_timer->start(static_cast<int>(qMax<qint64>(0, interval - m_due.elapsed())));
+		}
+		// fixed: the periodic timer keeps running from the original due time, the queue wait does not shift it
+		m_due.invalidate();
+	}
+	m_networkError = false;
+	update();
+}
+
+void AbstractWeatherStation::onUpdateTimer()
+{
+	if (!m_due.isValid())
+	{
+		m_due.start(); // still queued otherwise: keep the earlier due time
+	}
+	requestUpdate();
+}
+
+void AbstractWeatherStation::scheduleNextUpdate(bool success)
+{
+	if (!m_adaptive || m_updateIntervalSecs <= 0)
+	{
+		return; // fixed interval (or disabled)
+	}
+
+	const QDateTime now = QDateTime::currentDateTimeUtc();
+	qint64 delay = m_updateIntervalSecs * 1000; // until cadence is known, use configured interval
+	if (success)
+	{
+		m_cadence.addTimestamp(lastUpdate());
+	}
+	if (m_cadence.isValid())
+	{
+		const qint64 untilExpected = now.msecsTo(m_cadence.nextExpected());
+		if (untilExpected + ADAPTIVE_MARGIN_MSEC > 0)
+		{
+			delay = untilExpected + ADAPTIVE_MARGIN_MSEC; // fetch just after the station has published new data
+		} else
+		{
+			delay = qMax<qint64>(ADAPTIVE_RETRY_MIN_MSEC, m_cadence.period() / ADAPTIVE_RETRY_DIVISOR); // station is late
+		}
+	}
+	delay = qBound<qint64>(minUpdateInterval() * 1000, delay, ADAPTIVE_INTERVAL_MAX_MSEC);
+	m_timer->start(static_cast<int>(delay));
+}
+
+void AbstractWeatherStation::recordSample(bool success)
+{
+	const QDateTime timestamp = lastUpdate();
+	if (success && timestamp.isValid())
+	{
+		// samples with unchanged timestamp are dropped by history
+		m_history.append(WeatherHistory::Sample{timestamp.toMSecsSinceEpoch(), windSpeed(), windGusts(),
+		                                        windDirection(), temperature(), humidity()});
+		const WeatherSnapshotPtr current = snapshot();
+		if (current->lastUpdate != timestamp || current->stationName != stationName())
+		{
+			publishSnapshot();
+		}
+	}
+}
+
+void AbstractWeatherStation::setAveragingWindow(int secs)
+{
+	m_averageWindowSecs = qMax(0, secs); // applies to the next snapshot
+}
+
+void AbstractWeatherStation::publishSnapshot()
+{
+	std::shared_ptr<WeatherSnapshot> snapshot = std::make_shared<WeatherSnapshot>();
+	snapshot->stationId = stationId();
+	snapshot->stationName = stationName();
+	snapshot->position = m_config.position();
+	snapshot->lastUpdate = lastUpdate();
+	snapshot->availableData = static_cast<int>(availableData());
+	snapshot->windSpeed = windSpeed();
+	snapshot->windGusts = windGusts();
+	snapshot->windDirection = windDirection();
+	snapshot->temperature = temperature();
+	snapshot->humidity = humidity();
+	if (m_averageWindowSecs > 0)
+	{
+		snapshot->averageWindow = m_averageWindowSecs;
+		snapshot->average = m_history.aggregate(m_averageWindowSecs);
+	}
+
+	if (snapshot->lastUpdate.isValid())
+	{
+		StartupProfiler::mark("first data");
+		metrics()->dataUpdated(snapshot->lastUpdate.toMSecsSinceEpoch());
+	}
+
+	const WeatherSnapshotPtr published(std::move(snapshot));
+	std::atomic_store(&m_snapshot, published);
+	emit snapshotUpdated(published);
+}
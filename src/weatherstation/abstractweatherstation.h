@@ -9,13 +9,21 @@
 
 #include <QByteArray>
 #include <QDateTime>
+#include <QElapsedTimer>
 #include <QFlags>
 #include <QObject>
 #include <QString>
 #include <QList>
+#include <QUrl>
 #include <config/stationconfig.h>
+#include "cadenceestimator.h"
+#include "weatherhistory.h"
+#include "weathersnapshot.h"
+#include "metrics/metrics.h"
 
 class QTimer;
+class QNetworkReply;
+class QNetworkRequest;
 
 class AbstractWeatherStation : public QObject
 {
@@ -67,9 +75,27 @@ public:
 	virtual WeatherDataFlags availableData() const = 0;
 	virtual StationConfig config() const { return m_config; }
 	int updateInterval() const { return m_updateIntervalSecs; } // 0 = disabled
+	virtual int minUpdateInterval() const { return 0; } // provider limit in seconds, 0 = none
+	virtual QString remoteHost() const { return QString(); } // host polled by update(), empty if none
+	bool adaptiveInterval() const { return m_adaptive; }
+	int estimatedPeriod() const { return static_cast<int>(m_cadence.period() / 1000); } // in seconds, 0 = unknown
+
+	quint64 parsedUpdates() const { return m_parsedUpdates; }   // replies that were parsed
+	quint64 skippedUpdates() const { return m_skippedUpdates; } // replies skipped as unchanged (http 304 or identical content)
+	bool networkError() const { return m_networkError; }        // last update failed to reach the remote host (vs. bad data)
+
+	const WeatherHistory &history() const { return m_history; }
+	int averagingWindow() const { return m_averageWindowSecs; }
+	void setAveragingWindow(int secs); // average published with the snapshot, 0 = none
+	bool restoreState(const WeatherHistory::Sample &sample); // warm start from snapshot, only if no data was fetched yet
+	WeatherSnapshotPtr snapshot() const { return std::atomic_load(&m_snapshot); } // never null, thread-safe
+
+	void startUpdate(); // called by FetchScheduler once it's the station's turn
+	Metrics::Station *metrics(); // registered on first use, removed with the station
 
 public slots:
 	virtual void update() = 0;
+	void requestUpdate(bool jitter = false); // update via FetchScheduler (if any), jitter: delay start randomly
 	void setUpdateInterval(int secs);
 
 signals:
@@ -82,11 +108,42 @@ signals:
 	void humidityChanged(int newHumidity);
 	void updateFinished(bool success);
 	void updateIntervalChanged(int newUpdateIntervalSecs);
+	void snapshotUpdated(WeatherSnapshotPtr snapshot);
+
+private slots:
+	void onUpdateTimer();
+	void scheduleNextUpdate(bool success);
+	void recordSample(bool success);
+
+protected:
+	QUrl providerUrl(const QString &url) const; // applies the station's url override (if any)
+	void prepareRequest(QNetworkRequest &request) const; // adds conditional headers (If-None-Match/If-Modified-Since)
+	bool isNotModified(const QNetworkReply *reply);
+	bool isContentUnchanged(QByteArrayView data);
+	void setContentParsed(QByteArrayView data, const QNetworkReply *reply = nullptr);
+	void setNetworkError() { m_networkError = true; } // before updateFinished(false): request failed or timed out
+	virtual bool applyState(const WeatherHistory::Sample &sample) { Q_UNUSED(sample) return false; } // members only, see restoreState()
+	WeatherDataFlags validData(const WeatherHistory::Sample &sample) const; // fields of sample that are valid
+	void publishSnapshot();
 
 private:
 	int m_updateIntervalSecs;
+	bool m_adaptive;
 	QTimer *m_timer;
+	QElapsedTimer m_due; // since the timer became due, invalid if the pending update was not requested by the timer
 	StationConfig m_config;
+	CadenceEstimator m_cadence;
+	WeatherHistory m_history;
+	QByteArray m_etag;
+	QByteArray m_lastModified;
+	size_t m_contentHash;
+	qsizetype m_contentSize;
+	quint64 m_parsedUpdates;
+	quint64 m_skippedUpdates;
+	bool m_networkError;
+	int m_averageWindowSecs;
+	WeatherSnapshotPtr m_snapshot; // access via std::atomic_load/std::atomic_store only
+	Metrics::Station *m_metrics;
 };
 
 typedef QList<AbstractWeatherStation*> WeatherStationList;
@@ -0,0 +1,94 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "cadenceestimator.h"
+
+#include <QTimeZone>
+#include <algorithm>
+
+static const int    CADENCE_HISTORY_SIZE = 9;          // number of timestamps kept (= 8 deltas)
+static const int    CADENCE_SAMPLES_MIN  = 3;          // min. number of timestamps needed for an estimation
+static const qint64 CADENCE_PERIOD_MIN   = 10 * 1000;  // ignore deltas below 10sec. (duplicates/clock jitter)
+static const qint64 CADENCE_PERIOD_MAX   = 3600 * 1000;
+
+
+CadenceEstimator::CadenceEstimator() :
+    m_timestamps(),
+    m_period(0)
+{
+}
+
+void CadenceEstimator::addTimestamp(const QDateTime &timestamp)
+{
+	if (!timestamp.isValid())
+	{
+		return;
+	}
+	const qint64 msecs = timestamp.toMSecsSinceEpoch();
+	if (!m_timestamps.isEmpty())
+	{
+		const qint64 delta = msecs - m_timestamps.last();
+		if (delta < CADENCE_PERIOD_MIN)
+		{
+			return; // not a new update
+		}
+		if (delta > CADENCE_PERIOD_MAX)
+		{
+			m_timestamps.clear(); // station was offline for a while, start over
+			m_period = 0;
+		}
+	}
+	m_timestamps.append(msecs);
+	if (m_timestamps.size() > CADENCE_HISTORY_SIZE)
+	{
+		m_timestamps.removeFirst();
+	}
+	estimate();
+}
+
+void CadenceEstimator::clear()
+{
+	m_timestamps.clear();
+	m_period = 0;
+}
+
+QDateTime CadenceEstimator::lastTimestamp() const
+{
+	return m_timestamps.isEmpty() ? QDateTime() : QDateTime::fromMSecsSinceEpoch(m_timestamps.last(), QTimeZone::UTC);
+}
+
+QDateTime CadenceEstimator::nextExpected() const
+{
+	return isValid() ? QDateTime::fromMSecsSinceEpoch(m_timestamps.last() + m_period, QTimeZone::UTC) : QDateTime();
+}
+
+void CadenceEstimator::estimate()
+{
+	if (m_timestamps.size() < CADENCE_SAMPLES_MIN)
+	{
+		m_period = 0;
+		return;
+	}
+
+	// the smallest delta is the best guess for a single period, larger deltas are
+	// (close to) multiples of it when updates have been missed in between...
+	QList<qint64> deltas;
+	deltas.reserve(m_timestamps.size() - 1);
+	for (qsizetype i = 1; i < m_timestamps.size(); i++)
+	{
+		deltas.append(m_timestamps.at(i) - m_timestamps.at(i - 1));
+	}
+	const qint64 base = *std::min_element(deltas.cbegin(), deltas.cend());
+	for (qint64 &delta : deltas)
+	{
+		const qint64 n = qMax<qint64>(1, (delta + base / 2) / base);
+		delta /= n;
+	}
+
+	// ...the median of the normalized deltas is robust against single outliers
+	std::sort(deltas.begin(), deltas.end());
+	m_period = deltas.at(deltas.size() / 2);
+}
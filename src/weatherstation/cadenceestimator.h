@@ -0,0 +1,39 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef CADENCEESTIMATOR_H
+#define CADENCEESTIMATOR_H
+
+#include <QDateTime>
+#include <QList>
+
+/**
+ * @class CadenceEstimator estimates the publishing period and phase of a weather station
+ * from the timestamps of its last updates. Missed updates (gaps of multiple periods) are
+ * taken into account, so polling slower than the station publishes still gives the right period.
+ */
+class CadenceEstimator
+{
+public:
+	explicit CadenceEstimator();
+	~CadenceEstimator() = default;
+
+	void addTimestamp(const QDateTime &timestamp); // timestamps not newer than the last one are ignored
+	void clear();
+
+	bool isValid() const { return m_period > 0; }
+	qint64 period() const { return m_period; } // in msecs, 0 if unknown
+	QDateTime lastTimestamp() const;
+	QDateTime nextExpected() const; // expected timestamp of next update (invalid if unknown)
+
+private:
+	void estimate();
+
+	QList<qint64> m_timestamps; // msecs since epoch, oldest first
+	qint64 m_period;
+};
+
+#endif // CADENCEESTIMATOR_H
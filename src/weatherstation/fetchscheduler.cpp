@@ -0,0 +1,293 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "fetchscheduler.h"
+#include "abstractweatherstation.h"
+#include "stationregistry.h"
+#include "hosthealth.h"
+
+#include <QRandomGenerator>
+#include <QtMath>
+#include <QTimer>
+
+static const qint64 INFLIGHT_TIMEOUT_MSEC = 60 * 1000;      // drivers time out after 15sec., this is just a safety net
+static const int    STATS_INTERVAL_MSEC   = 10 * 60 * 1000; // log queue statistics every 10min.
+
+FetchScheduler *FetchScheduler::s_instance = nullptr;
+
+
+FetchScheduler::FetchScheduler(const SchedulerConfig &config, QObject *parent) :
+    QObject(parent),
+    m_log("FetchScheduler"),
+    m_config(config),
+    m_providers(),
+    m_inFlight(),
+    m_hosts(),
+    m_next(0),
+    m_clock(),
+    m_timer(new QTimer(this)),
+    m_statsTimer(new QTimer(this))
+{
+	Q_ASSERT(!s_instance);
+	s_instance = this;
+	m_clock.start();
+	m_timer->setSingleShot(true);
+	connect(m_timer, &QTimer::timeout, this, &FetchScheduler::dispatch);
+	connect(m_statsTimer, &QTimer::timeout, this, &FetchScheduler::logStats);
+	m_statsTimer->start(STATS_INTERVAL_MSEC);
+}
+
+FetchScheduler::~FetchScheduler()
+{
+	if (s_instance == this)
+	{
+		s_instance = nullptr;
+	}
+	qDeleteAll(m_hosts);
+	m_hosts.clear();
+}
+
+void FetchScheduler::setConfig(const SchedulerConfig &config)
+{
+	m_config = config;
+	for (Provider &p : m_providers)
+	{
+		p.rate = config.rate(p.name);
+		p.burst = config.burst(p.name);
+		p.tokens = qMin(p.tokens, static_cast<double>(p.burst));
+	}
+	m_timer->start(0);
+}
+
+FetchScheduler::Provider &FetchScheduler::provider(const QString &name)
+{
+	for (Provider &p : m_providers)
+	{
+		if (p.name == name)
+		{
+			return p;
+		}
+	}
+	const int burst = m_config.burst(name);
+	m_providers.append(Provider{name, static_cast<double>(burst), m_config.rate(name), burst, m_clock.elapsed(),
+	                            QList<Request>(), ProviderStats{0, 0, 0, 0}});
+	return m_providers.last();
+}
+
+HostHealth *FetchScheduler::health(const QString &host)
+{
+	HostHealth *h = m_hosts.value(host);
+	if (!h)
+	{
+		h = new HostHealth(host);
+		m_hosts.insert(host, h);
+	}
+	return h;
+}
+
+void FetchScheduler::refill(Provider &p, qint64 now) const
+{
+	p.tokens = qMin(static_cast<double>(p.burst), p.tokens + (now - p.lastRefill) * p.rate / 1000.0);
+	p.lastRefill = now;
+}
+
+void FetchScheduler::enqueue(AbstractWeatherStation *station, bool jitter)
+{
+	const StationRegistry::Provider *info = StationRegistry::instance().provider(station->config().stationType());
+	if (!info || !(info->capabilities & StationRegistry::RequiresPolling))
+	{
+		station->startUpdate(); // station pushes its data, nothing to limit
+		return;
+	}
+	if (m_inFlight.contains(station))
+	{
+		return; // update already running
+	}
+
+	const qint64 now = m_clock.elapsed();
+	const qint64 notBefore = now + ((jitter && m_config.startJitter() > 0) ? QRandomGenerator::global()->bounded(m_config.startJitter() * 1000) : 0);
+	Provider &p = provider(info->element);
+	for (Request &req : p.queue)
+	{
+		if (req.station == station)
+		{
+			req.notBefore = qMin(req.notBefore, notBefore); // already queued
+			m_timer->start(0);
+			return;
+		}
+	}
+	p.queue.append(Request{station, station->remoteHost(), now, notBefore});
+	p.stats.queued = p.queue.size();
+	connect(station, &AbstractWeatherStation::updateFinished, this, &FetchScheduler::onUpdateFinished, Qt::UniqueConnection);
+	if (!m_timer->isActive() || m_timer->remainingTime() > notBefore - now)
+	{
+		m_timer->start(static_cast<int>(notBefore - now));
+	}
+}
+
+void FetchScheduler::remove(AbstractWeatherStation *station)
+{
+	const QString host = m_inFlight.take(station).host;
+	if (!host.isEmpty())
+	{
+		health(host)->requestCancelled();
+	}
+	for (Provider &p : m_providers)
+	{
+		for (int i = p.queue.size() - 1; i >= 0; i--)
+		{
+			if (p.queue.at(i).station == station)
+			{
+				p.queue.removeAt(i);
+			}
+		}
+		p.stats.queued = p.queue.size();
+	}
+	disconnect(station, &AbstractWeatherStation::updateFinished, this, &FetchScheduler::onUpdateFinished);
+	m_timer->start(0); // may free a slot
+}
+
+void FetchScheduler::onUpdateFinished(bool success)
+{
+	AbstractWeatherStation *station = qobject_cast<AbstractWeatherStation*>(sender());
+	if (station && m_inFlight.contains(station))
+	{
+		finished(station, success, !success && station->networkError()); // bad data is no reason to back off the host
+		m_timer->start(0); // don't dispatch from within the station's signal
+	}
+}
+
+void FetchScheduler::finished(AbstractWeatherStation *station, bool success, bool hostFailed)
+{
+	if (!m_inFlight.contains(station))
+	{
+		return; // already released (stalled)
+	}
+	const Running running = m_inFlight.take(station);
+	const qint64 now = m_clock.elapsed();
+	if (!running.host.isEmpty())
+	{
+		health(running.host)->reportResult(!hostFailed, now);
+	}
+	station->metrics()->polled(now - running.started, success);
+}
+
+void FetchScheduler::dispatch()
+{
+	const qint64 now = m_clock.elapsed();
+	QList<AbstractWeatherStation*> stalled;
+	for (QHash<AbstractWeatherStation*, Running>::const_iterator it = m_inFlight.constBegin(); it != m_inFlight.constEnd(); ++it)
+	{
+		if (now - it.value().started > INFLIGHT_TIMEOUT_MSEC)
+		{
+			stalled << it.key();
+		}
+	}
+	foreach (AbstractWeatherStation *station, stalled)
+	{
+		LOGGER_WARNING(m_log, QString("station #%1 did not finish its update, releasing slot").arg(station->stationId()));
+		finished(station, false, true);
+	}
+
+	qint64 wakeUp = -1;
+	while (m_inFlight.size() < m_config.maxInFlight() && !m_providers.isEmpty())
+	{
+		bool served = false;
+		wakeUp = -1;
+		for (int n = 0; n < m_providers.size() && !served; n++)
+		{
+			const int index = (m_next + n) % m_providers.size();
+			Provider &p = m_providers[index];
+			int ready = -1;
+			for (int i = 0; i < p.queue.size() && ready < 0; i++)
+			{
+				const Request &req = p.queue.at(i);
+				qint64 readyAt = req.notBefore;
+				if (readyAt <= now && !req.host.isEmpty() && !health(req.host)->allowRequest(now))
+				{
+					// host is failing: wait for the circuit to become half-open (or the probe to finish)
+					readyAt = (health(req.host)->state() == HostHealth::Open) ? health(req.host)->retryAt() : -1;
+				}
+				if (readyAt >= 0 && readyAt <= now)
+				{
+					ready = i;
+				} else if (readyAt > now && (wakeUp < 0 || readyAt - now < wakeUp))
+				{
+					wakeUp = readyAt - now;
+				}
+			}
+			if (ready < 0)
+			{
+				continue;
+			}
+
+			refill(p, now);
+			if (p.tokens < 1.0)
+			{
+				const qint64 untilToken = qCeil((1.0 - p.tokens) * 1000.0 / p.rate);
+				wakeUp = (wakeUp < 0) ? untilToken : qMin(wakeUp, untilToken);
+				continue;
+			}
+
+			const Request req = p.queue.takeAt(ready);
+			const qint64 wait = now - req.enqueued;
+			p.tokens -= 1.0;
+			p.stats.requests++;
+			p.stats.waitTotal += wait;
+			p.stats.waitMax = qMax(p.stats.waitMax, wait);
+			p.stats.queued = p.queue.size();
+			m_next = (index + 1) % m_providers.size(); // next provider's turn
+			if (!req.host.isEmpty())
+			{
+				health(req.host)->requestStarted();
+			}
+			m_inFlight.insert(req.station, Running{now, req.host});
+			served = true;
+			req.station->startUpdate();
+		}
+		if (!served)
+		{
+			break;
+		}
+	}
+
+	if (wakeUp >= 0 && m_inFlight.size() < m_config.maxInFlight())
+	{
+		m_timer->start(static_cast<int>(qMax<qint64>(1, wakeUp)));
+	}
+}
+
+QStringList FetchScheduler::providers() const
+{
+	QStringList list;
+	for (const Provider &p : m_providers)
+	{
+		list << p.name;
+	}
+	return list;
+}
+
+FetchScheduler::ProviderStats FetchScheduler::stats(const QString &provider) const
+{
+	for (const Provider &p : m_providers)
+	{
+		if (p.name == provider)
+		{
+			return p.stats;
+		}
+	}
+	return ProviderStats{0, 0, 0, 0};
+}
+
+void FetchScheduler::logStats()
+{
+	for (const Provider &p : std::as_const(m_providers))
+	{
+		LOGGER_DEBUG(m_log, QString("%1: %2 requests, queue wait avg. %3ms, max. %4ms, %5 queued")
+		                    .arg(p.name).arg(p.stats.requests).arg(p.stats.requests ? p.stats.waitTotal / static_cast<qint64>(p.stats.requests) : 0)
+		                    .arg(p.stats.waitMax).arg(p.stats.queued));
+	}
+}
@@ -0,0 +1,104 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef FETCHSCHEDULER_H
+#define FETCHSCHEDULER_H
+
+#include <QObject>
+#include <QList>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QElapsedTimer>
+#include "logger.h"
+#include "config/schedulerconfig.h"
+
+class QTimer;
+class HostHealth;
+class AbstractWeatherStation;
+
+/**
+ * @class FetchScheduler starts the updates of all polled weather stations. Requests are queued per provider
+ * and served round-robin across providers, limited by a token bucket per provider (rate/burst) and a global
+ * limit of requests in flight. A station is queued at most once, so it cannot starve others.
+ * Requests to a remote host that keeps failing are held back by the host's circuit breaker (@ref HostHealth).
+ */
+class FetchScheduler : public QObject
+{
+	Q_OBJECT
+public:
+	struct ProviderStats
+	{
+		quint64 requests;  // requests started
+		qint64 waitTotal;  // sum of queue wait times (msec)
+		qint64 waitMax;    // max. queue wait time (msec)
+		int queued;        // currently queued requests
+	};
+
+	explicit FetchScheduler(const SchedulerConfig &config, QObject *parent = nullptr);
+	virtual ~FetchScheduler() Q_DECL_OVERRIDE;
+
+	static FetchScheduler *instance() { return s_instance; }
+
+	void setConfig(const SchedulerConfig &config);
+	void enqueue(AbstractWeatherStation *station, bool jitter = false);
+	void remove(AbstractWeatherStation *station);
+
+	int inFlight() const { return m_inFlight.size(); }
+	QStringList providers() const;
+	ProviderStats stats(const QString &provider) const;
+	const HostHealth *hostHealth(const QString &host) const { return m_hosts.value(host); }
+
+private slots:
+	void dispatch();
+	void onUpdateFinished(bool success);
+	void logStats();
+
+private:
+	struct Request
+	{
+		AbstractWeatherStation *station;
+		QString host;     // remote host (circuit breaker), empty if none
+		qint64 enqueued;  // msecs (scheduler clock)
+		qint64 notBefore; // jittered start
+	};
+
+	struct Provider
+	{
+		QString name;
+		double tokens;
+		double rate;
+		int burst;
+		qint64 lastRefill;
+		QList<Request> queue;
+		ProviderStats stats;
+	};
+
+	struct Running
+	{
+		qint64 started;
+		QString host;
+	};
+
+	Provider &provider(const QString &name);
+	HostHealth *health(const QString &host);
+	void finished(AbstractWeatherStation *station, bool success, bool hostFailed);
+	void refill(Provider &p, qint64 now) const;
+
+	static FetchScheduler *s_instance;
+
+	Logger m_log;
+	SchedulerConfig m_config;
+	QList<Provider> m_providers;
+	QHash<AbstractWeatherStation*, Running> m_inFlight;
+	QHash<QString, HostHealth*> m_hosts;
+	int m_next; // round-robin index
+	QElapsedTimer m_clock;
+	QTimer *m_timer;
+	QTimer *m_statsTimer;
+};
+
+#endif // FETCHSCHEDULER_H
@@ -8,6 +8,7 @@
 #include "application.h"
 #include "config.h"
 #include "gpio.h"
+#include "stationregistry.h"
 
 #include <QNetworkAccessManager>
 #include <QNetworkRequest>
@@ -41,9 +42,26 @@ static const char HOLFUY_API_URL[]          = "http://api.holfuy.com/live/?s=%1&
 //static const char HOLFUY_API_URL[] = "http://api.holfuy.com/live/?s=%1&pw=%2&m=JSON&tu=C&su=km/h&avg=1&utc"; // 15min average data
 
 
+static AbstractWeatherStation *createStation(const StationConfig &config, QObject *parent)
+{
+	return new HolfuyApi(config, parent);
+}
+static const StationRegistry::Registrar REGISTRAR(StationConfig::HolfuyApi, CONFIG_ELEMENT_HOLFUYAPI, "HolfuyApi", StationRegistry::RequiresApiKey | StationRegistry::RequiresPolling, createStation);
+
+static void setDataLed()
+{
+	Application *app = qobject_cast<Application*>(qApp);
+	Gpio *gpio = app ? app->gpio() : nullptr;
+	if (gpio)
+	{
+		gpio->setGpio(LED_PIN_BLUE);
+	}
+}
+
+
 HolfuyApi::HolfuyApi(int id, const QString &apiKey, const QString &stationName, QObject *parent) :
     AbstractWeatherStation(parent),
-    m_log(QString("HolfuyApi-%1").arg(id)),
+    m_log(QString("HolfuyApi-%1").arg(id), Logger::Fields({{LOG_FIELD_STATION_ID, QString::number(id)}})),
     m_id(id),
     m_winddir(0),
     m_windspeed(0),
@@ -61,7 +79,7 @@ HolfuyApi::HolfuyApi(int id, const QString &apiKey, const QString &stationName,
 
 HolfuyApi::HolfuyApi(const StationConfig &config, QObject *parent) :
     AbstractWeatherStation(config, parent),
-    m_log(QString("HolfuyApi-%1").arg(config.stationId())),
+    m_log(QString("HolfuyApi-%1").arg(config.stationId()), Logger::Fields({{LOG_FIELD_STATION_ID, QString::number(config.stationId())}})),
     m_id(config.stationId()),
     m_winddir(0),
     m_windspeed(0),
@@ -112,6 +130,16 @@ QDateTime HolfuyApi::lastUpdate() const
 	return m_lastUpdate;
 }
 
+bool HolfuyApi::applyState(const WeatherHistory::Sample &sample)
+{
+	m_lastUpdate = QDateTime::fromMSecsSinceEpoch(sample.timestamp, QTimeZone::UTC);
+	m_winddir = sample.windDirection;
+	m_windspeed = sample.windSpeed;
+	m_gustspeed = sample.windGusts;
+	m_temperature = sample.temperature;
+	return true;
+}
+
 int HolfuyApi::windDirection() const
 {
 	return m_winddir;
@@ -150,6 +178,11 @@ AbstractWeatherStation::WeatherDataFlags HolfuyApi::availableData() const
 	        AbstractWeatherStation::Temperature); /// @todo: add humidity if available
 }
 
+QString HolfuyApi::remoteHost() const
+{
+	return providerUrl(HOLFUY_API_URL).host();
+}
+
 void HolfuyApi::update()
 {
 	if (!m_reply) // request still running?
@@ -161,8 +194,9 @@ void HolfuyApi::update()
 		{
 			gpio->clearGpio(LED_PIN_BLUE);
 		}
-		const QUrl url(QString(HOLFUY_API_URL).arg(m_id).arg(m_apiKey));
-		m_reply = m_netmgr->get(QNetworkRequest(url));
+		QNetworkRequest request(providerUrl(QString(HOLFUY_API_URL).arg(m_id).arg(m_apiKey)));
+		prepareRequest(request);
+		m_reply = m_netmgr->get(request);
 		connect(m_reply, &QNetworkReply::finished, this, &HolfuyApi::onReplyFinished);
 		m_timer->start(NETWORK_TIMEOUT);
 	}
@@ -175,16 +209,40 @@ void HolfuyApi::onReplyFinished()
 		return;
 	}
 
-	QByteArray data = m_reply->read(NETWORK_REPLY_SIZE_MAX);
-	QJsonDocument doc = QJsonDocument::fromJson(data);
-	m_reply->deleteLater();
+	QNetworkReply *reply = m_reply;
 	m_reply = nullptr;
+	m_timer->stop();
+	reply->deleteLater();
+
+	if (isNotModified(reply))
+	{
+		setDataLed();
+		emit updateFinished(true);
+		return;
+	}
+
+	if (reply->error() != QNetworkReply::NoError)
+	{
+		LOGGER_WARNING(m_log, QString("Request failed: %1").arg(reply->errorString()));
+		setNetworkError();
+		emit updateFinished(false);
+		return;
+	}
+
+	const QByteArray data = reply->read(NETWORK_REPLY_SIZE_MAX);
+	if (isContentUnchanged(data))
+	{
+		setDataLed();
+		emit updateFinished(true); // same data as before, nothing to parse
+		return;
+	}
 
-	m_log.debug(QString("json data: %1").arg(QString::fromLatin1(data)));
+	QJsonDocument doc = QJsonDocument::fromJson(data);
+	LOGGER_DEBUG(m_log, QString("json data: %1").arg(QString::fromLatin1(data)));
 
 	if (doc.isNull())
 	{
-		m_log.warning(QString("Failed to parse json data: '%1'").arg(QString::fromLatin1(data)));
+		LOGGER_WARNING(m_log, QString("Failed to parse json data: '%1'").arg(QString::fromLatin1(data)));
 		emit updateFinished(false);
 		return;
 	}
@@ -192,7 +250,7 @@ void HolfuyApi::onReplyFinished()
 	QJsonObject rootObj = doc.object();
 	if (!rootObj.contains(JSON_KEY_DATETIME) || !rootObj.contains(JSON_KEY_WIND))
 	{
-		m_log.warning(QString("Received incomplete data: '%1'").arg(QString::fromLatin1(data)));
+		LOGGER_WARNING(m_log, QString("Received incomplete data: '%1'").arg(QString::fromLatin1(data)));
 		emit updateFinished(false);
 		return;
 	}
@@ -214,7 +272,7 @@ void HolfuyApi::onReplyFinished()
 		QString unit(windObj.contains(JSON_KEY_WIND_UNIT) ? windObj.value(JSON_KEY_WIND_UNIT).toString() : "");
 		if (unit != unitWindSpeed())
 		{
-			m_log.warning(QString("Wrong unit for wind (expected '%1', got '%2')!").arg(unitWindSpeed(), unit));
+			LOGGER_WARNING(m_log, QString("Wrong unit for wind (expected '%1', got '%2')!").arg(unitWindSpeed(), unit));
 			emit updateFinished(false);
 			return;
 		}
@@ -251,19 +309,18 @@ void HolfuyApi::onReplyFinished()
 			emit lastUpdateChanged(m_lastUpdate);
 		}
 
-		m_log.info(QString("new data: wind=%1%2, gusts=%3%2, dir=%4, temp=%5%6, lastUpdate=%7")
-		           .arg(m_windspeed / 10.0).arg(unitWindSpeed()).arg(m_gustspeed / 10.0).arg(m_winddir)
-		           .arg(static_cast<double>(m_temperature / 10.0))
-		           .arg(unitTemperature(), m_lastUpdate.time().toString()));
+		LOGGER_INFO(m_log, QString("new data: wind=%1%2, gusts=%3%2, dir=%4, temp=%5%6, lastUpdate=%7")
+		                   .arg(m_windspeed / 10.0).arg(unitWindSpeed()).arg(m_gustspeed / 10.0).arg(m_winddir)
+		                   .arg(static_cast<double>(m_temperature / 10.0))
+		                   .arg(unitTemperature(), m_lastUpdate.time().toString()));
 
-		Application *app = qobject_cast<Application*>(qApp);
-		Gpio *gpio = app ? app->gpio() : nullptr;
-		if (gpio)
-		{
-			gpio->setGpio(LED_PIN_BLUE);
-		}
+		setDataLed();
+		setContentParsed(data, reply);
 		emit updateFinished(true);
+		return;
 	}
+	LOGGER_WARNING(m_log, QString("Received incomplete wind data: '%1'").arg(QString::fromLatin1(data)));
+	emit updateFinished(false);
 }
 
 void HolfuyApi::onTimeout()
@@ -271,11 +328,12 @@ void HolfuyApi::onTimeout()
 	if (m_reply)
 	{
 		QNetworkReply *tmp = m_reply;
-		m_log.warning(QString("Request timed out: %1").arg(tmp->request().url().toDisplayString()));
+		LOGGER_WARNING(m_log, QString("Request timed out: %1").arg(tmp->request().url().toDisplayString()));
 		m_reply = 0;
 		tmp->disconnect();
 		tmp->abort();
 		tmp->deleteLater();
+		setNetworkError();
 		emit updateFinished(false);
 	}
 }
@@ -33,6 +33,7 @@ public:
 	QString stationName() const override;
 
 	WeatherDataFlags availableData() const override;
+	QString remoteHost() const override;
 
 public slots:
 	void update() override;
@@ -43,6 +44,7 @@ private slots:
 
 protected:
 	void init();
+	bool applyState(const WeatherHistory::Sample &sample) override;
 
 private:
 	mutable Logger m_log;
@@ -8,26 +8,48 @@
 #include "application.h"
 #include "config.h"
 #include "gpio.h"
+#include "stationregistry.h"
 #include "config/stationconfig.h"
 
 #include <QNetworkAccessManager>
 #include <QNetworkRequest>
 #include <QNetworkReply>
 #include <QDateTime>
-#include <QBuffer>
 #include <QTimer>
 #include <QUrl>
+#include <QTimeZone>
 
-static const qint64 NETWORK_REPLY_SIZE_MAX = 5120; // do not parse more than 5kb
+static const qint64 NETWORK_REPLY_SIZE_MAX = 5120; // do not read more than 5kb
 static const int  NETWORK_TIMEOUT          = 15 * 1000; // 15sec
 static const char NETWORK_HOLFUY_URL[]     = "https://widget.holfuy.com/?station=%1&su=km/h&t=C&lang=en&mode=rose&size=160";
 static const char DATA_DELIMITER_START[]   = "newWind(";
 static const char DATA_DELIMITER_STOP[]    = ");";
+static const qsizetype DATA_DELIMITER_START_SIZE = sizeof(DATA_DELIMITER_START) - 1;
+static const qsizetype DATA_DELIMITER_STOP_SIZE  = sizeof(DATA_DELIMITER_STOP) - 1;
+static const char DATA_SEP                 = ',';
+static const int  DATA_FIELD_COUNT         = 5; // <dir>,<wind>,<temparature>,<gusts>,'HH:mm'
+
+
+static AbstractWeatherStation *createStation(const StationConfig &config, QObject *parent)
+{
+	return new HolfuyWidget(config, parent);
+}
+static const StationRegistry::Registrar REGISTRAR(StationConfig::HolfuyWidget, CONFIG_ELEMENT_HOLFUYWIDGET, "HolfuyWidget", StationRegistry::RequiresPolling, createStation);
+
+static void setDataLed()
+{
+	Application *app = qobject_cast<Application*>(qApp);
+	Gpio *gpio = app ? app->gpio() : nullptr;
+	if (gpio)
+	{
+		gpio->setGpio(LED_PIN_BLUE);
+	}
+}
 
 
 HolfuyWidget::HolfuyWidget(int id, const QString &stationName, QObject *parent) :
     AbstractWeatherStation(parent),
-    m_log(QString("HolfuyWidget-%1").arg(id)),
+    m_log(QString("HolfuyWidget-%1").arg(id), Logger::Fields({{LOG_FIELD_STATION_ID, QString::number(id)}})),
     m_id(id),
     m_winddir(-1),
     m_windspeed(-1),
@@ -35,6 +57,8 @@ HolfuyWidget::HolfuyWidget(int id, const QString &stationName, QObject *parent)
     m_temperature(AbstractWeatherStation::TemperatureInvalid * 10),
     m_name(stationName),
     m_lastUpdate(),
+    m_buffer(),
+    m_dataStart(-1),
     m_reply(nullptr),
     m_netmgr(new QNetworkAccessManager(this)),
     m_timer(new QTimer(this))
@@ -44,7 +68,7 @@ HolfuyWidget::HolfuyWidget(int id, const QString &stationName, QObject *parent)
 
 HolfuyWidget::HolfuyWidget(const StationConfig &config, QObject *parent) :
     AbstractWeatherStation(config, parent),
-    m_log(QString("HolfuyWidget-%1").arg(config.stationId())),
+    m_log(QString("HolfuyWidget-%1").arg(config.stationId()), Logger::Fields({{LOG_FIELD_STATION_ID, QString::number(config.stationId())}})),
     m_id(config.stationId()),
     m_winddir(-1),
     m_windspeed(-1),
@@ -52,6 +76,8 @@ HolfuyWidget::HolfuyWidget(const StationConfig &config, QObject *parent) :
     m_temperature(AbstractWeatherStation::TemperatureInvalid * 10),
     m_name(config.stationName()),
     m_lastUpdate(),
+    m_buffer(),
+    m_dataStart(-1),
     m_reply(nullptr),
     m_netmgr(new QNetworkAccessManager(this)),
     m_timer(new QTimer(this))
@@ -68,12 +94,7 @@ HolfuyWidget::~HolfuyWidget()
 		gpio->clearGpio(LED_PIN_BLUE);
 	}
 
-	if (m_reply)
-	{
-		m_reply->abort();
-		m_reply->deleteLater();
-		m_reply = nullptr;
-	}
+	releaseReply();
 }
 
 void HolfuyWidget::init()
@@ -94,6 +115,16 @@ QDateTime HolfuyWidget::lastUpdate() const
 	return m_lastUpdate;
 }
 
+bool HolfuyWidget::applyState(const WeatherHistory::Sample &sample)
+{
+	m_lastUpdate = QDateTime::fromMSecsSinceEpoch(sample.timestamp, QTimeZone::UTC);
+	m_winddir = sample.windDirection;
+	m_windspeed = sample.windSpeed;
+	m_gustspeed = sample.windGusts;
+	m_temperature = sample.temperature;
+	return true;
+}
+
 int HolfuyWidget::windDirection() const
 {
 	return m_winddir;
@@ -132,6 +163,11 @@ AbstractWeatherStation::WeatherDataFlags HolfuyWidget::availableData() const
 	        AbstractWeatherStation::Temperature);
 }
 
+QString HolfuyWidget::remoteHost() const
+{
+	return providerUrl(NETWORK_HOLFUY_URL).host();
+}
+
 void HolfuyWidget::update()
 {
 	if (!m_reply) // request still running?
@@ -143,112 +179,205 @@ void HolfuyWidget::update()
 		{
 			gpio->clearGpio(LED_PIN_BLUE);
 		}
-		const QUrl url(QString(NETWORK_HOLFUY_URL).arg(m_id));
+		const QUrl url(providerUrl(QString(NETWORK_HOLFUY_URL).arg(m_id)));
+		m_buffer.clear();
+		m_dataStart = -1;
 		m_reply = m_netmgr->get(QNetworkRequest(url));
+		connect(m_reply, &QNetworkReply::readyRead, this, &HolfuyWidget::onReadyRead);
 		connect(m_reply, &QNetworkReply::finished, this, &HolfuyWidget::onReplyFinished);
 		m_timer->start(NETWORK_TIMEOUT);
 	}
 }
 
-void HolfuyWidget::onReplyFinished()
+void HolfuyWidget::releaseReply()
+{
+	m_timer->stop();
+	if (m_reply)
+	{
+		QNetworkReply *tmp = m_reply;
+		m_reply = nullptr;
+		tmp->disconnect(this);
+		if (tmp->isRunning())
+		{
+			tmp->abort(); // we've got all we need, do not download the rest of the page
+		}
+		tmp->deleteLater();
+	}
+}
+
+void HolfuyWidget::onReadyRead()
 {
 	if (!m_reply)
 	{
 		return;
 	}
 
-	bool convOk;
-	QTime time;
-	QDateTime dt = QDateTime::currentDateTime().toLocalTime();
-	QString html = QString::fromUtf8(m_reply->read(NETWORK_REPLY_SIZE_MAX));
-	int dir, wind, gust, temp;
-	int error = -1;
-	int indexStart = html.indexOf(DATA_DELIMITER_START);
-	int indexStop = html.indexOf(DATA_DELIMITER_STOP, indexStart);
-
-	m_reply->deleteLater();
-	m_reply = 0;
+	// scan incoming chunks for "newWind(...);" without converting the html into a QString,
+	// only the bytes that arrived since the last call are searched (overlapping by delimiter size - 1)
+	const qsizetype prevSize = m_buffer.size();
+	m_buffer.append(m_reply->read(NETWORK_REPLY_SIZE_MAX - prevSize));
 
-	if (indexStart > 0)
+	if (m_dataStart < 0)
 	{
-		const int delsize = strlen(DATA_DELIMITER_START);
-		const QString rawdata = html.mid(indexStart + delsize, indexStop - (indexStart + delsize));
-		const QStringList data = rawdata.split(',', Qt::SkipEmptyParts);
-
-		/// example data: 173,3,6.2,4,'02:09'
-		/// format: <dir>,<wind>,<temparature>,<gusts>,'HH:mm'
-		if (data.count() >= 5)
+		const qsizetype indexStart = m_buffer.indexOf(DATA_DELIMITER_START, qMax<qsizetype>(0, prevSize - DATA_DELIMITER_START_SIZE + 1));
+		if (indexStart >= 0)
 		{
-			dir = data.at(0).toInt(&convOk);
-			error = convOk ? 0 : 1;
-			wind = data.at(1).toInt(&convOk) * 10;
-			error += convOk ? 0 : 1;
-			gust = data.at(3).toInt(&convOk) * 10;
-			error += convOk ? 0 : 1;
-			temp = static_cast<int>(data.at(2).toDouble(&convOk) * 10);
-			error += convOk ? 0 : 1;
-			time = QTime::fromString(data.at(4).mid(1, 5), Qt::TextDate);
-			error += time.isValid() ? 0 : 1;
+			m_dataStart = indexStart + DATA_DELIMITER_START_SIZE;
 		}
-		if (error)
+	}
+
+	if (m_dataStart >= 0)
+	{
+		const qsizetype indexStop = m_buffer.indexOf(DATA_DELIMITER_STOP, qMax(m_dataStart, prevSize - DATA_DELIMITER_STOP_SIZE + 1));
+		if (indexStop >= 0)
 		{
-			m_log.warning(QString("Failed to parse weather station data from string: '%1'").arg(rawdata));
+			releaseReply();
+			processData(QByteArrayView(m_buffer).sliced(m_dataStart, indexStop - m_dataStart));
 			return;
 		}
-		if (m_winddir != dir)
-		{
-			m_winddir = dir;
-			emit windDirectionChanged(m_winddir);
-		}
-		if (m_windspeed != wind)
-		{
-			m_windspeed = wind;
-			emit windSpeedChanged(m_windspeed);
-		}
-		if (m_gustspeed != gust)
-		{
-			m_gustspeed = gust;
-			emit windGustsChanged(m_gustspeed);
-		}
-		if (m_temperature != temp)
+	}
+
+	if (m_buffer.size() >= NETWORK_REPLY_SIZE_MAX)
+	{
+		releaseReply();
+		LOGGER_WARNING(m_log, QString("reply contains no (valid) weather data within the first %1 bytes!").arg(NETWORK_REPLY_SIZE_MAX));
+		emit updateFinished(false);
+	}
+}
+
+void HolfuyWidget::onReplyFinished()
+{
+	if (!m_reply)
+	{
+		return;
+	}
+
+	onReadyRead(); // consume whatever is left, this releases the reply if weather data was found
+	if (!m_reply)
+	{
+		return;
+	}
+
+	const QString error = m_reply->error() != QNetworkReply::NoError ? m_reply->errorString() : QString();
+	releaseReply();
+	if (!error.isEmpty())
+	{
+		LOGGER_WARNING(m_log, QString("Request failed: %1").arg(error));
+		setNetworkError();
+	} else
+	{
+		LOGGER_WARNING(m_log, "reply contains no (valid) weather data!");
+	}
+	emit updateFinished(false);
+}
+
+void HolfuyWidget::processData(QByteArrayView rawdata)
+{
+	// the widget is a dynamic html page without http validators (and the transfer gets aborted anyway),
+	// so only the extracted weather data is compared with the previous update
+	if (isContentUnchanged(rawdata))
+	{
+		setDataLed();
+		emit updateFinished(true);
+		return;
+	}
+
+	/// example data: 173,3,6.2,4,'02:09'
+	/// format: <dir>,<wind>,<temparature>,<gusts>,'HH:mm'
+	QByteArrayView data[DATA_FIELD_COUNT];
+	int count = 0;
+	qsizetype fieldStart = 0;
+	for (qsizetype i = 0; i <= rawdata.size() && count < DATA_FIELD_COUNT; i++)
+	{
+		if (i == rawdata.size() || rawdata.at(i) == DATA_SEP)
 		{
-			m_temperature = temp;
-			emit temperatureChanged(m_temperature);
+			data[count++] = rawdata.sliced(fieldStart, i - fieldStart).trimmed();
+			fieldStart = i + 1;
 		}
-		dt.setTime(time);
-		if (dt.isValid() && m_lastUpdate != dt)
+	}
+
+	bool convOk;
+	int dir = 0, wind = 0, gust = 0, temp = 0;
+	int error = -1;
+	QTime time;
+	if (count == DATA_FIELD_COUNT)
+	{
+		dir = data[0].toInt(&convOk);
+		error = convOk ? 0 : 1;
+		wind = data[1].toInt(&convOk) * 10;
+		error += convOk ? 0 : 1;
+		gust = data[3].toInt(&convOk) * 10;
+		error += convOk ? 0 : 1;
+		temp = static_cast<int>(data[2].toDouble(&convOk) * 10);
+		error += convOk ? 0 : 1;
+
+		QByteArrayView hhmm = data[4];
+		if (hhmm.startsWith('\''))
 		{
-			m_lastUpdate = dt;
-			emit lastUpdateChanged(m_lastUpdate);
+			hhmm = hhmm.sliced(1);
 		}
-		m_log.info(QString("new data: wind=%1%2, gusts=%3%2, dir=%4, temp=%5%6, lastUpdate=%7")
-		           .arg(m_windspeed / 10.0).arg(unitWindSpeed()).arg(m_gustspeed / 10.0).arg(m_winddir)
-		           .arg(static_cast<double>(m_temperature / 10.0))
-		           .arg(unitTemperature(), m_lastUpdate.time().toString()));
-		Application *app = qobject_cast<Application*>(qApp);
-		Gpio *gpio = app ? app->gpio() : nullptr;
-		if (gpio)
+		if (hhmm.size() >= 5 && hhmm.at(2) == ':')
 		{
-			gpio->setGpio(LED_PIN_BLUE);
+			bool hourOk, minOk;
+			const int hour = hhmm.first(2).toInt(&hourOk);
+			const int min = hhmm.sliced(3, 2).toInt(&minOk);
+			if (hourOk && minOk)
+			{
+				time = QTime(hour, min);
+			}
 		}
-		emit updateFinished(true);
+		error += time.isValid() ? 0 : 1;
+	}
+	if (error)
+	{
+		LOGGER_WARNING(m_log, QString("Failed to parse weather station data from string: '%1'").arg(QString::fromLatin1(rawdata)));
+		emit updateFinished(false);
 		return;
 	}
-	m_log.warning("reply contains no (valid) weather data!");
-	emit updateFinished(false);
-//	m_log.debug(QString("data: %1").arg(buf.data()));
+
+	if (m_winddir != dir)
+	{
+		m_winddir = dir;
+		emit windDirectionChanged(m_winddir);
+	}
+	if (m_windspeed != wind)
+	{
+		m_windspeed = wind;
+		emit windSpeedChanged(m_windspeed);
+	}
+	if (m_gustspeed != gust)
+	{
+		m_gustspeed = gust;
+		emit windGustsChanged(m_gustspeed);
+	}
+	if (m_temperature != temp)
+	{
+		m_temperature = temp;
+		emit temperatureChanged(m_temperature);
+	}
+	QDateTime dt = QDateTime::currentDateTime().toLocalTime();
+	dt.setTime(time);
+	if (dt.isValid() && m_lastUpdate != dt)
+	{
+		m_lastUpdate = dt;
+		emit lastUpdateChanged(m_lastUpdate);
+	}
+	LOGGER_INFO(m_log, QString("new data: wind=%1%2, gusts=%3%2, dir=%4, temp=%5%6, lastUpdate=%7")
+	                   .arg(m_windspeed / 10.0).arg(unitWindSpeed()).arg(m_gustspeed / 10.0).arg(m_winddir)
+	                   .arg(static_cast<double>(m_temperature / 10.0))
+	                   .arg(unitTemperature(), m_lastUpdate.time().toString()));
+	setDataLed();
+	setContentParsed(rawdata);
+	emit updateFinished(true);
 }
 
 void HolfuyWidget::onTimeout()
 {
 	if (m_reply)
 	{
-		QNetworkReply *tmp = m_reply;
-		m_log.warning(QString("Request timed out: %1").arg(tmp->request().url().toDisplayString()));
-		m_reply = 0;
-		tmp->disconnect();
-		tmp->abort();
-		tmp->deleteLater();
+		LOGGER_WARNING(m_log, QString("Request timed out: %1").arg(m_reply->request().url().toDisplayString()));
+		releaseReply();
+		setNetworkError();
 		emit updateFinished(false);
 	}
 }
@@ -9,6 +9,7 @@
 
 #include "abstractweatherstation.h"
 #include "logger.h"
+#include <QByteArrayView>
 
 class QTimer;
 class QNetworkReply;
@@ -39,16 +40,21 @@ public:
 	QString stationName() const override;
 
 	WeatherDataFlags availableData() const override;
+	QString remoteHost() const override;
 
 public slots:
 	void update() override;
 
 private slots:
+	void onReadyRead();
 	void onReplyFinished();
 	void onTimeout();
 
 protected:
 	void init();
+	bool applyState(const WeatherHistory::Sample &sample) override;
+	void releaseReply();
+	void processData(QByteArrayView rawdata);
 
 private:
 	mutable Logger m_log;
@@ -59,6 +65,8 @@ private:
 	int m_temperature;
 	QString m_name;
 	QDateTime m_lastUpdate;
+	QByteArray m_buffer;
+	qsizetype m_dataStart;
 	QNetworkReply *m_reply;
 	QNetworkAccessManager *m_netmgr;
 	QTimer *m_timer;
@@ -0,0 +1,108 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "hosthealth.h"
+
+#include <QRandomGenerator>
+
+static const int    FAILURE_THRESHOLD    = 3;               // open circuit after 3 consecutive failures
+static const qint64 BACKOFF_MIN_MSEC     = 30 * 1000;
+static const qint64 BACKOFF_MAX_MSEC     = 15 * 60 * 1000;
+static const int    BACKOFF_JITTER_PCT   = 20;
+
+
+HostHealth::HostHealth(const QString &host) :
+    m_log(QString("HostHealth-%1").arg(host)),
+    m_host(host),
+    m_state(Closed),
+    m_failures(0),
+    m_trips(0),
+    m_retryAt(0),
+    m_probeRunning(false)
+{
+}
+
+QString HostHealth::stateToString(State state)
+{
+	switch (state)
+	{
+		case Closed:   return "closed";
+		case Open:     return "open";
+		case HalfOpen: return "half-open";
+		default:       return "unknown";
+	}
+}
+
+void HostHealth::setState(State state)
+{
+	if (state != m_state)
+	{
+		m_log.info(QString("circuit %1 -> %2").arg(stateToString(m_state), stateToString(state)));
+		m_state = state;
+	}
+}
+
+bool HostHealth::allowRequest(qint64 now)
+{
+	switch (m_state)
+	{
+		case Closed:
+			return true;
+		case Open:
+			if (now < m_retryAt)
+			{
+				return false;
+			}
+			setState(HalfOpen);
+			m_probeRunning = false;
+			Q_FALLTHROUGH();
+		case HalfOpen:
+			if (m_probeRunning)
+			{
+				return false; // only a single probe
+			}
+			return true;
+	}
+	return true;
+}
+
+void HostHealth::requestStarted()
+{
+	if (m_state == HalfOpen)
+	{
+		m_probeRunning = true;
+	}
+}
+
+void HostHealth::requestCancelled()
+{
+	m_probeRunning = false; // no result, allow another probe
+}
+
+void HostHealth::reportResult(bool success, qint64 now)
+{
+	if (success)
+	{
+		m_failures = 0;
+		m_trips = 0;
+		m_probeRunning = false;
+		setState(Closed);
+		return;
+	}
+
+	m_failures++;
+	if (m_state == HalfOpen || (m_state == Closed && m_failures >= FAILURE_THRESHOLD))
+	{
+		qint64 backoff = BACKOFF_MIN_MSEC << qMin(m_trips, 10);
+		backoff = qMin(backoff, BACKOFF_MAX_MSEC);
+		backoff += backoff * (QRandomGenerator::global()->bounded(2 * BACKOFF_JITTER_PCT + 1) - BACKOFF_JITTER_PCT) / 100;
+		m_trips++;
+		m_retryAt = now + backoff;
+		m_probeRunning = false;
+		LOGGER_WARNING(m_log, QString("%1 consecutive failures, suppressing requests for %2sec.").arg(m_failures).arg(backoff / 1000));
+		setState(Open);
+	}
+}
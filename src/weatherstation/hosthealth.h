@@ -0,0 +1,54 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef HOSTHEALTH_H
+#define HOSTHEALTH_H
+
+#include <QString>
+#include "logger.h"
+
+/**
+ * @class HostHealth is a circuit breaker for a remote host. After a number of consecutive failures the
+ * circuit opens and requests to the host are suppressed for a backoff time (doubling with every failed
+ * attempt, randomized by +/-20%). Afterwards a single probe request is allowed (half-open), its result
+ * either closes the circuit again or re-opens it.
+ */
+class HostHealth
+{
+public:
+	enum State
+	{
+		Closed,
+		Open,
+		HalfOpen
+	};
+
+	explicit HostHealth(const QString &host);
+	~HostHealth() = default;
+
+	QString host() const { return m_host; }
+	State state() const { return m_state; }
+	static QString stateToString(State state);
+
+	bool allowRequest(qint64 now);    // msecs (monotonic), transitions open -> half-open once backoff expired
+	void requestStarted();
+	void requestCancelled();
+	void reportResult(bool success, qint64 now);
+	qint64 retryAt() const { return m_retryAt; } // while open: time the probe is allowed
+
+private:
+	void setState(State state);
+
+	Logger m_log;
+	const QString m_host;
+	State m_state;
+	int m_failures;  // consecutive failures
+	int m_trips;     // consecutive times the circuit opened (backoff exponent)
+	qint64 m_retryAt;
+	bool m_probeRunning;
+};
+
+#endif // HOSTHEALTH_H
@@ -0,0 +1,259 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "mqttstation.h"
+#include "config.h"
+#include "stationregistry.h"
+#include "mqtt/mqttclient.h"
+#include "config/stationconfig.h"
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QTimeZone>
+#include <QTimer>
+
+static const quint16 MQTT_PORT_DEFAULT     = 1883;
+static const int     PUBLISH_DELAY_MSEC    = 200;  // collect values published on separate topics into one sample...
+static const qint64  SAMPLE_INTERVAL_MSEC  = 1000; // ...and do not create more than one sample per second
+
+static const char KEY_WIND[]               = "wind";
+static const char KEY_SPEED[]              = "speed";
+static const char KEY_GUST[]               = "gust";
+static const char KEY_DIR[]                = "dir";
+static const char KEY_DIRECTION[]          = "direction";
+static const char KEY_TEMP[]               = "temp";
+static const char KEY_TEMPERATURE[]        = "temperature";
+static const char KEY_HUMIDITY[]           = "humidity";
+
+static const char UNIT_KMH[]               = "km/h";
+static const char UNIT_MPS[]               = "m/s";
+static const char UNIT_KNOTS[]             = "kt";
+static const double KMH_PER_MPS            = 3.6;
+static const double KMH_PER_KNOT           = 1.852;
+
+
+static AbstractWeatherStation *createStation(const StationConfig &config, QObject *parent)
+{
+	return new MqttStation(config, parent);
+}
+static const StationRegistry::Registrar REGISTRAR(StationConfig::MqttStation, CONFIG_ELEMENT_MQTT, "MqttStation", StationRegistry::NoCapabilities, createStation);
+
+
+MqttStation::MqttStation(const StationConfig &config, QObject *parent) :
+    AbstractWeatherStation(config, parent),
+    m_log(QString("MqttStation-%1").arg(config.stationId()), Logger::Fields({{LOG_FIELD_STATION_ID, QString::number(config.stationId())}})),
+    m_id(config.stationId()),
+    m_name(config.stationName()),
+    m_topic(config.attribute(CONFIG_ATTR_TOPIC)),
+    m_speedFactor(1.0),
+    m_client(nullptr),
+    m_subscription(nullptr),
+    m_publishTimer(new QTimer(this)),
+    m_winddir(-1),
+    m_windspeed(-1),
+    m_gustspeed(-1),
+    m_temperature(AbstractWeatherStation::TemperatureInvalid * 10),
+    m_humidity(-1),
+    m_lastUpdate(),
+    m_available(NoData)
+{
+	const QString unit = config.attribute(CONFIG_ATTR_SPEED_UNIT, UNIT_KMH);
+	if (unit == UNIT_MPS)
+	{
+		m_speedFactor = KMH_PER_MPS;
+	} else if (unit == UNIT_KNOTS)
+	{
+		m_speedFactor = KMH_PER_KNOT;
+	} else if (unit != UNIT_KMH)
+	{
+		LOGGER_ERROR(m_log, QString("unknown speed unit '%1', using '%2'").arg(unit, UNIT_KMH));
+	}
+
+	bool convOk;
+	int port = config.attribute(CONFIG_ATTR_PORT, QString::number(MQTT_PORT_DEFAULT)).toInt(&convOk);
+	if (!convOk || port <= 0 || port > 0xFFFF)
+	{
+		LOGGER_ERROR(m_log, QString("invalid port '%1', using %2").arg(config.attribute(CONFIG_ATTR_PORT)).arg(MQTT_PORT_DEFAULT));
+		port = MQTT_PORT_DEFAULT;
+	}
+	const QString host = config.attribute(CONFIG_ATTR_HOST);
+	if (host.isEmpty() || m_topic.isEmpty())
+	{
+		LOGGER_ERROR(m_log, QString("attributes '%1' and '%2' are required, station disabled!").arg(CONFIG_ATTR_HOST, CONFIG_ATTR_TOPIC));
+		return;
+	}
+	const QString username = config.attribute(CONFIG_ATTR_USERNAME);
+	const QString password = config.attribute(CONFIG_ATTR_PASSWORD);
+	if (username.isEmpty() && !password.isEmpty()) // MQTT 3.1.1: no password without user name
+	{
+		LOGGER_ERROR(m_log, QString("attribute '%1' requires '%2', station disabled!").arg(CONFIG_ATTR_PASSWORD, CONFIG_ATTR_USERNAME));
+		return;
+	}
+
+	m_publishTimer->setSingleShot(true);
+	connect(m_publishTimer, &QTimer::timeout, this, &MqttStation::publish);
+
+	m_client = MqttClient::acquire(host, static_cast<quint16>(port), username, password);
+	m_subscription = m_client->subscribe(m_topic);
+	connect(m_subscription, &MqttSubscription::messageReceived, this, &MqttStation::onMessageReceived);
+	m_log.info(QString("subscribed to '%1' on %2").arg(m_topic, m_client->broker()));
+}
+
+MqttStation::~MqttStation()
+{
+	if (m_client)
+	{
+		disconnect(m_subscription, nullptr, this, nullptr);
+		m_client->unsubscribe(m_subscription);
+		m_subscription = nullptr;
+		m_client->release();
+		m_client = nullptr;
+	}
+}
+
+QDateTime MqttStation::lastUpdate() const
+{
+	return m_lastUpdate;
+}
+
+bool MqttStation::applyState(const WeatherHistory::Sample &sample)
+{
+	m_lastUpdate = QDateTime::fromMSecsSinceEpoch(sample.timestamp, QTimeZone::UTC);
+	m_winddir = sample.windDirection;
+	m_windspeed = sample.windSpeed;
+	m_gustspeed = sample.windGusts;
+	m_temperature = sample.temperature;
+	m_humidity = sample.humidity;
+	m_available = validData(sample);
+	return m_available != NoData;
+}
+
+int MqttStation::windDirection() const
+{
+	return m_winddir;
+}
+
+int MqttStation::windSpeed() const
+{
+	return m_windspeed;
+}
+
+int MqttStation::windGusts() const
+{
+	return m_gustspeed;
+}
+
+int MqttStation::temperature() const
+{
+	return m_temperature;
+}
+
+int MqttStation::humidity() const
+{
+	return m_humidity;
+}
+
+int MqttStation::stationId() const
+{
+	return m_id;
+}
+
+QString MqttStation::stationName() const
+{
+	return m_name;
+}
+
+AbstractWeatherStation::WeatherDataFlags MqttStation::availableData() const
+{
+	return m_available;
+}
+
+void MqttStation::update()
+{
+	// broker pushes the data, nothing to poll (client reconnects on its own)
+}
+
+void MqttStation::onMessageReceived(const QString &topic, const QByteArray &payload)
+{
+	bool changed = false;
+	const QByteArray data = payload.trimmed();
+	if (data.startsWith('{'))
+	{
+		QJsonParseError error;
+		const QJsonObject obj = QJsonDocument::fromJson(data, &error).object();
+		if (error.error != QJsonParseError::NoError)
+		{
+			LOGGER_WARNING(m_log, QString("%1: invalid json: %2").arg(topic, error.errorString()));
+			return;
+		}
+		for (QJsonObject::const_iterator it = obj.constBegin(); it != obj.constEnd(); ++it)
+		{
+			if (it.value().isDouble())
+			{
+				changed |= setValue(it.key(), it.value().toDouble());
+			}
+		}
+	} else
+	{
+		bool convOk;
+		const double value = data.toDouble(&convOk);
+		if (!convOk)
+		{
+			LOGGER_WARNING(m_log, QString("%1: unexpected payload: '%2'").arg(topic, QString::fromUtf8(data.left(32))));
+			return;
+		}
+		changed = setValue(topic.section('/', -1), value);
+	}
+
+	if (changed && !m_publishTimer->isActive())
+	{
+		const qint64 sinceLast = m_lastUpdate.isValid() ? m_lastUpdate.msecsTo(QDateTime::currentDateTimeUtc()) : SAMPLE_INTERVAL_MSEC;
+		m_publishTimer->start(static_cast<int>(qMax<qint64>(PUBLISH_DELAY_MSEC, SAMPLE_INTERVAL_MSEC - sinceLast)));
+	}
+}
+
+bool MqttStation::setValue(const QString &key, double value)
+{
+	const QString k = key.toLower();
+	if (k == KEY_WIND || k == KEY_SPEED)
+	{
+		m_windspeed = qRound(value * m_speedFactor * 10);
+		m_available |= WindSpeed;
+	} else if (k == KEY_GUST)
+	{
+		m_gustspeed = qRound(value * m_speedFactor * 10);
+		m_available |= WindSpeedGust;
+	} else if (k == KEY_DIR || k == KEY_DIRECTION)
+	{
+		m_winddir = ((qRound(value) % 360) + 360) % 360;
+		m_available |= WindDirection;
+	} else if (k == KEY_TEMP || k == KEY_TEMPERATURE)
+	{
+		m_temperature = qRound(value * 10);
+		m_available |= Temperature;
+	} else if (k == KEY_HUMIDITY)
+	{
+		m_humidity = qRound(value * 10);
+		m_available |= Humidity;
+	} else
+	{
+		return false;
+	}
+	return true;
+}
+
+void MqttStation::publish()
+{
+	m_lastUpdate = QDateTime::currentDateTimeUtc();
+	emit windDirectionChanged(m_winddir);
+	emit windSpeedChanged(m_windspeed);
+	emit windGustsChanged(m_gustspeed);
+	emit temperatureChanged(m_temperature);
+	emit humidityChanged(m_humidity);
+	emit lastUpdateChanged(m_lastUpdate);
+	emit updateFinished(true);
+}
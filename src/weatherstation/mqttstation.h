@@ -0,0 +1,73 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef MQTTSTATION_H
+#define MQTTSTATION_H
+
+#include "abstractweatherstation.h"
+#include "logger.h"
+
+class QTimer;
+class MqttClient;
+class MqttSubscription;
+class StationConfig;
+
+/**
+ * @class MqttStation receives weather data from a MQTT broker. The station subscribes to a topic filter
+ * (wildcards allowed), all stations using the same broker share one connection (see @ref MqttClient).
+ * Payloads may either be a JSON object with the keys wind/speed, gust, dir/direction, temp/temperature
+ * and humidity or a plain number, in this case the last topic level selects the value (same keys).
+ * Wind speeds are expected in km/h unless configured otherwise.
+ */
+class MqttStation : public AbstractWeatherStation
+{
+	Q_OBJECT
+public:
+	explicit MqttStation(const StationConfig &config, QObject *parent = nullptr);
+	virtual ~MqttStation();
+
+	QDateTime lastUpdate() const override;
+	int windDirection() const override;
+	int windSpeed() const override;
+	int windGusts() const override;
+	int temperature() const override;
+	int humidity() const override;
+
+	int stationId() const override;
+	QString stationName() const override;
+
+	WeatherDataFlags availableData() const override;
+
+public slots:
+	void update() override;
+
+private slots:
+	void onMessageReceived(const QString &topic, const QByteArray &payload);
+	void publish();
+
+protected:
+	bool applyState(const WeatherHistory::Sample &sample) override;
+	bool setValue(const QString &key, double value);
+
+private:
+	mutable Logger m_log;
+	const int m_id;
+	QString m_name;
+	QString m_topic;
+	double m_speedFactor; // to km/h
+	MqttClient *m_client;
+	MqttSubscription *m_subscription;
+	QTimer *m_publishTimer;
+	int m_winddir;
+	int m_windspeed;
+	int m_gustspeed;
+	int m_temperature;
+	int m_humidity;
+	QDateTime m_lastUpdate;
+	WeatherDataFlags m_available;
+};
+
+#endif // MQTTSTATION_H
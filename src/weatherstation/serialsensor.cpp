@@ -0,0 +1,432 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "serialsensor.h"
+#include "config.h"
+#include "stationregistry.h"
+#include "config/stationconfig.h"
+
+#include <QSerialPort>
+#include <QTimeZone>
+#include <QTimer>
+
+static const int    SERIAL_BAUDRATE_DEFAULT = 4800;      // NMEA 0183 default
+static const int    SERIAL_LINE_MAX         = 256;       // discard garbage (e.g. wrong baudrate) exceeding this length
+static const int    SERIAL_REOPEN_MSEC      = 10 * 1000; // retry opening the device every 10sec.
+static const qint64 SAMPLE_INTERVAL_MSEC    = 1000;      // combine readings to one sample per second
+
+static const char FORMAT_NMEA[]             = "nmea";
+static const char FORMAT_CSV[]              = "csv";
+static const char NMEA_SENTENCE_MWV[]       = "MWV";     // wind speed and angle
+static const char NMEA_SENTENCE_XDR[]       = "XDR";     // transducer measurement
+static const char CSV_SEP                   = ',';
+static const char NMEA_SEP                  = ',';
+
+static const double KMH_PER_MPS             = 3.6;
+static const double KMH_PER_KNOT            = 1.852;
+static const double KMH_PER_MPH             = 1.609344;
+
+
+static QList<QByteArrayView> splitFields(QByteArrayView data, char sep)
+{
+	QList<QByteArrayView> fields;
+	qsizetype start = 0;
+	qsizetype end;
+	while ((end = data.indexOf(sep, start)) >= 0)
+	{
+		fields << data.sliced(start, end - start).trimmed();
+		start = end + 1;
+	}
+	fields << data.sliced(start).trimmed();
+	return fields;
+}
+
+static AbstractWeatherStation *createStation(const StationConfig &config, QObject *parent)
+{
+	return new SerialSensor(config, parent);
+}
+static const StationRegistry::Registrar REGISTRAR(StationConfig::SerialSensor, CONFIG_ELEMENT_SERIAL, "SerialSensor", StationRegistry::NoCapabilities, createStation);
+
+
+SerialSensor::SerialSensor(const StationConfig &config, QObject *parent) :
+    AbstractWeatherStation(config, parent),
+    m_log(QString("SerialSensor-%1").arg(config.stationId()), Logger::Fields({{LOG_FIELD_STATION_ID, QString::number(config.stationId())}})),
+    m_id(config.stationId()),
+    m_name(config.stationName()),
+    m_format(FormatNmea),
+    m_uart(new QSerialPort(config.attribute(CONFIG_ATTR_DEVICE), this)),
+    m_reopenTimer(new QTimer(this)),
+    m_publishTimer(new QTimer(this)),
+    m_buffer(),
+    m_speedSum(0.0),
+    m_speedCount(0),
+    m_speedMax(-1.0),
+    m_pendingDir(-1),
+    m_winddir(-1),
+    m_windspeed(-1),
+    m_gustspeed(-1),
+    m_temperature(AbstractWeatherStation::TemperatureInvalid * 10),
+    m_humidity(-1),
+    m_lastUpdate(),
+    m_available(NoData)
+{
+	const QString format = config.attribute(CONFIG_ATTR_FORMAT, FORMAT_NMEA).toLower();
+	if (format == FORMAT_CSV)
+	{
+		m_format = FormatCsv;
+	} else if (format != FORMAT_NMEA)
+	{
+		LOGGER_ERROR(m_log, QString("unknown format '%1', using '%2'").arg(format, FORMAT_NMEA));
+	}
+
+	bool convOk;
+	const int baudrate = config.attribute(CONFIG_ATTR_BAUDRATE, QString::number(SERIAL_BAUDRATE_DEFAULT)).toInt(&convOk);
+	m_uart->setBaudRate(convOk && baudrate > 0 ? baudrate : SERIAL_BAUDRATE_DEFAULT);
+	m_uart->setDataBits(QSerialPort::Data8);
+	m_uart->setParity(QSerialPort::NoParity);
+	m_uart->setStopBits(QSerialPort::OneStop);
+	m_uart->setFlowControl(QSerialPort::NoFlowControl);
+
+	m_reopenTimer->setSingleShot(true);
+	connect(m_reopenTimer, &QTimer::timeout, this, &SerialSensor::open);
+	m_publishTimer->setSingleShot(true);
+	m_publishTimer->setTimerType(Qt::PreciseTimer);
+	connect(m_publishTimer, &QTimer::timeout, this, &SerialSensor::publish);
+	connect(m_uart, &QIODevice::readyRead, this, &SerialSensor::onReadyRead);
+	connect(m_uart, &QSerialPort::errorOccurred, this, &SerialSensor::onErrorOccurred);
+	open();
+}
+
+SerialSensor::~SerialSensor()
+{
+	if (m_uart->isOpen())
+	{
+		m_uart->close();
+	}
+}
+
+QDateTime SerialSensor::lastUpdate() const
+{
+	return m_lastUpdate;
+}
+
+bool SerialSensor::applyState(const WeatherHistory::Sample &sample)
+{
+	m_lastUpdate = QDateTime::fromMSecsSinceEpoch(sample.timestamp, QTimeZone::UTC);
+	m_winddir = sample.windDirection;
+	m_windspeed = sample.windSpeed;
+	m_gustspeed = sample.windGusts;
+	m_temperature = sample.temperature;
+	m_humidity = sample.humidity;
+	m_available = validData(sample);
+	return m_available != NoData;
+}
+
+int SerialSensor::windDirection() const
+{
+	return m_winddir;
+}
+
+int SerialSensor::windSpeed() const
+{
+	return m_windspeed;
+}
+
+int SerialSensor::windGusts() const
+{
+	return m_gustspeed;
+}
+
+int SerialSensor::temperature() const
+{
+	return m_temperature;
+}
+
+int SerialSensor::humidity() const
+{
+	return m_humidity;
+}
+
+int SerialSensor::stationId() const
+{
+	return m_id;
+}
+
+QString SerialSensor::stationName() const
+{
+	return m_name;
+}
+
+AbstractWeatherStation::WeatherDataFlags SerialSensor::availableData() const
+{
+	return m_available;
+}
+
+void SerialSensor::update()
+{
+	// sensor pushes its data, nothing to poll - just make sure the device is open
+	if (!m_uart->isOpen() && !m_reopenTimer->isActive())
+	{
+		open();
+	}
+}
+
+void SerialSensor::open()
+{
+	if (m_uart->isOpen())
+	{
+		return;
+	}
+	if (!m_uart->open(QIODevice::ReadOnly))
+	{
+		LOGGER_ERROR(m_log, QString("failed to open serial port %1: %2").arg(m_uart->portName(), m_uart->errorString()));
+		m_reopenTimer->start(SERIAL_REOPEN_MSEC);
+		return;
+	}
+	m_buffer.clear();
+	m_log.info(QString("serial port opened: %1 (%2 baud, %3)").arg(m_uart->portName()).arg(m_uart->baudRate())
+	           .arg(m_format == FormatCsv ? FORMAT_CSV : FORMAT_NMEA));
+}
+
+void SerialSensor::onErrorOccurred()
+{
+	const QSerialPort::SerialPortError error = m_uart->error();
+	if (error == QSerialPort::NoError || error == QSerialPort::TimeoutError)
+	{
+		return;
+	}
+	if (m_uart->isOpen() && (error == QSerialPort::ResourceError || error == QSerialPort::ReadError))
+	{
+		LOGGER_ERROR(m_log, QString("serial port error: %1, reopening...").arg(m_uart->errorString()));
+		m_uart->close();
+		m_reopenTimer->start(SERIAL_REOPEN_MSEC);
+	}
+	m_uart->clearError();
+}
+
+void SerialSensor::onReadyRead()
+{
+	m_buffer.append(m_uart->readAll());
+
+	qsizetype start = 0;
+	qsizetype end;
+	while ((end = m_buffer.indexOf('\n', start)) >= 0)
+	{
+		const QByteArrayView line = QByteArrayView(m_buffer).sliced(start, end - start).trimmed();
+		if (!line.isEmpty())
+		{
+			processLine(line);
+		}
+		start = end + 1;
+	}
+	m_buffer.remove(0, start);
+
+	if (m_buffer.size() > SERIAL_LINE_MAX)
+	{
+		LOGGER_WARNING(m_log, QString("discarding %1 bytes of data without line end (wrong baudrate?)").arg(m_buffer.size()));
+		m_buffer.clear();
+	}
+
+	// readings are published by the timer, so the last ones are not held back once the sensor goes quiet
+	if (m_speedCount > 0 && !m_publishTimer->isActive())
+	{
+		const qint64 sinceLast = m_lastUpdate.isValid() ? m_lastUpdate.msecsTo(QDateTime::currentDateTimeUtc()) : SAMPLE_INTERVAL_MSEC;
+		m_publishTimer->start(static_cast<int>(qBound<qint64>(0, SAMPLE_INTERVAL_MSEC - sinceLast, SAMPLE_INTERVAL_MSEC)));
+	}
+}
+
+void SerialSensor::processLine(QByteArrayView line)
+{
+	const bool ok = (m_format == FormatNmea) ? processNmea(line) : processCsv(line);
+	if (!ok)
+	{
+		LOGGER_DEBUG(m_log, QString("ignoring line: '%1'").arg(QString::fromLatin1(line)));
+	}
+}
+
+bool SerialSensor::processNmea(QByteArrayView line)
+{
+	if (line.size() < 7 || line.at(0) != '$')
+	{
+		return false;
+	}
+
+	const qsizetype star = line.lastIndexOf('*');
+	const QByteArrayView body = line.sliced(1, (star >= 0 ? star : line.size()) - 1);
+	if (star >= 0) // checksum is optional, but must match if present
+	{
+		bool convOk;
+		const int expected = line.sliced(star + 1).toInt(&convOk, 16);
+		quint8 checksum = 0;
+		for (char c : body)
+		{
+			checksum ^= static_cast<quint8>(c);
+		}
+		if (!convOk || expected != checksum)
+		{
+			LOGGER_WARNING(m_log, QString("checksum mismatch: '%1'").arg(QString::fromLatin1(line)));
+			return false;
+		}
+	}
+
+	const QList<QByteArrayView> fields = splitFields(body, NMEA_SEP);
+	if (fields.isEmpty() || fields.first().size() != 5)
+	{
+		return false;
+	}
+
+	const QByteArrayView sentence = fields.first().sliced(2); // skip talker id (e.g. 'WI')
+	if (sentence == NMEA_SENTENCE_MWV) // $--MWV,<angle>,<R|T>,<speed>,<unit K|M|N|S>,<status A|V>
+	{
+		if (fields.size() < 6 || fields.at(5) != "A")
+		{
+			return false; // data invalid
+		}
+		bool angleOk, speedOk;
+		const double angle = fields.at(1).toDouble(&angleOk);
+		double speed = fields.at(3).toDouble(&speedOk);
+		if (!angleOk || !speedOk || angle < 0.0 || speed < 0.0)
+		{
+			return false;
+		}
+		switch (fields.at(4).isEmpty() ? 'K' : fields.at(4).at(0))
+		{
+			case 'K': break;
+			case 'M': speed *= KMH_PER_MPS; break;
+			case 'N': speed *= KMH_PER_KNOT; break;
+			case 'S': speed *= KMH_PER_MPH; break;
+			default: return false;
+		}
+		addWind(speed, qRound(angle) % 360); // fixed sensor: relative angle == true angle
+		return true;
+	}
+	if (sentence == NMEA_SENTENCE_XDR) // $--XDR,<type>,<value>,<unit>,<name>[,<type>,<value>,<unit>,<name>...]
+	{
+		bool found = false;
+		for (qsizetype i = 1; i + 2 < fields.size(); i += 4)
+		{
+			bool convOk;
+			const double value = fields.at(i + 1).toDouble(&convOk);
+			if (!convOk)
+			{
+				continue;
+			}
+			if (fields.at(i) == "C" && fields.at(i + 2) == "C")
+			{
+				m_temperature = qRound(value * 10);
+				m_available |= Temperature;
+				found = true;
+			} else if (fields.at(i) == "H" && fields.at(i + 2) == "P")
+			{
+				m_humidity = qRound(value * 10);
+				m_available |= Humidity;
+				found = true;
+			}
+		}
+		return found;
+	}
+	return false;
+}
+
+bool SerialSensor::processCsv(QByteArrayView line)
+{
+	const QList<QByteArrayView> fields = splitFields(line, CSV_SEP);
+	if (fields.size() < 2)
+	{
+		return false;
+	}
+
+	bool speedOk, dirOk;
+	const double speed = fields.at(0).toDouble(&speedOk);
+	const int dir = fields.at(1).toInt(&dirOk);
+	if (!speedOk || !dirOk || speed < 0.0 || dir < 0)
+	{
+		return false;
+	}
+
+	bool convOk;
+	double gust = -1.0;
+	if (fields.size() > 2 && !fields.at(2).isEmpty())
+	{
+		gust = fields.at(2).toDouble(&convOk);
+		if (!convOk)
+		{
+			return false;
+		}
+	}
+	if (fields.size() > 3 && !fields.at(3).isEmpty())
+	{
+		const double temp = fields.at(3).toDouble(&convOk);
+		if (!convOk)
+		{
+			return false;
+		}
+		m_temperature = qRound(temp * 10);
+		m_available |= Temperature;
+	}
+	if (fields.size() > 4 && !fields.at(4).isEmpty())
+	{
+		const double hum = fields.at(4).toDouble(&convOk);
+		if (!convOk)
+		{
+			return false;
+		}
+		m_humidity = qRound(hum * 10);
+		m_available |= Humidity;
+	}
+	addWind(speed, dir % 360, gust);
+	return true;
+}
+
+void SerialSensor::addWind(double speed, int direction, double gust)
+{
+	m_speedSum += speed;
+	m_speedCount++;
+	m_speedMax = qMax(m_speedMax, qMax(speed, gust));
+	m_pendingDir = direction;
+	m_available |= WindSpeed | WindSpeedGust | WindDirection;
+}
+
+void SerialSensor::publish()
+{
+	if (m_speedCount == 0)
+	{
+		return; // nothing new
+	}
+
+	const int speed = qRound(m_speedSum * 10 / m_speedCount);
+	const int gust = qRound(m_speedMax * 10);
+	m_speedSum = 0.0;
+	m_speedCount = 0;
+	m_speedMax = -1.0;
+
+	if (m_winddir != m_pendingDir)
+	{
+		m_winddir = m_pendingDir;
+		emit windDirectionChanged(m_winddir);
+	}
+	if (m_windspeed != speed)
+	{
+		m_windspeed = speed;
+		emit windSpeedChanged(m_windspeed);
+	}
+	if (m_gustspeed != gust)
+	{
+		m_gustspeed = gust;
+		emit windGustsChanged(m_gustspeed);
+	}
+	if (m_available & Temperature)
+	{
+		emit temperatureChanged(m_temperature);
+	}
+	if (m_available & Humidity)
+	{
+		emit humidityChanged(m_humidity);
+	}
+	m_lastUpdate = QDateTime::currentDateTimeUtc();
+	emit lastUpdateChanged(m_lastUpdate);
+	emit updateFinished(true);
+}
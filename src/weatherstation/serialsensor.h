@@ -0,0 +1,90 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef SERIALSENSOR_H
+#define SERIALSENSOR_H
+
+#include "abstractweatherstation.h"
+#include "logger.h"
+#include <QByteArray>
+#include <QByteArrayView>
+
+class QTimer;
+class QSerialPort;
+class StationConfig;
+
+/**
+ * @class SerialSensor reads a locally attached weather sensor (e.g. anemometer) via tty. Supported line
+ * formats are NMEA 0183 ($--MWV wind, $--XDR temperature/humidity, checksum validated if present) and a
+ * simple CSV format: <speed km/h>,<direction deg>[,<gust km/h>[,<temperature C>[,<humidity %>]]]
+ * Readings are combined into one sample per second (mean speed, max. speed as gust).
+ */
+class SerialSensor : public AbstractWeatherStation
+{
+	Q_OBJECT
+public:
+	enum LineFormat
+	{
+		FormatNmea,
+		FormatCsv
+	};
+
+	explicit SerialSensor(const StationConfig &config, QObject *parent = nullptr);
+	virtual ~SerialSensor();
+
+	QDateTime lastUpdate() const override;
+	int windDirection() const override;
+	int windSpeed() const override;
+	int windGusts() const override;
+	int temperature() const override;
+	int humidity() const override;
+
+	int stationId() const override;
+	QString stationName() const override;
+
+	WeatherDataFlags availableData() const override;
+
+public slots:
+	void update() override;
+
+private slots:
+	void onReadyRead();
+	void onErrorOccurred();
+	void open();
+	void publish();
+
+protected:
+	bool applyState(const WeatherHistory::Sample &sample) override;
+	void processLine(QByteArrayView line);
+	bool processNmea(QByteArrayView line);
+	bool processCsv(QByteArrayView line);
+	void addWind(double speed, int direction, double gust = -1.0);
+
+private:
+	mutable Logger m_log;
+	const int m_id;
+	QString m_name;
+	LineFormat m_format;
+	QSerialPort *m_uart;
+	QTimer *m_reopenTimer;
+	QTimer *m_publishTimer;
+	QByteArray m_buffer;
+	// readings since last published sample
+	double m_speedSum;
+	int m_speedCount;
+	double m_speedMax;
+	int m_pendingDir;
+	// published sample
+	int m_winddir;
+	int m_windspeed;
+	int m_gustspeed;
+	int m_temperature;
+	int m_humidity;
+	QDateTime m_lastUpdate;
+	WeatherDataFlags m_available;
+};
+
+#endif // SERIALSENSOR_H
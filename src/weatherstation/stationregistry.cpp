@@ -0,0 +1,144 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "stationregistry.h"
+#include "logger.h"
+#include "config/stationconfig.h"
+
+#include <QDir>
+#include <QLibrary>
+#include <QFileInfo>
+
+static const char PLUGIN_SYMBOL_API_VERSION[] = "fagsPluginApiVersion";
+
+typedef int (*PluginApiVersionFunc)();
+
+
+StationRegistry::Registrar::Registrar(int type, const char *element, const char *name, Capabilities capabilities, Factory factory)
+{
+	// must not log here: called at static-init time (Logger may not exist yet)
+	StationRegistry::instance().registerProvider(Provider{type, QString::fromLatin1(element), QString::fromLatin1(name), capabilities, factory});
+}
+
+StationRegistry::StationRegistry() :
+    m_providers(),
+    m_pending(),
+    m_loading(false)
+{
+}
+
+StationRegistry &StationRegistry::instance()
+{
+	static StationRegistry registry; // constructed on first use, so registration order across translation units doesn't matter
+	return registry;
+}
+
+void StationRegistry::registerProvider(const Provider &provider)
+{
+	(m_loading ? m_pending : m_providers).append(provider);
+}
+
+const StationRegistry::Provider *StationRegistry::provider(int type) const
+{
+	for (const Provider &p : m_providers)
+	{
+		if (p.type == type)
+		{
+			return &p;
+		}
+	}
+	return nullptr;
+}
+
+const StationRegistry::Provider *StationRegistry::provider(const QString &element) const
+{
+	for (const Provider &p : m_providers)
+	{
+		if (p.element == element)
+		{
+			return &p;
+		}
+	}
+	return nullptr;
+}
+
+QStringList StationRegistry::elements() const
+{
+	QStringList list;
+	for (const Provider &p : m_providers)
+	{
+		list << p.element;
+	}
+	return list;
+}
+
+int StationRegistry::loadPlugins(const QString &path)
+{
+	Logger log("StationRegistry");
+	const QDir dir(path);
+	if (!dir.exists())
+	{
+		log.debug(QString("plugin directory not found: %1").arg(path));
+		return 0;
+	}
+
+	int loaded = 0;
+	const QFileInfoList files = dir.entryInfoList(QStringList() << "*.so", QDir::Files | QDir::Readable, QDir::Name);
+	for (const QFileInfo &file : files)
+	{
+		QLibrary lib(file.absoluteFilePath());
+		m_loading = true;
+		m_pending.clear();
+		const bool ok = lib.load(); // runs the plugin's static initializers (registrars)
+		m_loading = false;
+		if (!ok)
+		{
+			LOGGER_ERROR(log, QString("failed to load plugin %1: %2").arg(file.fileName(), lib.errorString()));
+			continue;
+		}
+
+		const PluginApiVersionFunc apiVersion = reinterpret_cast<PluginApiVersionFunc>(lib.resolve(PLUGIN_SYMBOL_API_VERSION));
+		if (!apiVersion || apiVersion() != PluginApiVersion)
+		{
+			LOGGER_ERROR(log, QString("rejecting plugin %1: incompatible api version (expected %2)").arg(file.fileName()).arg(PluginApiVersion));
+			m_pending.clear();
+			lib.unload();
+			continue;
+		}
+
+		bool valid = !m_pending.isEmpty();
+		for (const Provider &p : std::as_const(m_pending))
+		{
+			if (p.type < StationConfig::UserStation || p.type > StationConfig::StationTypeMax) // snapshot stores the type as 1 byte
+			{
+				LOGGER_ERROR(log, QString("rejecting plugin %1: provider '%2' has type %3, valid: %4..%5")
+				                  .arg(file.fileName(), p.element).arg(p.type).arg(StationConfig::UserStation).arg(StationConfig::StationTypeMax));
+				valid = false;
+			} else if (provider(p.type) || provider(p.element) || !p.factory || p.element.isEmpty())
+			{
+				LOGGER_ERROR(log, QString("rejecting plugin %1: provider '%2' (type %3) is invalid or already registered")
+				                  .arg(file.fileName(), p.element).arg(p.type));
+				valid = false;
+			}
+		}
+		if (!valid)
+		{
+			m_pending.clear();
+			lib.unload();
+			continue;
+		}
+
+		// plugin stays loaded for the lifetime of the process (QLibrary doesn't unload on destruction)
+		for (const Provider &p : std::as_const(m_pending))
+		{
+			log.info(QString("loaded provider '%1' (element: <%2>) from %3").arg(p.name, p.element, file.fileName()));
+			m_providers.append(p);
+		}
+		m_pending.clear();
+		loaded++;
+	}
+	return loaded;
+}
@@ -0,0 +1,80 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef STATIONREGISTRY_H
+#define STATIONREGISTRY_H
+
+#include <QList>
+#include <QFlags>
+#include <QString>
+#include <QStringList>
+
+class QObject;
+class StationConfig;
+class AbstractWeatherStation;
+
+/**
+ * @class StationRegistry maps xml element names and station types to weather station providers.
+ * Providers register themselves at static-init time using a @ref StationRegistry::Registrar, built-in ones
+ * as part of the daemon, out-of-tree ones when their shared object is loaded from the plugin directory.
+ * A plugin must also define its api version using @ref FAGS_STATION_PLUGIN, otherwise it is rejected.
+ */
+class StationRegistry
+{
+public:
+	static const int PluginApiVersion = 1;
+
+	enum Capability
+	{
+		NoCapabilities  = 0x00,
+		RequiresApiKey  = 0x01, // 'apikey' attribute is mandatory
+		RequiresPolling = 0x02  // station is polled, 'update_interval' attribute is mandatory
+	};
+	Q_DECLARE_FLAGS(Capabilities, Capability)
+
+	typedef AbstractWeatherStation *(*Factory)(const StationConfig &config, QObject *parent);
+
+	struct Provider
+	{
+		int type; // StationConfig::StationType (out-of-tree providers: >= StationConfig::UserStation)
+		QString element;
+		QString name;
+		Capabilities capabilities;
+		Factory factory;
+	};
+
+	class Registrar
+	{
+	public:
+		Registrar(int type, const char *element, const char *name, Capabilities capabilities, Factory factory);
+	};
+
+	static StationRegistry &instance();
+
+	const Provider *provider(int type) const;
+	const Provider *provider(const QString &element) const;
+	QStringList elements() const;
+
+	int loadPlugins(const QString &path); // returns number of plugins loaded
+
+private:
+	StationRegistry();
+	StationRegistry(const StationRegistry &) = delete;
+	StationRegistry &operator=(const StationRegistry &) = delete;
+
+	void registerProvider(const Provider &provider);
+
+	QList<Provider> m_providers;
+	QList<Provider> m_pending; // registered by a plugin that is currently being loaded
+	bool m_loading;
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(StationRegistry::Capabilities)
+
+#define FAGS_STATION_PLUGIN() \
+	extern "C" Q_DECL_EXPORT int fagsPluginApiVersion() { return StationRegistry::PluginApiVersion; }
+
+#endif // STATIONREGISTRY_H
@@ -0,0 +1,208 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "weatherhistory.h"
+
+#include <QtMath>
+#include <cmath>
+
+
+WeatherHistory::WeatherHistory(int capacity) :
+    m_capacity(qMax(1, capacity)),
+    m_samples(),
+    m_head(0),
+    m_windows()
+{
+	m_samples.resize(m_capacity);
+}
+
+void WeatherHistory::append(const Sample &sample)
+{
+	if (m_head > 0 && sample.timestamp <= latest().timestamp)
+	{
+		return; // no new data (or out of order)
+	}
+
+	// sample about to be overwritten must leave all windows first
+	const qint64 oldest = m_head - m_capacity + 1;
+	for (Window &w : m_windows)
+	{
+		expire(w, oldest);
+	}
+
+	m_samples[m_head % m_capacity] = sample;
+	const qint64 seq = m_head++;
+	for (Window &w : m_windows)
+	{
+		add(w, seq);
+	}
+}
+
+void WeatherHistory::clear()
+{
+	m_head = 0;
+	m_windows.clear();
+}
+
+WeatherHistory::Sample WeatherHistory::latest() const
+{
+	if (m_head == 0)
+	{
+		return Sample{0, -1, -1, -1, TemperatureInvalid * 10, -1};
+	}
+	return at(m_head - 1);
+}
+
+WeatherHistory::Aggregate WeatherHistory::aggregate(int windowSecs, const QDateTime &now)
+{
+	if (windowSecs <= 0 || m_head == 0)
+	{
+		const Sample s = latest();
+		return Aggregate{m_head > 0 ? 1 : 0, s.windSpeed, s.windGusts >= 0 ? s.windGusts : s.windSpeed,
+		                 s.windDirection, s.temperature, s.humidity};
+	}
+
+	Window &w = window(windowSecs);
+	const qint64 limit = now.toMSecsSinceEpoch() - w.length;
+	while (w.tail < m_head && at(w.tail).timestamp < limit)
+	{
+		remove(w, w.tail);
+	}
+
+	Aggregate result{static_cast<int>(m_head - w.tail), -1, -1, -1, TemperatureInvalid * 10, -1};
+	if (w.speedCount > 0)
+	{
+		result.windSpeed = qRound(static_cast<double>(w.speedSum) / w.speedCount);
+	}
+	if (!w.gustMax.isEmpty())
+	{
+		const Sample &s = at(w.gustMax.first());
+		result.windGusts = s.windGusts >= 0 ? s.windGusts : s.windSpeed;
+	}
+	if (w.dirCount > 0)
+	{
+		const int dir = qRound(qRadiansToDegrees(std::atan2(w.dirSin, w.dirCos)));
+		result.windDirection = (dir + 360) % 360;
+	}
+	if (w.tempCount > 0)
+	{
+		result.temperature = qRound(static_cast<double>(w.tempSum) / w.tempCount);
+	}
+	if (w.humCount > 0)
+	{
+		result.humidity = qRound(static_cast<double>(w.humSum) / w.humCount);
+	}
+	return result;
+}
+
+WeatherHistory::Window &WeatherHistory::window(int windowSecs)
+{
+	const qint64 length = static_cast<qint64>(windowSecs) * 1000;
+	for (Window &w : m_windows)
+	{
+		if (w.length == length)
+		{
+			return w;
+		}
+	}
+
+	// new window: fill with all samples still available, expired ones are dropped on query
+	m_windows.append(Window{length, qMax<qint64>(0, m_head - m_capacity), 0, 0, 0.0, 0.0, 0, 0, 0, 0, 0, QList<qint64>()});
+	Window &w = m_windows.last();
+	for (qint64 seq = w.tail; seq < m_head; seq++)
+	{
+		add(w, seq);
+	}
+	return w;
+}
+
+void WeatherHistory::add(Window &w, qint64 seq)
+{
+	const Sample &s = at(seq);
+	if (s.windSpeed >= 0)
+	{
+		w.speedSum += s.windSpeed;
+		w.speedCount++;
+	}
+	if (s.windDirection >= 0)
+	{
+		const double rad = qDegreesToRadians(static_cast<double>(s.windDirection));
+		w.dirSin += std::sin(rad);
+		w.dirCos += std::cos(rad);
+		w.dirCount++;
+	}
+	if (s.temperature != TemperatureInvalid * 10)
+	{
+		w.tempSum += s.temperature;
+		w.tempCount++;
+	}
+	if (s.humidity >= 0)
+	{
+		w.humSum += s.humidity;
+		w.humCount++;
+	}
+
+	const int gust = s.windGusts >= 0 ? s.windGusts : s.windSpeed;
+	if (gust >= 0)
+	{
+		while (!w.gustMax.isEmpty())
+		{
+			const Sample &last = at(w.gustMax.last());
+			if ((last.windGusts >= 0 ? last.windGusts : last.windSpeed) > gust)
+			{
+				break;
+			}
+			w.gustMax.removeLast(); // can never be the max. again while this sample is within window
+		}
+		w.gustMax.append(seq);
+	}
+}
+
+void WeatherHistory::remove(Window &w, qint64 seq)
+{
+	const Sample &s = at(seq);
+	if (s.windSpeed >= 0)
+	{
+		w.speedSum -= s.windSpeed;
+		w.speedCount--;
+	}
+	if (s.windDirection >= 0)
+	{
+		const double rad = qDegreesToRadians(static_cast<double>(s.windDirection));
+		w.dirSin -= std::sin(rad);
+		w.dirCos -= std::cos(rad);
+		w.dirCount--;
+	}
+	if (s.temperature != TemperatureInvalid * 10)
+	{
+		w.tempSum -= s.temperature;
+		w.tempCount--;
+	}
+	if (s.humidity >= 0)
+	{
+		w.humSum -= s.humidity;
+		w.humCount--;
+	}
+	if (!w.gustMax.isEmpty() && w.gustMax.first() == seq)
+	{
+		w.gustMax.removeFirst();
+	}
+	w.tail = seq + 1;
+
+	if (w.dirCount == 0)
+	{
+		w.dirSin = 0.0; // get rid of accumulated rounding errors
+		w.dirCos = 0.0;
+	}
+}
+
+void WeatherHistory::expire(Window &w, qint64 oldest)
+{
+	while (w.tail < oldest && w.tail < m_head)
+	{
+		remove(w, w.tail);
+	}
+}
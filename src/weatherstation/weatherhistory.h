@@ -0,0 +1,91 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef WEATHERHISTORY_H
+#define WEATHERHISTORY_H
+
+#include <QList>
+#include <QDateTime>
+
+/**
+ * @class WeatherHistory keeps the last samples of a weather station in a fixed size ring buffer
+ * and maintains rolling aggregates (mean wind speed, max. gust, circular mean of wind direction
+ * and mean temperature) for one or more time windows. Aggregates are updated incrementally when
+ * samples are added or drop out of a window, so querying them never rescans the history.
+ */
+class WeatherHistory
+{
+public:
+	struct Sample
+	{
+		qint64 timestamp; // msecs since epoch
+		int windSpeed;    // in km/h x10, < 0 if invalid
+		int windGusts;    // in km/h x10, < 0 if invalid
+		int windDirection;// in deg., < 0 if invalid
+		int temperature;  // in deg. C x10, TemperatureInvalid x10 if invalid
+		int humidity;     // in %rh x10, < 0 if invalid
+	};
+
+	struct Aggregate
+	{
+		int samples;       // number of samples within window (0 = no data)
+		int windSpeed;     // mean wind speed
+		int windGusts;     // max. gust
+		int windDirection; // circular mean of wind direction
+		int temperature;   // mean temperature
+		int humidity;      // mean humidity
+	};
+
+	static const int TemperatureInvalid = -274;
+
+	explicit WeatherHistory(int capacity);
+	~WeatherHistory() = default;
+
+	void append(const Sample &sample);
+	void clear();
+
+	int capacity() const { return m_capacity; }
+	int size() const { return static_cast<int>(qMin<qint64>(m_head, m_capacity)); }
+	bool isEmpty() const { return m_head == 0; }
+	Sample latest() const;
+
+	/**
+	 * Returns the aggregate of all samples not older than @p windowSecs relative to @p now.
+	 * The first call for a window size registers it (which scans the history once), afterwards
+	 * it is maintained in O(1) (amortized).
+	 */
+	Aggregate aggregate(int windowSecs, const QDateTime &now = QDateTime::currentDateTimeUtc());
+
+private:
+	struct Window
+	{
+		qint64 length;    // msecs
+		qint64 tail;      // sequence number of oldest sample within window
+		qint64 speedSum;
+		int speedCount;
+		double dirSin;
+		double dirCos;
+		int dirCount;
+		qint64 tempSum;
+		int tempCount;
+		qint64 humSum;
+		int humCount;
+		QList<qint64> gustMax; // sequence numbers with decreasing gusts (monotonic queue)
+	};
+
+	const Sample &at(qint64 seq) const { return m_samples.at(seq % m_capacity); }
+	Window &window(int windowSecs);
+	void add(Window &w, qint64 seq);
+	void remove(Window &w, qint64 seq);
+	void expire(Window &w, qint64 oldest);
+
+	const int m_capacity;
+	QList<Sample> m_samples;
+	qint64 m_head; // sequence number of next sample (= total number of samples appended)
+	QList<Window> m_windows;
+};
+
+#endif // WEATHERHISTORY_H
@@ -0,0 +1,39 @@
+/**
+ * SPDX-FileCopyrightText: 2025 Markus Lohse <mlohse@gmx.net>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef WEATHERSNAPSHOT_H
+#define WEATHERSNAPSHOT_H
+
+#include <QDateTime>
+#include <QGeoCoordinate>
+#include <QString>
+#include <memory>
+#include "weatherhistory.h"
+
+/**
+ * @struct WeatherSnapshot is an immutable copy of a station's data after an update. Stations publish
+ * a new snapshot per update (see AbstractWeatherStation::snapshot()), so readers get a consistent
+ * view of all values with a single load - from any thread.
+ */
+struct WeatherSnapshot
+{
+	int stationId = 0;
+	QString stationName;
+	QGeoCoordinate position;
+	QDateTime lastUpdate;     // invalid if station has no data yet
+	int availableData = 0;    // AbstractWeatherStation::WeatherDataFlags
+	int windSpeed = -1;       // in km/h x10, < 0 if invalid
+	int windGusts = -1;       // in km/h x10, < 0 if invalid
+	int windDirection = -1;   // in deg., < 0 if invalid
+	int temperature = WeatherHistory::TemperatureInvalid * 10; // in deg. C x10
+	int humidity = -1;        // in %rh x10, < 0 if invalid
+	int averageWindow = 0;    // in seconds, 0 = no average
+	WeatherHistory::Aggregate average = {0, -1, -1, -1, WeatherHistory::TemperatureInvalid * 10, -1}; // samples within averageWindow
+};
+
+typedef std::shared_ptr<const WeatherSnapshot> WeatherSnapshotPtr;
+
+#endif // WEATHERSNAPSHOT_H
@@ -8,6 +8,7 @@
 #include "application.h"
 #include "config.h"
 #include "gpio.h"
+#include "stationregistry.h"
 #include "config/stationconfig.h"
 
 #include <QNetworkAccessManager>
@@ -25,6 +26,7 @@
 
 static const qint64  NETWORK_REPLY_SIZE_MAX = 2048; // do not parse more than 2kb of data
 static const int     NETWORK_TIMEOUT        = 15 * 1000; // 15sec
+static const int     UPDATE_INTERVAL_MIN    = 100; // OpenWindMap API does not allow polling more often than every 100sec.
 
 static const char JSON_KEY_DATA[]           = "data";
 static const char JSON_KEY_META[]           = "meta";
@@ -40,9 +42,26 @@ static const char JSON_FORMAT_DATETIME[]    = "yyyy-MM-ddTHH:mm:ss.zzzt";
 static const char WINDBIRD_API_URL[]        = "http://api.pioupiou.fr/v1/live/%1"; // %1 = placeholder for station id
 
 
+static AbstractWeatherStation *createStation(const StationConfig &config, QObject *parent)
+{
+	return new WindbirdApi(config, parent);
+}
+static const StationRegistry::Registrar REGISTRAR(StationConfig::Windbird, CONFIG_ELEMENT_WINDBIRD, "Windbird", StationRegistry::RequiresPolling, createStation);
+
+static void setDataLed()
+{
+	Application *app = qobject_cast<Application*>(qApp);
+	Gpio *gpio = app ? app->gpio() : nullptr;
+	if (gpio)
+	{
+		gpio->setGpio(LED_PIN_BLUE);
+	}
+}
+
+
 WindbirdApi::WindbirdApi(int id, const QString &stationName, QObject *parent) :
     AbstractWeatherStation(parent),
-    m_log(QString("WindbirdApi-%1").arg(id)),
+    m_log(QString("WindbirdApi-%1").arg(id), Logger::Fields({{LOG_FIELD_STATION_ID, QString::number(id)}})),
     m_id(id),
     m_winddir(0),
     m_windspeed(0),
@@ -58,7 +77,7 @@ WindbirdApi::WindbirdApi(int id, const QString &stationName, QObject *parent) :
 
 WindbirdApi::WindbirdApi(const StationConfig &config, QObject *parent) :
     AbstractWeatherStation(config, parent),
-    m_log(QString("WindbirdApi-%1").arg(config.stationId())),
+    m_log(QString("WindbirdApi-%1").arg(config.stationId()), Logger::Fields({{LOG_FIELD_STATION_ID, QString::number(config.stationId())}})),
     m_id(config.stationId()),
     m_winddir(0),
     m_windspeed(0),
@@ -101,6 +120,12 @@ void WindbirdApi::init()
 	m_timer->setSingleShot(true);
 	connect(m_timer, &QTimer::timeout, this, &WindbirdApi::onTimeout);
 
+	if (updateInterval() > 0 && updateInterval() < UPDATE_INTERVAL_MIN)
+	{
+		LOGGER_WARNING(m_log, QString("update interval too short (%1sec.), using %2sec.").arg(updateInterval()).arg(UPDATE_INTERVAL_MIN));
+		setUpdateInterval(UPDATE_INTERVAL_MIN); // base class could not know about our limit during construction
+	}
+
 	// OpenWindMap API community licence requires to show this message:
 	m_log.info("Wind data (c) contributors of the OpenWindMap wind network <https://openwindmap.org>");
 }
@@ -110,6 +135,15 @@ QDateTime WindbirdApi::lastUpdate() const
 	return m_lastUpdate;
 }
 
+bool WindbirdApi::applyState(const WeatherHistory::Sample &sample)
+{
+	m_lastUpdate = QDateTime::fromMSecsSinceEpoch(sample.timestamp, QTimeZone::UTC);
+	m_winddir = sample.windDirection;
+	m_windspeed = sample.windSpeed;
+	m_gustspeed = sample.windGusts;
+	return true;
+}
+
 int WindbirdApi::windDirection() const
 {
 	return m_winddir;
@@ -142,6 +176,16 @@ AbstractWeatherStation::WeatherDataFlags WindbirdApi::availableData() const
 	        AbstractWeatherStation::WindSpeedGust);
 }
 
+int WindbirdApi::minUpdateInterval() const
+{
+	return UPDATE_INTERVAL_MIN;
+}
+
+QString WindbirdApi::remoteHost() const
+{
+	return providerUrl(WINDBIRD_API_URL).host();
+}
+
 void WindbirdApi::update()
 {
 	if (!m_reply) // request still running?
@@ -153,8 +197,9 @@ void WindbirdApi::update()
 		{
 			gpio->clearGpio(LED_PIN_BLUE);
 		}
-		const QUrl url(QString(WINDBIRD_API_URL).arg(m_id));
-		m_reply = m_netmgr->get(QNetworkRequest(url));
+		QNetworkRequest request(providerUrl(QString(WINDBIRD_API_URL).arg(m_id)));
+		prepareRequest(request);
+		m_reply = m_netmgr->get(request);
 		connect(m_reply, &QNetworkReply::finished, this, &WindbirdApi::onReplyFinished);
 		m_timer->start(NETWORK_TIMEOUT);
 	}
@@ -167,16 +212,41 @@ void WindbirdApi::onReplyFinished()
 		return;
 	}
 
-	QByteArray data = m_reply->read(NETWORK_REPLY_SIZE_MAX);
-	QJsonDocument doc = QJsonDocument::fromJson(data);
-	m_reply->deleteLater();
+	QNetworkReply *reply = m_reply;
 	m_reply = nullptr;
+	m_timer->stop();
+	reply->deleteLater();
+
+	if (isNotModified(reply))
+	{
+		setDataLed();
+		emit updateFinished(true);
+		return;
+	}
+
+	if (reply->error() != QNetworkReply::NoError)
+	{
+		LOGGER_WARNING(m_log, QString("Request failed: %1").arg(reply->errorString()));
+		setNetworkError();
+		emit updateFinished(false);
+		return;
+	}
+
+	const QByteArray data = reply->read(NETWORK_REPLY_SIZE_MAX);
+	if (isContentUnchanged(data))
+	{
+		setDataLed();
+		emit updateFinished(true); // same data as before, nothing to parse
+		return;
+	}
+
+	QJsonDocument doc = QJsonDocument::fromJson(data);
 
 //	m_log.debug(QString("json data: %1").arg(QString::fromLatin1(data)));
 
 	if (doc.isNull())
 	{
-		m_log.warning(QString("Failed to parse json data: '%1'").arg(QString::fromLatin1(data)));
+		LOGGER_WARNING(m_log, QString("Failed to parse json data: '%1'").arg(QString::fromLatin1(data)));
 		emit updateFinished(false);
 		return;
 	}
@@ -188,14 +258,14 @@ void WindbirdApi::onReplyFinished()
 
 	if (metaObj.isEmpty() || windObj.isEmpty() || !windObj.contains(JSON_KEY_DATETIME))
 	{
-		m_log.warning(QString("Received incomplete data: '%1'").arg(QString::fromLatin1(doc.toJson(QJsonDocument::Compact))));
+		LOGGER_WARNING(m_log, QString("Received incomplete data: '%1'").arg(QString::fromLatin1(doc.toJson(QJsonDocument::Compact))));
 		emit updateFinished(false);
 		return;
 	}
 
 	if (!dataObj.contains(JSON_KEY_ID) || dataObj.value(JSON_KEY_ID).toInt(-1) != m_id)
 	{
-		m_log.warning(QString("Received data for invalid/wrong station id: %1").arg(dataObj.value(JSON_KEY_ID).toInt(-1)));
+		LOGGER_WARNING(m_log, QString("Received data for invalid/wrong station id: %1").arg(dataObj.value(JSON_KEY_ID).toInt(-1)));
 		emit updateFinished(false);
 		return;
 	}
@@ -235,16 +305,12 @@ void WindbirdApi::onReplyFinished()
 			emit lastUpdateChanged(m_lastUpdate);
 		}
 
-		m_log.info(QString("new data: wind=%1%2, gusts=%3%2, dir=%4, lastUpdate=%7")
-		           .arg(m_windspeed / 10.0).arg(unitWindSpeed()).arg(m_gustspeed / 10.0).arg(m_winddir)
-		           .arg(m_lastUpdate.time().toString()));
+		LOGGER_INFO(m_log, QString("new data: wind=%1%2, gusts=%3%2, dir=%4, lastUpdate=%7")
+		                   .arg(m_windspeed / 10.0).arg(unitWindSpeed()).arg(m_gustspeed / 10.0).arg(m_winddir)
+		                   .arg(m_lastUpdate.time().toString()));
 
-		Application *app = qobject_cast<Application*>(qApp);
-		Gpio *gpio = app ? app->gpio() : nullptr;
-		if (gpio)
-		{
-			gpio->setGpio(LED_PIN_BLUE);
-		}
+		setDataLed();
+		setContentParsed(data, reply);
 		emit updateFinished(true);
 	}
 }
@@ -254,11 +320,12 @@ void WindbirdApi::onTimeout()
 	if (m_reply)
 	{
 		QNetworkReply *tmp = m_reply;
-		m_log.warning(QString("Request timed out: %1").arg(tmp->request().url().toDisplayString()));
+		LOGGER_WARNING(m_log, QString("Request timed out: %1").arg(tmp->request().url().toDisplayString()));
 		m_reply = 0;
 		tmp->disconnect();
 		tmp->abort();
 		tmp->deleteLater();
+		setNetworkError();
 		emit updateFinished(false);
 	}
 }
@@ -32,6 +32,8 @@ public:
 	QString stationName() const override; // data.meta.name
 
 	WeatherDataFlags availableData() const override;
+	int minUpdateInterval() const override;
+	QString remoteHost() const override;
 
 public slots:
 	void update() override;
@@ -42,6 +44,7 @@ private slots:
 
 protected:
 	void init();
+	bool applyState(const WeatherHistory::Sample &sample) override;
 
 private:
 	mutable Logger m_log;